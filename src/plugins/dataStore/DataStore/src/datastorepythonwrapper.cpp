@@ -446,7 +446,7 @@ double DataStorePythonWrapper::value(DataStoreVariable *pDataStoreVariable,
     // and for the given run
 
     if (   (pDataStoreVariable != nullptr)
-        && (pDataStoreVariable->array() != nullptr)) {
+        && (pDataStoreVariable->runsCount() != 0)) {
         return pDataStoreVariable->value(pPosition, pRun);
     }
 
@@ -459,11 +459,16 @@ PyObject * DataStorePythonWrapper::values(DataStoreVariable *pDataStoreVariable,
                                           int pRun)
 {
     // Create and return a NumPy array for the given data store variable and run
+    // Note: our NumPy array must be sized using the size of the given run since
+    //       the array of a run only grows as values get added to it, so the
+    //       array of a previous run may be smaller than that of the last run...
 
-    DataStoreArray *dataStoreArray = pDataStoreVariable->array(pRun);
+    DataStoreArray *dataStoreArray = (pDataStoreVariable != nullptr)?
+                                         pDataStoreVariable->array(pRun):
+                                         nullptr;
 
-    if ((pDataStoreVariable != nullptr) && (dataStoreArray != nullptr)) {
-        auto numPyArray = new NumPyPythonWrapper(dataStoreArray, pDataStoreVariable->size());
+    if (dataStoreArray != nullptr) {
+        auto numPyArray = new NumPyPythonWrapper(dataStoreArray, pDataStoreVariable->size(pRun));
 
         mNumPyArrays << numPyArray;
 
@@ -0,0 +1,288 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// DataStore tests
+//==============================================================================
+
+#include "datastoreinterface.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include <QTemporaryDir>
+
+//==============================================================================
+
+#include <array>
+
+//==============================================================================
+
+void Tests::addValuesTests()
+{
+    // Add some values to a data store and make sure that they end up in the
+    // right run, even after having added a variable to it
+
+    std::array<double, 3> values = {};
+    OpenCOR::DataStore::DataStore dataStore;
+    OpenCOR::DataStore::DataStoreVariables variables = dataStore.addVariables(values.data(), 2);
+
+    QVERIFY(dataStore.addRun(3));
+
+    for (int i = 0; i < 3; ++i) {
+        values[0] = 10.0*i;
+        values[1] = 100.0*i;
+
+        dataStore.addValues(i);
+    }
+
+    QCOMPARE(dataStore.size(), quint64(3));
+    QCOMPARE(variables[0]->value(2), 20.0);
+    QCOMPARE(variables[1]->value(2), 200.0);
+
+    OpenCOR::DataStore::DataStoreVariable *variable = dataStore.addVariable(&values[2]);
+
+    QVERIFY(dataStore.addRun(2));
+
+    values[0] = 1.0;
+    values[1] = 2.0;
+    values[2] = 3.0;
+
+    dataStore.addValues(7.0);
+
+    QCOMPARE(dataStore.runsCount(), 2);
+    QCOMPARE(dataStore.voi()->value(0, 1), 7.0);
+    QCOMPARE(variables[0]->value(0, 1), 1.0);
+    QCOMPARE(variables[1]->value(0, 1), 2.0);
+    QCOMPARE(variable->value(0), 3.0);
+    QCOMPARE(variables[0]->size(0), quint64(3));
+}
+
+//==============================================================================
+
+void Tests::growTests()
+{
+    // Add more values to a data store than fit in a chunk, so that its runs
+    // have to grow, and make sure that our values are all there and that the
+    // memory used while growing gets released and our runs shrunk to their
+    // size once compacted (twice since our runs keep their unshrunk array
+    // until they get compacted again)
+
+    static const quint64 Capacity = 200000;
+    static const quint64 ValuesCount = 150000;
+
+    double value = 0.0;
+    OpenCOR::DataStore::DataStore dataStore;
+    OpenCOR::DataStore::DataStoreVariable *variable = dataStore.addVariable(&value);
+
+    QVERIFY(dataStore.addRun(Capacity));
+    QVERIFY(variable->run()->allocatedSize() < Capacity);
+
+    for (quint64 i = 0; i < ValuesCount; ++i) {
+        value = 3.0*i;
+
+        dataStore.addValues(i);
+    }
+
+    QCOMPARE(variable->size(), ValuesCount);
+    QVERIFY(variable->run()->allocatedSize() > variable->array()->size());
+
+    QVERIFY(dataStore.compact());
+    QVERIFY(variable->run()->allocatedSize() > variable->array()->size());
+    QCOMPARE(variable->array()->size(), ValuesCount);
+
+    QVERIFY(!dataStore.compact());
+    QCOMPARE(variable->run()->allocatedSize(), ValuesCount);
+
+    double *values = variable->values();
+
+    for (quint64 i = 0; i < ValuesCount; ++i) {
+        QCOMPARE(values[i], 3.0*i);
+    }
+
+    QCOMPARE(dataStore.voi()->value(ValuesCount-1), double(ValuesCount-1));
+    QVERIFY(qIsNaN(variable->value(ValuesCount)));
+}
+
+//==============================================================================
+
+void Tests::constantTests()
+{
+    // Add the same value to a constant variable and make sure that no memory
+    // gets allocated for it
+
+    static const quint64 Capacity = 1000000;
+    static const quint64 ValuesCount = 1000;
+
+    std::array<double, 2> values = { 3.0, 5.0 };
+    OpenCOR::DataStore::DataStore dataStore;
+    OpenCOR::DataStore::DataStoreVariables variables = dataStore.addVariables(values.data(), 2);
+
+    for (auto variable : variables) {
+        variable->setStorageClass(OpenCOR::DataStore::StorageClass::Constant);
+    }
+
+    QVERIFY(dataStore.addRun(Capacity));
+
+    for (quint64 i = 0; i < ValuesCount; ++i) {
+        dataStore.addValues(i);
+    }
+
+    QCOMPARE(variables[0]->size(), ValuesCount);
+    QVERIFY(variables[0]->run()->storageClass() == OpenCOR::DataStore::StorageClass::Constant);
+    QCOMPARE(variables[0]->run()->allocatedSize(), quint64(0));
+    QCOMPARE(variables[0]->value(ValuesCount-1), 3.0);
+    QVERIFY(qIsNaN(variables[0]->value(ValuesCount)));
+
+    // Change the value of our second variable, which should result in it being
+    // stored densely, with its previous values preserved
+
+    values[1] = 7.0;
+
+    dataStore.addValues(double(ValuesCount));
+
+    QVERIFY(variables[1]->run()->storageClass() == OpenCOR::DataStore::StorageClass::Dense);
+    QVERIFY(variables[1]->run()->allocatedSize() != 0);
+    QVERIFY(variables[1]->run()->allocatedSize() < Capacity);
+    QCOMPARE(variables[1]->value(0), 5.0);
+    QCOMPARE(variables[1]->value(ValuesCount-1), 5.0);
+    QCOMPARE(variables[1]->value(ValuesCount), 7.0);
+
+    // Retrieve the values of our first variable, which should materialise
+    // them without allocating memory for our whole capacity, and make sure
+    // that values can still be added to it
+
+    QVERIFY(variables[0]->run()->storageClass() == OpenCOR::DataStore::StorageClass::Constant);
+
+    double *constantValues = variables[0]->values();
+
+    QVERIFY(constantValues != nullptr);
+    QVERIFY(variables[0]->run()->allocatedSize() < Capacity);
+
+    for (quint64 i = 0; i <= ValuesCount; ++i) {
+        QCOMPARE(constantValues[i], 3.0);
+    }
+
+    values[0] = 9.0;
+
+    dataStore.addValues(double(ValuesCount+1));
+
+    QCOMPARE(variables[0]->size(), ValuesCount+2);
+    QCOMPARE(variables[0]->value(ValuesCount), 3.0);
+    QCOMPARE(variables[0]->value(ValuesCount+1), 9.0);
+    QCOMPARE(variables[0]->values()[ValuesCount+1], 9.0);
+}
+
+//==============================================================================
+
+void Tests::scratchDirectoryTests()
+{
+    // Add some values to a data store that uses a scratch directory and make
+    // sure that our values are contiguous and stored in that directory
+
+    static const quint64 ValuesCount = 100000;
+
+    QTemporaryDir scratchDirectory;
+
+    QVERIFY(scratchDirectory.isValid());
+
+    double value = 0.0;
+    OpenCOR::DataStore::DataStore dataStore;
+    OpenCOR::DataStore::DataStoreVariable *variable = dataStore.addVariable(&value);
+
+    dataStore.setScratchDirectory(scratchDirectory.path());
+
+    QVERIFY(dataStore.addRun(ValuesCount));
+    QVERIFY(!QDir(scratchDirectory.path()).entryList(QDir::Files).isEmpty());
+
+    for (quint64 i = 0; i < ValuesCount; ++i) {
+        value = 3.0*i;
+
+        dataStore.addValues(i);
+    }
+
+    double *values = variable->values();
+
+    QVERIFY(values != nullptr);
+    QCOMPARE(values[0], 0.0);
+    QCOMPARE(values[ValuesCount-1], 3.0*(ValuesCount-1));
+    QCOMPARE(dataStore.voi()->value(ValuesCount-1), double(ValuesCount-1));
+
+    // Add more variables than a process can usually have file descriptors
+    // open, and make sure that their runs can all be mapped to a file
+
+    static const int VariablesCount = 2000;
+    static const quint64 RunValuesCount = 1000;
+
+    QVector<double> manyValues(VariablesCount);
+    OpenCOR::DataStore::DataStore manyVariablesDataStore;
+    OpenCOR::DataStore::DataStoreVariables manyVariables = manyVariablesDataStore.addVariables(manyValues.data(), VariablesCount);
+
+    manyVariablesDataStore.setScratchDirectory(scratchDirectory.path());
+
+    QVERIFY(manyVariablesDataStore.addRun(RunValuesCount));
+    QVERIFY(manyVariablesDataStore.addRun(RunValuesCount));
+
+    manyValues[VariablesCount-1] = 7.0;
+
+    manyVariablesDataStore.addValues(0.0);
+
+    QCOMPARE(manyVariables.last()->value(0), 7.0);
+}
+
+//==============================================================================
+
+void Tests::addValuesBenchmark()
+{
+    // Benchmark the addition of values to a data store with many variables
+    // Note: we create our data store and its run, and get their arrays
+    //       allocated, before benchmarking, so that only the per-point cost of
+    //       adding values gets measured. This means that our benchmark can only
+    //       be run once since our run would otherwise be full...
+
+    static const int VariablesCount = 1000;
+    static const quint64 ValuesCount = 10000;
+
+    QVector<double> values(VariablesCount);
+    OpenCOR::DataStore::DataStore dataStore;
+
+    dataStore.addVariables(values.data(), VariablesCount);
+
+    QVERIFY(dataStore.addRun(ValuesCount));
+
+    QBENCHMARK_ONCE {
+        for (quint64 i = 0; i < ValuesCount; ++i) {
+            dataStore.addValues(double(i));
+        }
+    }
+
+    QCOMPARE(dataStore.size(), ValuesCount);
+}
+
+//==============================================================================
+
+QTEST_GUILESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================
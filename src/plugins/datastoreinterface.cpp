@@ -26,10 +26,16 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QDir>
+#include <QTemporaryFile>
 #include <QThread>
 
 //==============================================================================
 
+#include <algorithm>
+
+//==============================================================================
+
 namespace OpenCOR {
 
 //==============================================================================
@@ -38,7 +44,7 @@ extern "C" Q_DECL_EXPORT int dataStoreInterfaceVersion()
 {
     // Version of the data store interface
 
-    return 5;
+    return 9;
 }
 
 //==============================================================================
@@ -47,12 +53,43 @@ namespace DataStore {
 
 //==============================================================================
 
-DataStoreArray::DataStoreArray(quint64 pSize) :
+static const quint64 ChunkSize = 65536;
+
+//==============================================================================
+
+DataStoreArray::DataStoreArray(quint64 pSize,
+                               const QString &pScratchDirectory) :
     mSize(pSize)
 {
-    // Allocate our data
+    // Allocate our data, either in memory or, if we have been given a scratch
+    // directory, in a memory-mapped file
+    // Note #1: in the latter case, it is the OS that decides which parts of our
+    //          data are to be kept in memory and which parts are to be paged
+    //          out to disk, meaning that our data can be (much) bigger than
+    //          the physical memory while it remains contiguous...
+    // Note #2: a newly resized file is filled with zeros, and only the pages
+    //          to which we write end up being used on most file systems...
+    // Note #3: our file doesn't need to remain open once it has been mapped,
+    //          so we close it, or we might otherwise run out of file
+    //          descriptors with many variables and runs. Our mapping remains
+    //          valid until we unmap our file or delete it (see release())...
+
+    if (pScratchDirectory.isEmpty() || (pSize == 0)) {
+        mData = new double[pSize] {};
+    } else {
+        qint64 fileSize = qint64(pSize*Solver::SizeOfDouble);
+
+        mFile = new QTemporaryFile(QDir(pScratchDirectory).filePath("XXXXXX.dat"));
+
+        if (   !mFile->open() || !mFile->resize(fileSize)
+            || ((mData = reinterpret_cast<double *>(mFile->map(0, fileSize))) == nullptr)) {
+            delete mFile;
+
+            throw std::bad_alloc();
+        }
 
-    mData = new double[pSize] {};
+        mFile->close();
+    }
 }
 
 //==============================================================================
@@ -112,7 +149,13 @@ void DataStoreArray::release()
     // needed
 
     if (--mReferenceCounter == 0) {
-        delete[] mData;
+        if (mFile != nullptr) {
+            mFile->unmap(reinterpret_cast<uchar *>(mData));
+
+            delete mFile;
+        } else {
+            delete[] mData;
+        }
 
         delete this;
     }
@@ -197,13 +240,33 @@ DataStoreValues::~DataStoreValues()
 
 //==============================================================================
 
-DataStoreVariableRun::DataStoreVariableRun(quint64 pCapacity, double *pValue) :
+DataStoreVariableRun::DataStoreVariableRun(quint64 pCapacity, double *pValue,
+                                           StorageClass pStorageClass,
+                                           const QString &pScratchDirectory) :
     mCapacity(pCapacity),
+    mStorageClass(pStorageClass),
+    mScratchDirectory(pScratchDirectory),
     mValue(pValue)
 {
-    // Create our array of values
-
-    mArray = new DataStoreArray(mCapacity);
+    // Create our array of values, if we are to store our values densely
+    // Note #1: we don't allocate all the memory that we may need, but only a
+    //          chunk of it. Our array then grows, as needed, as values get
+    //          added to it (see grow()). This means that the memory we use
+    //          tracks the number of values that actually get added...
+    // Note #2: if we are to store a constant value, then we only keep track of
+    //          that value and of our size, unless our value changes, in which
+    //          case we switch to storing our values densely (see addValue())...
+    // Note #3: if we are to use a scratch directory, then our array is mapped
+    //          to a file, so we can allocate all the memory that we may need
+    //          straightaway since only the pages that get written to will
+    //          actually be used...
+
+    if (mStorageClass == StorageClass::Dense) {
+        mArray = new DataStoreArray(mScratchDirectory.isEmpty()?
+                                        qMin(mCapacity, ChunkSize):
+                                        mCapacity,
+                                    mScratchDirectory);
+    }
 }
 
 //==============================================================================
@@ -212,7 +275,13 @@ DataStoreVariableRun::~DataStoreVariableRun()
 {
     // Delete some internal objects
 
-    mArray->release();
+    for (auto oldArray : qAsConst(mOldArrays)) {
+        oldArray->release();
+    }
+
+    if (mArray != nullptr) {
+        mArray->release();
+    }
 }
 
 //==============================================================================
@@ -226,14 +295,112 @@ quint64 DataStoreVariableRun::size() const
 
 //==============================================================================
 
+quint64 DataStoreVariableRun::allocatedSize() const
+{
+    // Return the number of values for which we have allocated some memory,
+    // including in our old arrays
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    quint64 res = (mArray != nullptr)?mArray->size():0;
+
+    for (auto oldArray : qAsConst(mOldArrays)) {
+        res += oldArray->size();
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+StorageClass DataStoreVariableRun::storageClass() const
+{
+    // Return our storage class
+    // Note: our storage class may get changed from another thread (see
+    //       addValue()), hence we retrieve it using our array mutex...
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    return mStorageClass;
+}
+
+//==============================================================================
+
+bool DataStoreVariableRun::grow()
+{
+    // Grow our array, if possible, by doubling its size (up to our capacity)
+    // Note #1: our old array may still be referenced by someone (e.g. a graph
+    //          that is being plotted while we are running a simulation), so we
+    //          keep it until we get compacted...
+    // Note #2: our array may be retrieved from another thread (e.g. the GUI
+    //          thread while we are running a simulation), so we swap it using
+    //          our array mutex...
+
+    quint64 arraySize = mArray->size();
+
+    if (arraySize >= mCapacity) {
+        return false;
+    }
+
+    DataStoreArray *array;
+
+    try {
+        array = new DataStoreArray(qMin(mCapacity, qMax(arraySize << 1, ChunkSize)),
+                                   mScratchDirectory);
+    } catch (...) {
+        return false;
+    }
+
+    memcpy(array->data(), mArray->data(), mSize*Solver::SizeOfDouble);
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    mOldArrays << mArray;
+
+    mArray = array;
+
+    return true;
+}
+
+//==============================================================================
+
+void DataStoreVariableRun::materialize() const
+{
+    // Someone needs direct access to our values or we need to store them
+    // densely, so create an array for them, if we don't already have one
+    // Note #1: our array is only big enough for the values that we have so far
+    //          (and then some), and it grows, as needed, as values get added
+    //          to it (see grow()). This way, materialising a constant value
+    //          doesn't cost more memory than storing it densely in the first
+    //          place...
+    // Note #2: our array mutex must have been locked by our caller, so that
+    //          no value can get added to us (from another thread) while we are
+    //          creating our array...
+
+    if (mArray == nullptr) {
+        DataStoreArray *array;
+
+        try {
+            array = new DataStoreArray(qMin(mCapacity, mSize+qMax(mSize >> 3, ChunkSize)),
+                                       mScratchDirectory);
+        } catch (...) {
+            return;
+        }
+
+        std::fill(array->data(), array->data()+mSize, mConstantValue);
+
+        mArray = array;
+    }
+}
+
+//==============================================================================
+
 void DataStoreVariableRun::addValue()
 {
     // Set the value of the variable at the given position
 
-    if ((mSize < mCapacity) && (mValue != nullptr)) {
-        mArray->data()[mSize] = *mValue;
-
-        ++mSize;
+    if (mValue != nullptr) {
+        addValue(*mValue);
     }
 }
 
@@ -243,7 +410,48 @@ void DataStoreVariableRun::addValue(double pValue)
 {
     // Set the value of the variable at the given position using the given value
 
-    if (mSize < mCapacity) {
+    if (mStorageClass == StorageClass::Constant) {
+        // We are storing a constant value, so check whether the given value is
+        // that constant value (or our first value), in which case we only need
+        // to update our size
+        // Note: our array may get materialised from another thread (see
+        //       array()), hence we check for it using our array mutex...
+
+        QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+        if (mArray == nullptr) {
+            if (mSize == mCapacity) {
+                return;
+            }
+
+            if (   (mSize == 0)
+                || (pValue == mConstantValue)
+                || (qIsNaN(pValue) && qIsNaN(mConstantValue))) {
+                mConstantValue = pValue;
+
+                ++mSize;
+
+                return;
+            }
+
+            // The given value is different from our constant value, so
+            // materialise our values
+
+            materialize();
+
+            if (mArray == nullptr) {
+                return;
+            }
+        }
+
+        // We have an array, be it because our constant value has changed or
+        // because our values have been materialised, so we need to store our
+        // values densely from now on
+
+        mStorageClass = StorageClass::Dense;
+    }
+
+    if ((mSize < mArray->size()) || grow()) {
         mArray->data()[mSize] = pValue;
 
         ++mSize;
@@ -254,7 +462,15 @@ void DataStoreVariableRun::addValue(double pValue)
 
 DataStoreArray * DataStoreVariableRun::array() const
 {
-    // Return our array
+    // Return our array, after having materialised it, if needed
+    // Note: our array may get swapped from another thread (see grow()), hence
+    //       we retrieve it using our array mutex...
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    if (mArray == nullptr) {
+        materialize();
+    }
 
     return mArray;
 }
@@ -265,18 +481,74 @@ double DataStoreVariableRun::value(quint64 pPosition) const
 {
     // Return the value at the given position
 
-    return (pPosition < mSize)?
+    if (pPosition >= mSize) {
+        return qQNaN();
+    }
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    return (mArray != nullptr)?
                mArray->data()[pPosition]:
-               qQNaN();
+               mConstantValue;
 }
 
 //==============================================================================
 
 double * DataStoreVariableRun::values() const
 {
-    // Return our values
+    // Return our values, if any
+
+    DataStoreArray *array = DataStoreVariableRun::array();
+
+    return (array != nullptr)?
+               array->data():
+               nullptr;
+}
+
+//==============================================================================
+
+bool DataStoreVariableRun::compact()
+{
+    // Release our old arrays and shrink our array to our size, if needed
+    // Note #1: this should only be done once no values get added to us and
+    //          nobody references our old arrays anymore, e.g. once a
+    //          simulation has been run and its results have been retrieved
+    //          anew...
+    // Note #2: our array may still be referenced by someone, so rather than
+    //          releasing it straightaway, we keep it as an old array until we
+    //          get compacted again, and we let our caller know that it should
+    //          retrieve our (shrunk) array before doing so...
+    // Note #3: an array that is mapped to a file doesn't need shrinking since
+    //          only the pages to which we have written are actually used...
+
+    QMutexLocker arrayMutexLocker(&mArrayMutex);
+
+    for (auto oldArray : qAsConst(mOldArrays)) {
+        oldArray->release();
+    }
+
+    mOldArrays.clear();
 
-    return mArray->data();
+    if (   (mArray == nullptr) || !mScratchDirectory.isEmpty()
+        || (mArray->size() <= mSize)) {
+        return false;
+    }
+
+    DataStoreArray *array;
+
+    try {
+        array = new DataStoreArray(mSize);
+    } catch (...) {
+        return false;
+    }
+
+    memcpy(array->data(), mArray->data(), mSize*Solver::SizeOfDouble);
+
+    mOldArrays << mArray;
+
+    mArray = array;
+
+    return true;
 }
 
 //==============================================================================
@@ -334,12 +606,15 @@ int DataStoreVariable::runsCount() const
 
 //==============================================================================
 
-bool DataStoreVariable::addRun(quint64 pCapacity)
+bool DataStoreVariable::addRun(quint64 pCapacity,
+                               const QString &pScratchDirectory)
 {
-    // Try to add a run of the given capacity
+    // Try to add a run of the given capacity, using the given scratch
+    // directory, if any
 
     try {
-        mRuns << new DataStoreVariableRun(pCapacity, mValue);
+        mRuns << new DataStoreVariableRun(pCapacity, mValue, mStorageClass,
+                                          pScratchDirectory);
     } catch (...) {
         return false;
     }
@@ -362,6 +637,39 @@ void DataStoreVariable::keepRuns(int pRunsCount)
 
 //==============================================================================
 
+bool DataStoreVariable::compact()
+{
+    // Compact our runs and let our caller know whether some of them got shrunk
+
+    bool res = false;
+
+    for (auto run : qAsConst(mRuns)) {
+        res = run->compact() || res;
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+StorageClass DataStoreVariable::storageClass() const
+{
+    // Return our storage class
+
+    return mStorageClass;
+}
+
+//==============================================================================
+
+void DataStoreVariable::setStorageClass(StorageClass pStorageClass)
+{
+    // Set our storage class, which will be used by our future runs
+
+    mStorageClass = pStorageClass;
+}
+
+//==============================================================================
+
 int DataStoreVariable::type() const
 {
     // Return our type
@@ -453,6 +761,25 @@ quint64 DataStoreVariable::size(int pRun) const
 
 //==============================================================================
 
+DataStoreVariableRun * DataStoreVariable::run(int pRun) const
+{
+    // Return the given run, if any
+
+    if (mRuns.isEmpty()) {
+        return nullptr;
+    }
+
+    if (pRun == -1) {
+        return mRuns.last();
+    }
+
+    return ((pRun >= 0) && (pRun < mRuns.count()))?
+                mRuns[pRun]:
+                nullptr;
+}
+
+//==============================================================================
+
 DataStoreArray * DataStoreVariable::array(int pRun) const
 {
     // Return the array for the given run, if any
@@ -825,6 +1152,26 @@ QString DataStore::uri() const
 
 //==============================================================================
 
+QString DataStore::scratchDirectory() const
+{
+    // Return our scratch directory
+
+    return mScratchDirectory;
+}
+
+//==============================================================================
+
+void DataStore::setScratchDirectory(const QString &pScratchDirectory)
+{
+    // Set our scratch directory, i.e. the directory in which the values of our
+    // future runs are to be stored (in memory-mapped files), if any
+    // Note: our current runs, if any, are not affected...
+
+    mScratchDirectory = pScratchDirectory;
+}
+
+//==============================================================================
+
 int DataStore::runsCount() const
 {
     // Return our number of runs, i.e. the number of runs for our VOI, for
@@ -842,12 +1189,12 @@ bool DataStore::addRun(quint64 pCapacity)
     int oldRunsCount = mVoi->runsCount();
 
     try {
-        if (!mVoi->addRun(pCapacity)) {
+        if (!mVoi->addRun(pCapacity, mScratchDirectory)) {
             throw std::exception();
         }
 
         for (auto variable : qAsConst(mVariables)) {
-            if (!variable->addRun(pCapacity)) {
+            if (!variable->addRun(pCapacity, mScratchDirectory)) {
                 throw std::exception();
             }
         }
@@ -861,9 +1208,16 @@ bool DataStore::addRun(quint64 pCapacity)
             variable->keepRuns(oldRunsCount);
         }
 
+        invalidateRuns();
+
         return false;
     }
 
+    // Resolve the runs to which values are to be added, so that we don't have
+    // to do it every time values are added to us
+
+    resolveRuns();
+
     return true;
 }
 
@@ -926,6 +1280,8 @@ DataStoreVariables DataStore::addVariables(double *pValues, int pCount)
 
     mVariables << variables;
 
+    invalidateRuns();
+
     return variables;
 }
 
@@ -939,6 +1295,8 @@ DataStoreVariable * DataStore::addVariable(double *pValue)
 
     mVariables << variable;
 
+    invalidateRuns();
+
     return variable;
 }
 
@@ -953,6 +1311,8 @@ void DataStore::removeVariables(const DataStoreVariables &pVariables)
 
         mVariables.removeOne(variable);
     }
+
+    invalidateRuns();
 }
 
 //==============================================================================
@@ -964,6 +1324,8 @@ void DataStore::removeVariable(DataStoreVariable *pVariable)
     delete pVariable;
 
     mVariables.removeOne(pVariable);
+
+    invalidateRuns();
 }
 
 //==============================================================================
@@ -977,11 +1339,70 @@ void DataStore::addValues(double pVoiValue)
     //       the VOI value first, we might in some cases (see issue #1579 for
     //       example) end up with the wrong size...
 
+    if (mVoiRun == nullptr) {
+        resolveRuns();
+
+        if (mVoiRun == nullptr) {
+            return;
+        }
+    }
+
+    for (auto variableRun : qAsConst(mVariablesRuns)) {
+        variableRun->addValue();
+    }
+
+    mVoiRun->addValue(pVoiValue);
+}
+
+//==============================================================================
+
+void DataStore::resolveRuns()
+{
+    // Resolve the current (i.e. last) run of our VOI and variables, i.e. the
+    // runs to which addValues() adds values
+
+    invalidateRuns();
+
+    mVoiRun = mVoi->run();
+
+    if (mVoiRun != nullptr) {
+        mVariablesRuns.reserve(mVariables.count());
+
+        for (auto variable : qAsConst(mVariables)) {
+            DataStoreVariableRun *variableRun = variable->run();
+
+            if (variableRun != nullptr) {
+                mVariablesRuns << variableRun;
+            }
+        }
+    }
+}
+
+//==============================================================================
+
+void DataStore::invalidateRuns()
+{
+    // Invalidate our resolved runs
+
+    mVoiRun = nullptr;
+
+    mVariablesRuns.clear();
+}
+
+//==============================================================================
+
+bool DataStore::compact()
+{
+    // Compact our VOI and all our variables, and let our caller know whether
+    // some of them got shrunk (see DataStoreVariableRun::compact())
+
+    bool res = mVoi->compact();
+
     for (auto variable : qAsConst(mVariables)) {
-        variable->addValue();
+        res = variable->compact() || res;
     }
 
-    mVoi->addValue(pVoiValue);
+    return res;
 }
 
 //==============================================================================
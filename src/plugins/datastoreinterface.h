@@ -25,7 +25,13 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QMutex>
 #include <QObject>
+#include <QVector>
+
+//==============================================================================
+
+class QTemporaryFile;
 
 //==============================================================================
 
@@ -37,7 +43,8 @@ namespace DataStore {
 class DataStoreArray
 {
 public:
-    explicit DataStoreArray(quint64 pSize);
+    explicit DataStoreArray(quint64 pSize,
+                            const QString &pScratchDirectory = {});
 
     quint64 size() const;
 
@@ -54,6 +61,8 @@ private:
 
     quint64 mSize;
     double *mData = nullptr;
+
+    QTemporaryFile *mFile = nullptr;
 };
 
 //==============================================================================
@@ -90,15 +99,27 @@ public:
 
 //==============================================================================
 
+enum class StorageClass {
+    Dense,
+    Constant
+};
+
+//==============================================================================
+
 class DataStoreVariableRun : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit DataStoreVariableRun(quint64 pCapacity, double *pValue);
+    explicit DataStoreVariableRun(quint64 pCapacity, double *pValue,
+                                  StorageClass pStorageClass = StorageClass::Dense,
+                                  const QString &pScratchDirectory = {});
     ~DataStoreVariableRun() override;
 
     quint64 size() const;
+    quint64 allocatedSize() const;
+
+    StorageClass storageClass() const;
 
     DataStoreArray * array() const;
 
@@ -108,12 +129,27 @@ public:
     double value(quint64 pPosition) const;
     double * values() const;
 
+    bool compact();
+
 private:
     quint64 mCapacity;
     quint64 mSize = 0;
 
-    DataStoreArray *mArray = nullptr;
+    StorageClass mStorageClass;
+    double mConstantValue = 0.0;
+
+    QString mScratchDirectory;
+
+    mutable QMutex mArrayMutex;
+
+    mutable DataStoreArray *mArray = nullptr;
+    QList<DataStoreArray *> mOldArrays;
+
     double *mValue;
+
+    bool grow();
+
+    void materialize() const;
 };
 
 //==============================================================================
@@ -133,15 +169,22 @@ public:
     static bool compare(DataStoreVariable *pVariable1,
                         DataStoreVariable *pVariable2);
 
-    bool addRun(quint64 pCapacity);
+    bool addRun(quint64 pCapacity, const QString &pScratchDirectory = {});
     void keepRuns(int pRunsCount);
 
+    bool compact();
+
+    StorageClass storageClass() const;
+    void setStorageClass(StorageClass pStorageClass);
+
     void setType(int pType);
 
     void setUri(const QString &pUri);
     void setName(const QString &pName);
     void setUnit(const QString &pUnit);
 
+    DataStoreVariableRun * run(int pRun = -1) const;
+
     DataStoreArray * array(int pRun = -1) const;
 
     void addValue();
@@ -168,6 +211,8 @@ public slots:
     void setValue(double pValue);
 
 private:
+    StorageClass mStorageClass = StorageClass::Dense;
+
     int mType = -1;
     QString mUri;
     QString mName;
@@ -303,9 +348,14 @@ public:
 
     void addValues(double pVoiValue);
 
+    bool compact();
+
 public slots:
     QString uri() const;
 
+    QString scratchDirectory() const;
+    void setScratchDirectory(const QString &pScratchDirectory);
+
     int runsCount() const;
 
     quint64 size(int pRun = -1) const;
@@ -314,9 +364,16 @@ public slots:
 
 private:
     QString mUri;
+    QString mScratchDirectory;
 
     DataStoreVariable *mVoi = nullptr;
     DataStoreVariables mVariables;
+
+    DataStoreVariableRun *mVoiRun = nullptr;
+    QVector<DataStoreVariableRun *> mVariablesRuns;
+
+    void resolveRuns();
+    void invalidateRuns();
 };
 
 //==============================================================================
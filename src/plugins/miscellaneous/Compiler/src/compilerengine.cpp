@@ -28,6 +28,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "compilerengine.h"
+#include "compilerirgenerator.h"
 #include "compilermath.h"
 
 //==============================================================================
@@ -41,10 +42,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
     #include "clang/Frontend/TextDiagnosticPrinter.h"
     #include "clang/Lex/PreprocessorOptions.h"
 
+    #include "llvm/Config/llvm-config.h"
+    #include "llvm/ExecutionEngine/Orc/CompileUtils.h"
     #include "llvm/Support/Host.h"
     #include "llvm/Support/TargetSelect.h"
-
-    #include "llvm-c/Core.h"
 #include "llvmclangend.h"
 
 //==============================================================================
@@ -54,51 +55,16 @@ namespace Compiler {
 
 //==============================================================================
 
-bool CompilerEngine::hasError() const
-{
-    // Return whether an error occurred
-
-    return !mError.isEmpty();
-}
+static constexpr char const *DummyFileName = "dummy.c";
 
 //==============================================================================
 
-QString CompilerEngine::error() const
-{
-    // Return the compiler engine's error
-
-    return mError;
-}
-
-//==============================================================================
-
-bool CompilerEngine::addFunction(const QString &pName, void *pFunction)
+static QString completeCode(const QString &pCode)
 {
-    // Add the given function.
-
-    if ((mLljit != nullptr) && !pName.isEmpty() && (pFunction != nullptr)) {
-        auto &jitDylib = mLljit->getMainJITDylib();
-
-        return !jitDylib.define(llvm::orc::absoluteSymbols({
-                                                               { mLljit->mangleAndIntern(pName.toStdString()), llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(pFunction), llvm::JITSymbolFlags::Exported) },
-                                                           }));
-    }
-
-    return false;
-}
-
-//==============================================================================
-
-bool CompilerEngine::compileCode(const QString &pCode)
-{
-    // Reset ourselves
-
-    mError = QString();
-
     // Prepend all the external functions that may, or not, be needed by the
     // given code
 
-    QString code =  R"(
+    return R"(
 extern double fabs(double);
 
 extern double log(double);
@@ -149,7 +115,242 @@ extern double multi_max(int, ...);
 extern double gcd_multi(int, ...);
 extern double lcm_multi(int, ...);
 )"+pCode;
+}
+
+//==============================================================================
+
+static std::vector<const char *> clangArguments(CompilerEngine::OptimisationLevel pOptimisationLevel)
+{
+    // Return the arguments that we want to pass to our compilation object
+    // Note #1: a fast optimisation level is only meant to get some (reasonably
+    //          efficient) code as quickly as possible. We therefore still
+    //          target the host CPU so that everything but the optimisation
+    //          level is the same as with a full optimisation level...
+    // Note #2: -march=native doesn't make our code any less portable than it
+    //          already is. Indeed, our code is JIT-compiled for the host CPU
+    //          (both by LLJIT and by our IR generator) and our object cache
+    //          key includes the name of that CPU (see objectCacheKey()). What
+    //          -march=native does, however, is to tell Clang's vectoriser how
+    //          wide our vectors can be, without which it would only use SSE2
+    //          (i.e. two doubles at a time). This matters for the code that our
+    //          IR generator doesn't support and which contains loops, i.e. the
+    //          ensemble code of a CellML file runtime and the integrator code
+    //          of a fixed-step ODE solver. We only use it on x86_64 since it
+    //          isn't supported on all ARM hosts...
+
+#ifdef QT_DEBUG
+    Q_UNUSED(pOptimisationLevel)
+#endif
+
+    return { "clang", "-fsyntax-only",
+#ifdef QT_DEBUG
+             "-g",
+             "-O0",
+#else
+             (pOptimisationLevel == CompilerEngine::OptimisationLevel::Fast)?
+                 "-O1":
+                 "-O3",
+    #if defined(Q_PROCESSOR_X86_64)
+             "-march=native",
+    #endif
+#endif
+             "-fno-math-errno",
+             DummyFileName };
+}
+
+//==============================================================================
+
+static QByteArray objectCacheKey(const QByteArray &pCode,
+                                 const std::vector<const char *> &pCompilationArguments)
+{
+    // Return the key of the given code in our object cache
+    // Note: our object depends on our code, but also on our compilation
+    //       arguments, the host we are running on, the version of LLVM that we
+    //       are using and the version of our IR generator, which may generate
+    //       the LLVM IR module of our code itself (see compileCode())...
+
+    QByteArray res = pCode;
+
+    for (auto compilationArgument : pCompilationArguments) {
+        res += '\0';
+        res += compilationArgument;
+    }
+
+    res += '\0';
+    res += llvm::sys::getProcessTriple().c_str();
+    res += '\0';
+    res += llvm::sys::getHostCPUName().str().c_str();
+    res += '\0';
+    res += LLVM_VERSION_STRING;
+    res += '\0';
+    res += QByteArray::number(IrGeneratorVersion);
+
+    return res;
+}
+
+//==============================================================================
+
+bool CompilerEngine::hasCachedObject(const QString &pCode,
+                                     OptimisationLevel pOptimisationLevel)
+{
+    // Return whether the object for the given code, compiled using the given
+    // optimisation level, is in our object cache
+
+    return CompilerObjectCache(objectCacheKey(completeCode(pCode).toUtf8(),
+                                              clangArguments(pOptimisationLevel))).object() != nullptr;
+}
+
+//==============================================================================
+
+bool CompilerEngine::hasError() const
+{
+    // Return whether an error occurred
+
+    return !mError.isEmpty();
+}
+
+//==============================================================================
+
+QString CompilerEngine::error() const
+{
+    // Return the compiler engine's error
+
+    return mError;
+}
+
+//==============================================================================
+
+bool CompilerEngine::addFunction(const QString &pName, void *pFunction)
+{
+    // Add the given function.
+
+    if ((mLljit != nullptr) && !pName.isEmpty() && (pFunction != nullptr)) {
+        auto &jitDylib = mLljit->getMainJITDylib();
+        llvm::Error error = jitDylib.define(llvm::orc::absoluteSymbols({
+                                                                           { mLljit->mangleAndIntern(pName.toStdString()), llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(pFunction), llvm::JITSymbolFlags::Exported) },
+                                                                       }));
+
+        // Note: our function couldn't be added (e.g. because it has already
+        //       been defined), so we must consume the error, or LLVM will abort
+        //       if it has been built with ABI-breaking checks enabled...
+
+        if (error) {
+            llvm::consumeError(std::move(error));
+
+            return false;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+
+bool CompilerEngine::createLljit(std::unique_ptr<CompilerObjectCache> pObjectCache)
+{
+    // Initialise the native target (and its ASM printer), so not only can we
+    // then create an execution engine, but more importantly its data layout
+    // will match that of our target platform
+    // Note: this is only done once since we may be called from different
+    //       threads at the same time...
+
+    static const bool nativeTargetInitialised = []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+
+        return true;
+    }();
+
+    Q_UNUSED(nativeTargetInitialised)
+
+    // Create an ORC-based JIT and keep track of it (so that we can use it in
+    // function())
+    // Note: if we have an object cache, then we use our own compile function
+    //       so that the object generated by our JIT gets cached. Also, our
+    //       JIT must be deleted before our object cache, hence we keep track of
+    //       our JIT first...
+
+    llvm::orc::LLJITBuilder lljitBuilder;
+    CompilerObjectCache *objectCache = pObjectCache.get();
+
+    if (objectCache != nullptr) {
+        lljitBuilder.setCompileFunctionCreator([objectCache](llvm::orc::JITTargetMachineBuilder pJitTargetMachineBuilder)
+                                                   -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            auto targetMachine = pJitTargetMachineBuilder.createTargetMachine();
+
+            if (!targetMachine) {
+                return targetMachine.takeError();
+            }
+
+            return std::make_unique<llvm::orc::TMOwningSimpleCompiler>(std::move(*targetMachine), objectCache);
+        });
+    }
+
+    auto lljit = lljitBuilder.create();
+
+    if (!lljit) {
+        mError = tr("the ORC-based JIT could not be created");
+
+        return false;
+    }
+
+    mLljit = std::move(*lljit);
+    mObjectCache = std::move(pObjectCache);
+
+    // Make sure that we can find various mathematical functions in the standard
+    // C library and the additional ones that we want to support (see
+    // compilermath.[cpp|h])
 
+    auto dynamicLibrarySearchGenerator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(mLljit->getDataLayout().getGlobalPrefix());
+
+    if (!dynamicLibrarySearchGenerator) {
+        mError = tr("the dynamic library search generator could not be created");
+
+        return false;
+    }
+
+    mLljit->getMainJITDylib().addGenerator(std::move(*dynamicLibrarySearchGenerator));
+
+    if (   !addFunction("factorial", reinterpret_cast<void *>(factorial))
+
+        || !addFunction("sec", reinterpret_cast<void *>(sec))
+        || !addFunction("sech", reinterpret_cast<void *>(sech))
+        || !addFunction("asec", reinterpret_cast<void *>(asec))
+        || !addFunction("asech", reinterpret_cast<void *>(asech))
+
+        || !addFunction("csc", reinterpret_cast<void *>(csc))
+        || !addFunction("csch", reinterpret_cast<void *>(csch))
+        || !addFunction("acsc", reinterpret_cast<void *>(acsc))
+        || !addFunction("acsch", reinterpret_cast<void *>(acsch))
+
+        || !addFunction("cot", reinterpret_cast<void *>(cot))
+        || !addFunction("coth", reinterpret_cast<void *>(coth))
+        || !addFunction("acot", reinterpret_cast<void *>(acot))
+        || !addFunction("acoth", reinterpret_cast<void *>(acoth))
+
+        || !addFunction("arbitrary_log", reinterpret_cast<void *>(arbitrary_log))
+
+        || !addFunction("multi_min", reinterpret_cast<void *>(multi_min))
+        || !addFunction("multi_max", reinterpret_cast<void *>(multi_max))
+
+        || !addFunction("gcd_multi", reinterpret_cast<void *>(gcd_multi))
+        || !addFunction("lcm_multi", reinterpret_cast<void *>(lcm_multi))) {
+        mError = tr("the additional mathematical methods could not be added");
+
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+std::unique_ptr<llvm::Module> CompilerEngine::clangModule(const QByteArray &pCode,
+                                                          const std::vector<const char *> &pCompilationArguments,
+                                                          llvm::LLVMContext &pContext)
+{
     // Create a diagnostics engine
 
     auto diagnosticOptions = llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions>(new clang::DiagnosticOptions());
@@ -165,26 +366,14 @@ extern double lcm_multi(int, ...);
 
     driver.setCheckInputsExist(false);
 
-    // Get a compilation object to which we pass some arguments
-
-    constexpr char const *DummyFileName = "dummy.c";
-
-    std::vector<const char *> compilationArguments = {"clang", "-fsyntax-only",
-#ifdef QT_DEBUG
-                                                      "-g",
-                                                      "-O0",
-#else
-                                                      "-O3",
-#endif
-                                                      "-fno-math-errno",
-                                                      DummyFileName};
+    // Get a compilation object to which we pass our arguments
 
-    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(compilationArguments));
+    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(pCompilationArguments));
 
     if (!compilation) {
         mError = tr("the compilation object could not be created");
 
-        return false;
+        return nullptr;
     }
 
     // The compilation object should have only one command, so if it doesn't
@@ -196,7 +385,7 @@ extern double lcm_multi(int, ...);
         || !llvm::isa<clang::driver::Command>(*jobs.begin())) {
         mError = tr("the compilation object must contain only one command");
 
-        return false;
+        return nullptr;
     }
 
     // Retrieve the command job and make sure that it is "clang"
@@ -209,7 +398,7 @@ extern double lcm_multi(int, ...);
     if (strcmp(command.getCreator().getName(), Clang) != 0) {
         mError = tr("a <strong>clang</strong> command was expected, but a <strong>%1</strong> command was found instead").arg(commandName);
 
-        return false;
+        return nullptr;
     }
 
     // Prevent the Clang driver from asking CC1 to leak memory, this by removing
@@ -236,102 +425,118 @@ extern double lcm_multi(int, ...);
                                                    *diagnosticsEngine)) {
         mError = tr("the compiler invocation object could not be created");
 
-        return false;
+        return nullptr;
     }
 
     // Map our code to a memory buffer
 
-    QByteArray codeByteArray = code.toUtf8();
-
     compilerInstance.getInvocation().getPreprocessorOpts().addRemappedFile(DummyFileName,
-                                                                           llvm::MemoryBuffer::getMemBuffer(codeByteArray.constData()).release());
+                                                                           llvm::MemoryBuffer::getMemBuffer(pCode.constData()).release());
 
     // Compile the given code, resulting in an LLVM bitcode module
 
-    std::unique_ptr<clang::CodeGenAction> codeGenAction(new clang::EmitLLVMOnlyAction(llvm::unwrap(LLVMGetGlobalContext())));
+    std::unique_ptr<clang::CodeGenAction> codeGenAction(new clang::EmitLLVMOnlyAction(&pContext));
 
     if (!compilerInstance.ExecuteAction(*codeGenAction)) {
         mError = tr("the code could not be compiled");
 
-        return false;
+        return nullptr;
     }
 
     // Retrieve the LLVM bitcode module
 
-    auto module = codeGenAction->takeModule();
+    auto res = codeGenAction->takeModule();
 
-    if (!module) {
+    if (!res) {
         mError = tr("the bitcode module could not be retrieved");
 
-        return false;
+        return nullptr;
     }
 
-    // Initialise the native target (and its ASM printer), so not only can we
-    // then create an execution engine, but more importantly its data layout
-    // will match that of our target platform
+    return res;
+}
 
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
+//==============================================================================
 
-    // Create an ORC-based JIT and keep track of it (so that we can use it in
-    // function())
+bool CompilerEngine::compileCode(const QString &pCode,
+                                 OptimisationLevel pOptimisationLevel)
+{
+    // Reset ourselves
 
-    auto lljit = llvm::orc::LLJITBuilder().create();
+    mError = QString();
 
-    if (!lljit) {
-        mError = tr("the ORC-based JIT could not be created");
+    // Prepend all the external functions that may, or not, be needed by the
+    // given code
 
-        return false;
-    }
+    QString code = completeCode(pCode);
 
-    mLljit = std::move(*lljit);
+    // Determine the arguments that we want to pass to our compilation object
 
-    // Make sure that we can find various mathematical functions in the standard
-    // C library and the additional ones that we want to support (see
-    // compilermath.[cpp|h])
+    std::vector<const char *> compilationArguments = clangArguments(pOptimisationLevel);
 
-    auto dynamicLibrarySearchGenerator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(mLljit->getDataLayout().getGlobalPrefix());
+    // Check whether we have already compiled our code, in which case we can
+    // load the corresponding object straightaway
 
-    if (!dynamicLibrarySearchGenerator) {
-        mError = tr("the dynamic library search generator could not be created");
+    QByteArray codeByteArray = code.toUtf8();
+    auto objectCache = std::make_unique<CompilerObjectCache>(objectCacheKey(codeByteArray, compilationArguments));
+    std::unique_ptr<llvm::MemoryBuffer> object = objectCache->object();
 
-        return false;
-    }
+    mFromObjectCache = false;
+    mFromClang = false;
 
-    mLljit->getMainJITDylib().addGenerator(std::move(*dynamicLibrarySearchGenerator));
+    if (object) {
+        if (!createLljit(nullptr)) {
+            return false;
+        }
 
-    if (   !addFunction("factorial", reinterpret_cast<void *>(factorial))
+        llvm::Error error = mLljit->addObjectFile(std::move(object));
 
-        || !addFunction("sec", reinterpret_cast<void *>(sec))
-        || !addFunction("sech", reinterpret_cast<void *>(sech))
-        || !addFunction("asec", reinterpret_cast<void *>(asec))
-        || !addFunction("asech", reinterpret_cast<void *>(asech))
+        if (!error) {
+            mFromObjectCache = true;
 
-        || !addFunction("csc", reinterpret_cast<void *>(csc))
-        || !addFunction("csch", reinterpret_cast<void *>(csch))
-        || !addFunction("acsc", reinterpret_cast<void *>(acsc))
-        || !addFunction("acsch", reinterpret_cast<void *>(acsch))
+            return true;
+        }
 
-        || !addFunction("cot", reinterpret_cast<void *>(cot))
-        || !addFunction("coth", reinterpret_cast<void *>(coth))
-        || !addFunction("acot", reinterpret_cast<void *>(acot))
-        || !addFunction("acoth", reinterpret_cast<void *>(acoth))
+        // Our cached object couldn't be loaded, so remove it and compile our
+        // code as normal
 
-        || !addFunction("arbitrary_log", reinterpret_cast<void *>(arbitrary_log))
+        llvm::consumeError(std::move(error));
 
-        || !addFunction("multi_min", reinterpret_cast<void *>(multi_min))
-        || !addFunction("multi_max", reinterpret_cast<void *>(multi_max))
+        objectCache->removeObject();
+    }
 
-        || !addFunction("gcd_multi", reinterpret_cast<void *>(gcd_multi))
-        || !addFunction("lcm_multi", reinterpret_cast<void *>(lcm_multi))) {
-        mError = tr("the additional mathematical methods could not be added");
+    // Generate an LLVM IR module for the given code, either directly or, if
+    // the given code is not supported by our IR generator, using Clang
+    // Note #1: generating an LLVM IR module directly is much faster than using
+    //          Clang, especially for large models, since we don't need to
+    //          parse all the external functions or go through Clang's
+    //          frontend...
+    // Note #2: we use our own LLVM context (rather than the global one) so
+    //          that code can be compiled from different threads at the same
+    //          time...
+
+    auto llvmContext = std::make_unique<llvm::LLVMContext>();
+    std::unique_ptr<llvm::Module> module = CompilerIrGenerator(*llvmContext, pOptimisationLevel).module(pCode);
+
+    if (!module) {
+        module = clangModule(codeByteArray, compilationArguments, *llvmContext);
+
+        if (!module) {
+            return false;
+        }
 
+        mFromClang = true;
+    }
+
+    // Create our ORC-based JIT, making sure that the object it will generate
+    // for our LLVM bitcode module gets cached
+
+    if (!createLljit(std::move(objectCache))) {
         return false;
     }
 
     // Add our LLVM bitcode module to our ORC-based JIT
 
-    auto llvmContext = std::make_unique<llvm::LLVMContext>();
     auto threadSafeModule = llvm::orc::ThreadSafeModule(std::move(module), std::move(llvmContext));
 
     if (mLljit->addIRModule(std::move(threadSafeModule))) {
@@ -345,6 +550,24 @@ extern double lcm_multi(int, ...);
 
 //==============================================================================
 
+bool CompilerEngine::fromObjectCache() const
+{
+    // Return whether our code was loaded from our object cache
+
+    return mFromObjectCache;
+}
+
+//==============================================================================
+
+bool CompilerEngine::fromClang() const
+{
+    // Return whether our code was compiled using Clang
+
+    return mFromClang;
+}
+
+//==============================================================================
+
 void * CompilerEngine::function(const QString &pName)
 {
     // Return the address of the requested function
@@ -26,6 +26,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "compilerglobal.h"
+#include "compilerobjectcache.h"
 
 //==============================================================================
 
@@ -50,19 +51,41 @@ class COMPILER_EXPORT CompilerEngine : public QObject
     Q_OBJECT
 
 public:
+    enum class OptimisationLevel {
+        Fast,
+        Full
+    };
+
+    static bool hasCachedObject(const QString &pCode,
+                                OptimisationLevel pOptimisationLevel = OptimisationLevel::Full);
+
     bool hasError() const;
     QString error() const;
 
     bool addFunction(const QString &pName, void *pFunction);
 
-    bool compileCode(const QString &pCode);
+    bool compileCode(const QString &pCode,
+                     OptimisationLevel pOptimisationLevel = OptimisationLevel::Full);
+
+    bool fromObjectCache() const;
+    bool fromClang() const;
 
     void * function(const QString &pName);
 
 private:
+    std::unique_ptr<CompilerObjectCache> mObjectCache;
     std::unique_ptr<llvm::orc::LLJIT> mLljit;
 
+    bool mFromObjectCache = false;
+    bool mFromClang = false;
+
     QString mError;
+
+    bool createLljit(std::unique_ptr<CompilerObjectCache> pObjectCache);
+
+    std::unique_ptr<llvm::Module> clangModule(const QByteArray &pCode,
+                                              const std::vector<const char *> &pCompilationArguments,
+                                              llvm::LLVMContext &pContext);
 };
 
 //==============================================================================
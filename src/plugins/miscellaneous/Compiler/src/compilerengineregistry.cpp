@@ -0,0 +1,180 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler engine registry
+//==============================================================================
+
+#include "compilerengine.h"
+#include "compilerengineregistry.h"
+#include "corecliutils.h"
+
+//==============================================================================
+
+#include <QCryptographicHash>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+CompilerEngineRegistry * CompilerEngineRegistry::instance()
+{
+    // Return the 'global' instance of our compiler engine registry class
+
+    static CompilerEngineRegistry instance;
+
+    return static_cast<CompilerEngineRegistry *>(Core::globalInstance("OpenCOR::Compiler::CompilerEngineRegistry::instance()",
+                                                                      &instance));
+}
+
+//==============================================================================
+
+QByteArray CompilerEngineRegistry::key(const QString &pCode,
+                                       CompilerEngine::OptimisationLevel pOptimisationLevel)
+{
+    // Return the key for the given code and optimisation level
+
+    return QCryptographicHash::hash(pCode.toUtf8(), QCryptographicHash::Sha1)+char(pOptimisationLevel);
+}
+
+//==============================================================================
+
+bool CompilerEngineRegistry::hasCompiledCode(const QString &pCode,
+                                             CompilerEngine::OptimisationLevel pOptimisationLevel)
+{
+    // Return whether the given code has already been compiled using the given
+    // optimisation level, i.e. whether one of our compiler engines has
+    // compiled it or whether its object is in our object cache
+
+    {
+        QMutexLocker locker(&mMutex);
+
+        if (mCompilerEngines.contains(key(pCode, pOptimisationLevel))) {
+            return true;
+        }
+    }
+
+    return CompilerEngine::hasCachedObject(pCode, pOptimisationLevel);
+}
+
+//==============================================================================
+
+CompilerEngine * CompilerEngineRegistry::compilerEngine(const QString &pCode,
+                                                        CompilerEngine::OptimisationLevel pOptimisationLevel,
+                                                        bool pShared)
+{
+    // Return a compiler engine for the given code and optimisation level, i.e.
+    // a compiler engine that has already compiled the same code using the same
+    // optimisation level, if any, or a new one otherwise
+    // Note #1: the compiler engine must be released once it is not needed
+    //          anymore (see release()), whether the code could be compiled or
+    //          not (see CompilerEngine::hasError())...
+    // Note #2: only compiler engines that could compile their code are shared,
+    //          so that a new attempt is made every time some invalid code is
+    //          to be compiled...
+    // Note #3: we don't compile the code while holding our mutex since it may
+    //          take a while (e.g. when compiling a big model in the
+    //          background), meaning that two threads may end up compiling the
+    //          same code at the same time, in which case we only keep the
+    //          compiler engine that was registered first...
+    // Note #4: a compiler engine that is not to be shared is for code that
+    //          refers to symbols that are specific to whoever is going to use
+    //          it (see CompilerEngine::addFunction()). Such a compiler engine
+    //          is never registered, but its object may still come from our
+    //          object cache...
+
+    if (!pShared) {
+        auto res = new CompilerEngine();
+
+        res->compileCode(pCode, pOptimisationLevel);
+
+        return res;
+    }
+
+    QByteArray compilerEngineKey = key(pCode, pOptimisationLevel);
+
+    {
+        QMutexLocker locker(&mMutex);
+        CompilerEngine *res = mCompilerEngines.value(compilerEngineKey);
+
+        if (res != nullptr) {
+            ++mEntries[res].referenceCount;
+
+            return res;
+        }
+    }
+
+    auto res = new CompilerEngine();
+
+    if (res->compileCode(pCode, pOptimisationLevel)) {
+        QMutexLocker locker(&mMutex);
+        CompilerEngine *compilerEngine = mCompilerEngines.value(compilerEngineKey);
+
+        if (compilerEngine != nullptr) {
+            ++mEntries[compilerEngine].referenceCount;
+
+            delete res;
+
+            return compilerEngine;
+        }
+
+        mCompilerEngines.insert(compilerEngineKey, res);
+        mEntries.insert(res, { compilerEngineKey, 1 });
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void CompilerEngineRegistry::release(CompilerEngine *pCompilerEngine)
+{
+    // Release the given compiler engine and delete it, if it is not used
+    // anymore
+
+    if (pCompilerEngine == nullptr) {
+        return;
+    }
+
+    QMutexLocker locker(&mMutex);
+    auto entry = mEntries.find(pCompilerEngine);
+
+    if (entry != mEntries.end()) {
+        if (--entry->referenceCount != 0) {
+            return;
+        }
+
+        mCompilerEngines.remove(entry->key);
+        mEntries.erase(entry);
+    }
+
+    delete pCompilerEngine;
+}
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,81 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler engine registry
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "compilerengine.h"
+#include "compilerglobal.h"
+
+//==============================================================================
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+class COMPILER_EXPORT CompilerEngineRegistry
+{
+public:
+    static CompilerEngineRegistry * instance();
+
+    bool hasCompiledCode(const QString &pCode,
+                         CompilerEngine::OptimisationLevel pOptimisationLevel = CompilerEngine::OptimisationLevel::Full);
+
+    CompilerEngine * compilerEngine(const QString &pCode,
+                                    CompilerEngine::OptimisationLevel pOptimisationLevel = CompilerEngine::OptimisationLevel::Full,
+                                    bool pShared = true);
+    void release(CompilerEngine *pCompilerEngine);
+
+private:
+    static QByteArray key(const QString &pCode,
+                          CompilerEngine::OptimisationLevel pOptimisationLevel);
+
+    struct Entry
+    {
+        QByteArray key;
+        int referenceCount;
+    };
+
+    QMutex mMutex;
+
+    QHash<QByteArray, CompilerEngine *> mCompilerEngines;
+    QHash<CompilerEngine *, Entry> mEntries;
+};
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
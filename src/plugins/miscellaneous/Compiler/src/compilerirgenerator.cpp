@@ -0,0 +1,1034 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler IR generator
+//==============================================================================
+
+#include "compilerirgenerator.h"
+
+//==============================================================================
+
+#include <QStringList>
+
+//==============================================================================
+
+#include "llvmclangbegin.h"
+    #include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+    #include "llvm/IR/Verifier.h"
+    #include "llvm/Passes/PassBuilder.h"
+    #include "llvm/Target/TargetMachine.h"
+#include "llvmclangend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+CompilerIrGenerator::CompilerIrGenerator(llvm::LLVMContext &pContext,
+                                         CompilerEngine::OptimisationLevel pOptimisationLevel) :
+    mContext(pContext),
+    mOptimisationLevel(pOptimisationLevel),
+    mBuilder(pContext)
+{
+}
+
+//==============================================================================
+
+std::unique_ptr<llvm::Module> CompilerIrGenerator::module(const QString &pCode)
+{
+    // Generate an LLVM IR module for the given code
+    // Note: we only support the subset of C that is used for our model code,
+    //       i.e. functions that take doubles and/or arrays of doubles, and that
+    //       consist of array assignments and/or a return statement. Anything
+    //       else (e.g. a cast, a loop, a call to a function that takes a
+    //       variable number of arguments) results in no module being
+    //       generated, in which case our caller should fall back on Clang,
+    //       which is also what should report errors in the given code...
+
+    mTokenIndex = 0;
+    mFunctionNames.clear();
+
+    if (!tokenize(pCode)) {
+        return nullptr;
+    }
+
+    mModule = std::make_unique<llvm::Module>("model", mContext);
+
+    while (token().type != TokenType::End) {
+        if (!parseFunction()) {
+            mModule.reset();
+
+            return nullptr;
+        }
+    }
+
+    // Make sure that our module is valid
+    // Note: this should always be the case, but better be safe than sorry...
+
+    if (llvm::verifyModule(*mModule, &llvm::nulls())) {
+        mModule.reset();
+
+        return nullptr;
+    }
+
+    // Optimise our module
+
+    optimise();
+
+    return std::move(mModule);
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::tokenize(const QString &pCode)
+{
+    // Split the given code into tokens
+
+    static const QStringList Punctuators = { "&&", "||", "==", "!=", "<=", ">=",
+                                             "(", ")", "[", "]", "{", "}", ",",
+                                             ";", "=", "?", ":", "+", "-", "*",
+                                             "/", "!", "<", ">" };
+
+    mTokens.clear();
+
+    int codeSize = pCode.size();
+
+    for (int i = 0; i < codeSize;) {
+        QChar character = pCode[i];
+
+        if (character.isSpace()) {
+            ++i;
+        } else if (character.isLetter() || (character == '_')) {
+            int start = i;
+
+            while (   (i < codeSize)
+                   && (pCode[i].isLetterOrNumber() || (pCode[i] == '_'))) {
+                ++i;
+            }
+
+            mTokens << Token { TokenType::Identifier, pCode.mid(start, i-start) };
+        } else if (   character.isDigit()
+                   || ((character == '.') && (i+1 < codeSize) && pCode[i+1].isDigit())) {
+            // Note: we don't support hexadecimal, octal or suffixed numbers,
+            //       none of which is used in our model code...
+
+            int start = i;
+            bool isInteger = true;
+
+            while ((i < codeSize) && pCode[i].isDigit()) {
+                ++i;
+            }
+
+            if ((i < codeSize) && (pCode[i] == '.')) {
+                isInteger = false;
+
+                ++i;
+
+                while ((i < codeSize) && pCode[i].isDigit()) {
+                    ++i;
+                }
+            }
+
+            if ((i < codeSize) && ((pCode[i] == 'e') || (pCode[i] == 'E'))) {
+                isInteger = false;
+
+                ++i;
+
+                if ((i < codeSize) && ((pCode[i] == '+') || (pCode[i] == '-'))) {
+                    ++i;
+                }
+
+                if ((i == codeSize) || !pCode[i].isDigit()) {
+                    return false;
+                }
+
+                while ((i < codeSize) && pCode[i].isDigit()) {
+                    ++i;
+                }
+            }
+
+            if (   (i < codeSize)
+                && (pCode[i].isLetter() || (pCode[i] == '_') || (pCode[i] == '.'))) {
+                return false;
+            }
+
+            QString number = pCode.mid(start, i-start);
+
+            if (isInteger && (number.startsWith('0') && (number.size() > 1))) {
+                return false;
+            }
+
+            mTokens << Token { isInteger?TokenType::Integer:TokenType::Double, number };
+        } else {
+            bool found = false;
+
+            for (const auto &punctuator : Punctuators) {
+                if (pCode.midRef(i, punctuator.size()) == punctuator) {
+                    mTokens << Token { TokenType::Punctuator, punctuator };
+
+                    i += punctuator.size();
+
+                    found = true;
+
+                    break;
+                }
+            }
+
+            if (!found) {
+                return false;
+            }
+        }
+    }
+
+    mTokens << Token { TokenType::End, QString() };
+
+    return true;
+}
+
+//==============================================================================
+
+const CompilerIrGenerator::Token & CompilerIrGenerator::token() const
+{
+    // Return our current token
+
+    return mTokens[mTokenIndex];
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::isPunctuator(const char *pPunctuator) const
+{
+    // Return whether our current token is the given punctuator
+
+    return    (token().type == TokenType::Punctuator)
+           && (token().text == pPunctuator);
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::accept(const char *pPunctuator)
+{
+    // Skip our current token if it is the given punctuator
+
+    if (isPunctuator(pPunctuator)) {
+        ++mTokenIndex;
+
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::identifier(QString &pIdentifier)
+{
+    // Retrieve our current token, which must be an identifier that is not a
+    // keyword
+
+    static const QSet<QString> Keywords = { "auto", "break", "case", "char",
+                                            "const", "continue", "default",
+                                            "do", "double", "else", "enum",
+                                            "extern", "float", "for", "goto",
+                                            "if", "inline", "int", "long",
+                                            "register", "restrict", "return",
+                                            "short", "signed", "sizeof",
+                                            "static", "struct", "switch",
+                                            "typedef", "union", "unsigned",
+                                            "void", "volatile", "while" };
+
+    if (   (token().type != TokenType::Identifier)
+        || Keywords.contains(token().text)) {
+        return false;
+    }
+
+    pIdentifier = token().text;
+
+    ++mTokenIndex;
+
+    return true;
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::parseFunction()
+{
+    // Parse a function, which must either return nothing or a double, and
+    // whose parameters must either be doubles or arrays of doubles
+
+    if (token().type != TokenType::Identifier) {
+        return false;
+    }
+
+    bool returnsDouble = token().text == "double";
+
+    if (!returnsDouble && (token().text != "void")) {
+        return false;
+    }
+
+    ++mTokenIndex;
+
+    QString functionName;
+    int dummyArgumentsCount;
+
+    if (   !identifier(functionName)
+        || mFunctionNames.contains(functionName)
+        || mathematicalFunction(functionName, dummyArgumentsCount)
+        || !accept("(")) {
+        return false;
+    }
+
+    mFunctionNames << functionName;
+
+    QStringList parameterNames;
+    std::vector<llvm::Type *> parameterTypes;
+    QList<bool> parameterPointers;
+
+    if (!accept(")")) {
+        do {
+            if ((token().type != TokenType::Identifier) || (token().text != "double")) {
+                return false;
+            }
+
+            ++mTokenIndex;
+
+            bool isPointer = accept("*");
+            QString parameterName;
+
+            if (   !identifier(parameterName)
+                || parameterNames.contains(parameterName)) {
+                return false;
+            }
+
+            parameterNames << parameterName;
+            parameterTypes.push_back(isPointer?
+                                         llvm::Type::getDoublePtrTy(mContext):
+                                         llvm::Type::getDoubleTy(mContext));
+            parameterPointers << isPointer;
+        } while (accept(","));
+
+        if (!accept(")")) {
+            return false;
+        }
+    }
+
+    if (!accept("{")) {
+        return false;
+    }
+
+    // Create our function and its parameters
+
+    auto functionType = llvm::FunctionType::get(returnsDouble?
+                                                    llvm::Type::getDoubleTy(mContext):
+                                                    llvm::Type::getVoidTy(mContext),
+                                                parameterTypes, false);
+    auto function = llvm::Function::Create(functionType,
+                                           llvm::Function::ExternalLinkage,
+                                           functionName.toStdString(),
+                                           mModule.get());
+
+    function->setDoesNotThrow();
+
+    mScalarParameters.clear();
+    mPointerParameters.clear();
+
+    for (int i = 0, iMax = parameterNames.count(); i < iMax; ++i) {
+        llvm::Argument *argument = function->getArg(unsigned(i));
+
+        argument->setName(parameterNames[i].toStdString());
+
+        if (parameterPointers[i]) {
+            mPointerParameters.insert(parameterNames[i], argument);
+        } else {
+            mScalarParameters.insert(parameterNames[i], argument);
+        }
+    }
+
+    mBuilder.SetInsertPoint(llvm::BasicBlock::Create(mContext, "entry", function));
+
+    // Parse the body of our function
+    // Note: a return statement must be the last statement of a function that
+    //       returns a double, and it cannot be used in a function that
+    //       returns nothing...
+
+    bool returned = false;
+
+    while (!accept("}")) {
+        if (returned || !parseStatement(returnsDouble, returned)) {
+            return false;
+        }
+    }
+
+    if (!returned) {
+        if (returnsDouble) {
+            return false;
+        }
+
+        mBuilder.CreateRetVoid();
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+bool CompilerIrGenerator::parseStatement(bool pReturnsDouble, bool &pReturned)
+{
+    // Parse a statement, i.e. an empty statement, an assignment to an array
+    // element or a return statement
+
+    if (accept(";")) {
+        return true;
+    }
+
+    if ((token().type == TokenType::Identifier) && (token().text == "return")) {
+        ++mTokenIndex;
+
+        if (!pReturnsDouble) {
+            return false;
+        }
+
+        Value value = parseExpression();
+
+        if ((value.value == nullptr) || !accept(";")) {
+            return false;
+        }
+
+        mBuilder.CreateRet(toDouble(value));
+
+        pReturned = true;
+
+        return true;
+    }
+
+    QString arrayName;
+
+    if (   !identifier(arrayName)
+        || !mPointerParameters.contains(arrayName)
+        || !accept("[")) {
+        return false;
+    }
+
+    Value index = parseExpression();
+
+    if (   (index.value == nullptr) || !index.isInteger
+        || !accept("]") || !accept("=")) {
+        return false;
+    }
+
+    // Note: we compute the address of our array element before evaluating our
+    //       value since, in C, the order in which this is done is unspecified
+    //       and neither may have side effects in the code we support...
+
+    auto address = mBuilder.CreateInBoundsGEP(llvm::Type::getDoubleTy(mContext),
+                                              mPointerParameters.value(arrayName),
+                                              mBuilder.CreateSExt(index.value, llvm::Type::getInt64Ty(mContext)));
+    Value value = parseExpression();
+
+    if ((value.value == nullptr) || !accept(";")) {
+        return false;
+    }
+
+    mBuilder.CreateStore(toDouble(value), address);
+
+    return true;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseExpression()
+{
+    // Parse a (possibly conditional) expression
+
+    Value condition = parseLogical(true);
+
+    if ((condition.value == nullptr) || !accept("?")) {
+        return condition;
+    }
+
+    // Evaluate our condition and create the blocks for our two possible values
+    // and what comes next
+
+    llvm::Function *function = mBuilder.GetInsertBlock()->getParent();
+    auto trueBlock = llvm::BasicBlock::Create(mContext, "true", function);
+    auto falseBlock = llvm::BasicBlock::Create(mContext, "false", function);
+    auto mergeBlock = llvm::BasicBlock::Create(mContext, "merge", function);
+
+    mBuilder.CreateCondBr(toBoolean(condition), trueBlock, falseBlock);
+
+    // Evaluate our two possible values
+    // Note: we can only branch to our merge block once we know the type of
+    //       both values since, if they are different, we need to convert the
+    //       integer one to a double...
+
+    mBuilder.SetInsertPoint(trueBlock);
+
+    Value trueValue = parseExpression();
+
+    if ((trueValue.value == nullptr) || !accept(":")) {
+        return { nullptr, false };
+    }
+
+    llvm::BasicBlock *trueEndBlock = mBuilder.GetInsertBlock();
+
+    mBuilder.SetInsertPoint(falseBlock);
+
+    Value falseValue = parseExpression();
+
+    if (falseValue.value == nullptr) {
+        return { nullptr, false };
+    }
+
+    llvm::BasicBlock *falseEndBlock = mBuilder.GetInsertBlock();
+    bool isInteger = trueValue.isInteger && falseValue.isInteger;
+
+    mBuilder.SetInsertPoint(trueEndBlock);
+
+    llvm::Value *trueResult = isInteger?trueValue.value:toDouble(trueValue);
+
+    mBuilder.CreateBr(mergeBlock);
+
+    mBuilder.SetInsertPoint(falseEndBlock);
+
+    llvm::Value *falseResult = isInteger?falseValue.value:toDouble(falseValue);
+
+    mBuilder.CreateBr(mergeBlock);
+
+    // Merge our two possible values
+
+    mBuilder.SetInsertPoint(mergeBlock);
+
+    llvm::PHINode *result = mBuilder.CreatePHI(trueResult->getType(), 2);
+
+    result->addIncoming(trueResult, trueEndBlock);
+    result->addIncoming(falseResult, falseEndBlock);
+
+    return { result, isInteger };
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseLogical(bool pOr)
+{
+    // Parse a logical OR or a logical AND expression
+    // Note: like in C, our right operand is only evaluated if needed...
+
+    const char *op = pOr?"||":"&&";
+    Value res = pOr?parseLogical(false):parseEquality();
+
+    while ((res.value != nullptr) && accept(op)) {
+        llvm::Value *lhs = toBoolean(res);
+        llvm::BasicBlock *lhsEndBlock = mBuilder.GetInsertBlock();
+        llvm::Function *function = lhsEndBlock->getParent();
+        auto rhsBlock = llvm::BasicBlock::Create(mContext, pOr?"or":"and", function);
+        auto mergeBlock = llvm::BasicBlock::Create(mContext, "merge", function);
+
+        if (pOr) {
+            mBuilder.CreateCondBr(lhs, mergeBlock, rhsBlock);
+        } else {
+            mBuilder.CreateCondBr(lhs, rhsBlock, mergeBlock);
+        }
+
+        mBuilder.SetInsertPoint(rhsBlock);
+
+        Value rhsValue = pOr?parseLogical(false):parseEquality();
+
+        if (rhsValue.value == nullptr) {
+            return { nullptr, false };
+        }
+
+        llvm::Value *rhs = toBoolean(rhsValue);
+        llvm::BasicBlock *rhsEndBlock = mBuilder.GetInsertBlock();
+
+        mBuilder.CreateBr(mergeBlock);
+
+        mBuilder.SetInsertPoint(mergeBlock);
+
+        llvm::PHINode *result = mBuilder.CreatePHI(llvm::Type::getInt1Ty(mContext), 2);
+
+        result->addIncoming(mBuilder.getInt1(pOr), lhsEndBlock);
+        result->addIncoming(rhs, rhsEndBlock);
+
+        res = fromBoolean(result);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseEquality()
+{
+    // Parse an equality expression
+    // Note: like in C, a comparison involving a NaN is always false, except
+    //       for "!="...
+
+    Value res = parseRelational();
+
+    while (res.value != nullptr) {
+        bool isEqual = isPunctuator("==");
+
+        if (!isEqual && !isPunctuator("!=")) {
+            break;
+        }
+
+        ++mTokenIndex;
+
+        Value rhs = parseRelational();
+
+        if (rhs.value == nullptr) {
+            return { nullptr, false };
+        }
+
+        if (res.isInteger && rhs.isInteger) {
+            res = fromBoolean(isEqual?
+                                  mBuilder.CreateICmpEQ(res.value, rhs.value):
+                                  mBuilder.CreateICmpNE(res.value, rhs.value));
+        } else {
+            res = fromBoolean(isEqual?
+                                  mBuilder.CreateFCmpOEQ(toDouble(res), toDouble(rhs)):
+                                  mBuilder.CreateFCmpUNE(toDouble(res), toDouble(rhs)));
+        }
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseRelational()
+{
+    // Parse a relational expression
+
+    Value res = parseAdditive();
+
+    while (res.value != nullptr) {
+        QString op;
+
+        if (   isPunctuator("<") || isPunctuator(">")
+            || isPunctuator("<=") || isPunctuator(">=")) {
+            op = token().text;
+        } else {
+            break;
+        }
+
+        ++mTokenIndex;
+
+        Value rhs = parseAdditive();
+
+        if (rhs.value == nullptr) {
+            return { nullptr, false };
+        }
+
+        llvm::Value *result;
+
+        if (res.isInteger && rhs.isInteger) {
+            if (op == "<") {
+                result = mBuilder.CreateICmpSLT(res.value, rhs.value);
+            } else if (op == ">") {
+                result = mBuilder.CreateICmpSGT(res.value, rhs.value);
+            } else if (op == "<=") {
+                result = mBuilder.CreateICmpSLE(res.value, rhs.value);
+            } else {
+                result = mBuilder.CreateICmpSGE(res.value, rhs.value);
+            }
+        } else {
+            llvm::Value *lhsValue = toDouble(res);
+            llvm::Value *rhsValue = toDouble(rhs);
+
+            if (op == "<") {
+                result = mBuilder.CreateFCmpOLT(lhsValue, rhsValue);
+            } else if (op == ">") {
+                result = mBuilder.CreateFCmpOGT(lhsValue, rhsValue);
+            } else if (op == "<=") {
+                result = mBuilder.CreateFCmpOLE(lhsValue, rhsValue);
+            } else {
+                result = mBuilder.CreateFCmpOGE(lhsValue, rhsValue);
+            }
+        }
+
+        res = fromBoolean(result);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseAdditive()
+{
+    // Parse an additive expression
+
+    Value res = parseMultiplicative();
+
+    while (res.value != nullptr) {
+        bool isAddition = isPunctuator("+");
+
+        if (!isAddition && !isPunctuator("-")) {
+            break;
+        }
+
+        ++mTokenIndex;
+
+        Value rhs = parseMultiplicative();
+
+        if (rhs.value == nullptr) {
+            return { nullptr, false };
+        }
+
+        if (res.isInteger && rhs.isInteger) {
+            res.value = isAddition?
+                            mBuilder.CreateNSWAdd(res.value, rhs.value):
+                            mBuilder.CreateNSWSub(res.value, rhs.value);
+        } else {
+            res = { isAddition?
+                        mBuilder.CreateFAdd(toDouble(res), toDouble(rhs)):
+                        mBuilder.CreateFSub(toDouble(res), toDouble(rhs)),
+                    false };
+        }
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseMultiplicative()
+{
+    // Parse a multiplicative expression
+
+    Value res = parseUnary();
+
+    while (res.value != nullptr) {
+        bool isMultiplication = isPunctuator("*");
+
+        if (!isMultiplication && !isPunctuator("/")) {
+            break;
+        }
+
+        ++mTokenIndex;
+
+        Value rhs = parseUnary();
+
+        if (rhs.value == nullptr) {
+            return { nullptr, false };
+        }
+
+        if (res.isInteger && rhs.isInteger) {
+            // Note: an integer division by zero is something that Clang would
+            //       complain about, so let it do just that...
+
+            if (   !isMultiplication
+                && llvm::isa<llvm::Constant>(rhs.value)
+                && llvm::cast<llvm::Constant>(rhs.value)->isNullValue()) {
+                return { nullptr, false };
+            }
+
+            res.value = isMultiplication?
+                            mBuilder.CreateNSWMul(res.value, rhs.value):
+                            mBuilder.CreateSDiv(res.value, rhs.value);
+        } else {
+            res = { isMultiplication?
+                        mBuilder.CreateFMul(toDouble(res), toDouble(rhs)):
+                        mBuilder.CreateFDiv(toDouble(res), toDouble(rhs)),
+                    false };
+        }
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parseUnary()
+{
+    // Parse a unary expression
+
+    if (accept("+")) {
+        return parseUnary();
+    }
+
+    if (accept("-")) {
+        Value value = parseUnary();
+
+        if (value.value == nullptr) {
+            return value;
+        }
+
+        return { value.isInteger?
+                     mBuilder.CreateNSWNeg(value.value):
+                     mBuilder.CreateFNeg(value.value),
+                 value.isInteger };
+    }
+
+    if (accept("!")) {
+        Value value = parseUnary();
+
+        if (value.value == nullptr) {
+            return value;
+        }
+
+        return fromBoolean(mBuilder.CreateNot(toBoolean(value)));
+    }
+
+    return parsePrimary();
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::parsePrimary()
+{
+    // Parse a primary expression, i.e. a number, a parameter, an array element,
+    // a call to a mathematical function or a parenthesised expression
+
+    static const Value Invalid = { nullptr, false };
+
+    if (accept("(")) {
+        Value res = parseExpression();
+
+        if ((res.value == nullptr) || !accept(")")) {
+            return Invalid;
+        }
+
+        return res;
+    }
+
+    if (token().type == TokenType::Integer) {
+        bool ok;
+        int number = token().text.toInt(&ok);
+
+        if (!ok) {
+            return Invalid;
+        }
+
+        ++mTokenIndex;
+
+        return { mBuilder.getInt32(uint32_t(number)), true };
+    }
+
+    if (token().type == TokenType::Double) {
+        bool ok;
+        double number = token().text.toDouble(&ok);
+
+        if (!ok) {
+            return Invalid;
+        }
+
+        ++mTokenIndex;
+
+        return { llvm::ConstantFP::get(llvm::Type::getDoubleTy(mContext), number), false };
+    }
+
+    QString name;
+
+    if (!identifier(name)) {
+        return Invalid;
+    }
+
+    if (mScalarParameters.contains(name)) {
+        return { mScalarParameters.value(name), false };
+    }
+
+    if (mPointerParameters.contains(name)) {
+        Value index;
+
+        if (   !accept("[")
+            || ((index = parseExpression()).value == nullptr) || !index.isInteger
+            || !accept("]")) {
+            return Invalid;
+        }
+
+        auto address = mBuilder.CreateInBoundsGEP(llvm::Type::getDoubleTy(mContext),
+                                                  mPointerParameters.value(name),
+                                                  mBuilder.CreateSExt(index.value, llvm::Type::getInt64Ty(mContext)));
+
+        return { mBuilder.CreateLoad(llvm::Type::getDoubleTy(mContext), address), false };
+    }
+
+    int argumentsCount;
+    llvm::FunctionCallee callee = mathematicalFunction(name, argumentsCount);
+
+    if (!callee || !accept("(")) {
+        return Invalid;
+    }
+
+    std::vector<llvm::Value *> arguments;
+
+    for (int i = 0; i < argumentsCount; ++i) {
+        if ((i != 0) && !accept(",")) {
+            return Invalid;
+        }
+
+        Value argument = parseExpression();
+
+        if (argument.value == nullptr) {
+            return Invalid;
+        }
+
+        arguments.push_back(toDouble(argument));
+    }
+
+    if (!accept(")")) {
+        return Invalid;
+    }
+
+    return { mBuilder.CreateCall(callee, arguments), false };
+}
+
+//==============================================================================
+
+llvm::Value * CompilerIrGenerator::toDouble(const Value &pValue)
+{
+    // Convert the given value to a double, if needed
+
+    return pValue.isInteger?
+               mBuilder.CreateSIToFP(pValue.value, llvm::Type::getDoubleTy(mContext)):
+               pValue.value;
+}
+
+//==============================================================================
+
+llvm::Value * CompilerIrGenerator::toBoolean(const Value &pValue)
+{
+    // Convert the given value to a boolean, i.e. check whether it is non-zero
+    // Note: like in C, a NaN is considered to be true...
+
+    return pValue.isInteger?
+               mBuilder.CreateICmpNE(pValue.value, mBuilder.getInt32(0)):
+               mBuilder.CreateFCmpUNE(pValue.value, llvm::ConstantFP::get(llvm::Type::getDoubleTy(mContext), 0.0));
+}
+
+//==============================================================================
+
+CompilerIrGenerator::Value CompilerIrGenerator::fromBoolean(llvm::Value *pValue)
+{
+    // Convert the given boolean to an integer, like in C
+
+    return { mBuilder.CreateZExt(pValue, llvm::Type::getInt32Ty(mContext)), true };
+}
+
+//==============================================================================
+
+llvm::FunctionCallee CompilerIrGenerator::mathematicalFunction(const QString &pName,
+                                                               int &pArgumentsCount)
+{
+    // Return (and declare, if needed) the given mathematical function, if it is
+    // one of those that our model code may use (see completeCode() in
+    // compilerengine.cpp)
+    // Note: like with Clang and -fno-math-errno, the functions from the
+    //       standard C library are considered not to access memory...
+
+    static const QSet<QString> StandardFunctions = { "fabs", "log", "exp",
+                                                     "floor", "ceil",
+                                                     "sin", "sinh", "asin", "asinh",
+                                                     "cos", "cosh", "acos", "acosh",
+                                                     "tan", "tanh", "atan", "atanh",
+                                                     "pow" };
+    static const QSet<QString> OtherFunctions = { "factorial",
+                                                  "sec", "sech", "asec", "asech",
+                                                  "csc", "csch", "acsc", "acsch",
+                                                  "cot", "coth", "acot", "acoth",
+                                                  "arbitrary_log" };
+
+    bool isStandardFunction = StandardFunctions.contains(pName);
+
+    if (!isStandardFunction && !OtherFunctions.contains(pName)) {
+        return {};
+    }
+
+    pArgumentsCount = ((pName == "pow") || (pName == "arbitrary_log"))?2:1;
+
+    auto functionType = llvm::FunctionType::get(llvm::Type::getDoubleTy(mContext),
+                                                std::vector<llvm::Type *>(size_t(pArgumentsCount), llvm::Type::getDoubleTy(mContext)),
+                                                false);
+    llvm::FunctionCallee res = mModule->getOrInsertFunction(pName.toStdString(), functionType);
+    auto function = llvm::dyn_cast<llvm::Function>(res.getCallee());
+
+    if (function == nullptr) {
+        return {};
+    }
+
+    function->setDoesNotThrow();
+
+    if (isStandardFunction) {
+        function->setDoesNotAccessMemory();
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void CompilerIrGenerator::optimise()
+{
+    // Optimise our module using the same optimisation level as Clang would (see
+    // clangArguments() in compilerengine.cpp) and targeting our host
+
+#ifdef QT_DEBUG
+    Q_UNUSED(mOptimisationLevel)
+#else
+    auto jitTargetMachineBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+
+    if (!jitTargetMachineBuilder) {
+        llvm::consumeError(jitTargetMachineBuilder.takeError());
+
+        return;
+    }
+
+    auto targetMachine = jitTargetMachineBuilder->createTargetMachine();
+
+    if (!targetMachine) {
+        llvm::consumeError(targetMachine.takeError());
+
+        return;
+    }
+
+    mModule->setTargetTriple((*targetMachine)->getTargetTriple().str());
+    mModule->setDataLayout((*targetMachine)->createDataLayout());
+
+    llvm::LoopAnalysisManager loopAnalysisManager;
+    llvm::FunctionAnalysisManager functionAnalysisManager;
+    llvm::CGSCCAnalysisManager cgsccAnalysisManager;
+    llvm::ModuleAnalysisManager moduleAnalysisManager;
+    llvm::PassBuilder passBuilder(targetMachine->get());
+
+    passBuilder.registerModuleAnalyses(moduleAnalysisManager);
+    passBuilder.registerCGSCCAnalyses(cgsccAnalysisManager);
+    passBuilder.registerFunctionAnalyses(functionAnalysisManager);
+    passBuilder.registerLoopAnalyses(loopAnalysisManager);
+    passBuilder.crossRegisterProxies(loopAnalysisManager, functionAnalysisManager,
+                                     cgsccAnalysisManager, moduleAnalysisManager);
+
+    passBuilder.buildPerModuleDefaultPipeline((mOptimisationLevel == CompilerEngine::OptimisationLevel::Fast)?
+                                                  llvm::OptimizationLevel::O1:
+                                                  llvm::OptimizationLevel::O3).run(*mModule, moduleAnalysisManager);
+#endif
+}
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,138 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler IR generator
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "compilerengine.h"
+
+//==============================================================================
+
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+
+//==============================================================================
+
+#include "llvmclangbegin.h"
+    #include "llvm/IR/IRBuilder.h"
+#include "llvmclangend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+// Version of our IR generator
+// Note: it must be incremented whenever our IR generator changes in a way that
+//       may affect the code that it generates or the code that it supports,
+//       so that objects that were cached using a previous version don't get
+//       used anymore (see objectCacheKey() in compilerengine.cpp)...
+
+static const int IrGeneratorVersion = 1;
+
+//==============================================================================
+
+class CompilerIrGenerator
+{
+public:
+    explicit CompilerIrGenerator(llvm::LLVMContext &pContext,
+                                 CompilerEngine::OptimisationLevel pOptimisationLevel);
+
+    std::unique_ptr<llvm::Module> module(const QString &pCode);
+
+private:
+    enum class TokenType {
+        End,
+        Identifier,
+        Integer,
+        Double,
+        Punctuator
+    };
+
+    struct Token
+    {
+        TokenType type;
+        QString text;
+    };
+
+    struct Value
+    {
+        llvm::Value *value;
+        bool isInteger;
+    };
+
+    llvm::LLVMContext &mContext;
+    CompilerEngine::OptimisationLevel mOptimisationLevel;
+
+    QList<Token> mTokens;
+    int mTokenIndex = 0;
+
+    std::unique_ptr<llvm::Module> mModule;
+    llvm::IRBuilder<> mBuilder;
+
+    QMap<QString, llvm::Value *> mScalarParameters;
+    QMap<QString, llvm::Value *> mPointerParameters;
+    QSet<QString> mFunctionNames;
+
+    bool tokenize(const QString &pCode);
+
+    const Token & token() const;
+    bool isPunctuator(const char *pPunctuator) const;
+    bool accept(const char *pPunctuator);
+    bool identifier(QString &pIdentifier);
+
+    bool parseFunction();
+    bool parseStatement(bool pReturnsDouble, bool &pReturned);
+
+    Value parseExpression();
+    Value parseLogical(bool pOr);
+    Value parseEquality();
+    Value parseRelational();
+    Value parseAdditive();
+    Value parseMultiplicative();
+    Value parseUnary();
+    Value parsePrimary();
+
+    llvm::Value * toDouble(const Value &pValue);
+    llvm::Value * toBoolean(const Value &pValue);
+    Value fromBoolean(llvm::Value *pValue);
+
+    llvm::FunctionCallee mathematicalFunction(const QString &pName,
+                                              int &pArgumentsCount);
+
+    void optimise();
+};
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,213 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler object cache
+//==============================================================================
+
+#include "compilerobjectcache.h"
+
+//==============================================================================
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+//==============================================================================
+
+#include "llvmclangbegin.h"
+    #include "llvm/Support/MemoryBuffer.h"
+#include "llvmclangend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+CompilerObjectCache::CompilerObjectCache(const QByteArray &pKey)
+{
+    // Determine the name of the file in which our object is, or will be,
+    // cached, i.e. the SHA-1 of the given key, which is expected to contain
+    // everything that affects the compiled object (code, compilation
+    // arguments, host triple, etc.)
+    // Note: we don't cache anything if there is no cache directory...
+
+    QString dirName = directoryName();
+
+    if (!dirName.isEmpty()) {
+        mFileName = dirName+"/"+QCryptographicHash::hash(pKey, QCryptographicHash::Sha1).toHex()+".o";
+    }
+}
+
+//==============================================================================
+
+QString CompilerObjectCache::directoryName()
+{
+    // Return the name of the directory where we cache compiled objects
+
+    QString res = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+
+    return res.isEmpty()?
+               res:
+               res+"/Compiler";
+}
+
+//==============================================================================
+
+void CompilerObjectCache::prune(qint64 pMaximumSize)
+{
+    // Remove our least recently used cached objects until the size of our
+    // object cache doesn't exceed the given maximum size
+    // Note #1: the modification time of a cached object is updated whenever it
+    //          gets used (see object()), so our least recently used cached
+    //          objects are those with the oldest modification time...
+    // Note #2: another instance of OpenCOR may be pruning our object cache at
+    //          the same time, hence we don't mind if a cached object cannot be
+    //          removed...
+
+    QString dirName = directoryName();
+
+    if (dirName.isEmpty()) {
+        return;
+    }
+
+    const QFileInfoList fileInfos = QDir(dirName).entryInfoList({ "*.o" }, QDir::Files,
+                                                                QDir::Time|QDir::Reversed);
+    qint64 size = 0;
+
+    for (const auto &fileInfo : fileInfos) {
+        size += fileInfo.size();
+    }
+
+    for (const auto &fileInfo : fileInfos) {
+        if (size <= pMaximumSize) {
+            break;
+        }
+
+        QFile::remove(fileInfo.absoluteFilePath());
+
+        size -= fileInfo.size();
+    }
+}
+
+//==============================================================================
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerObjectCache::object() const
+{
+    // Return our cached object, if any
+
+    if (mFileName.isEmpty()) {
+        return nullptr;
+    }
+
+    QFile file(mFileName);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    QByteArray object = file.readAll();
+
+    if (object.isEmpty()) {
+        return nullptr;
+    }
+
+    // Let people know that our cached object has just been used (see prune())
+    // Note: we need write access to our cached object to update its
+    //       modification time (on Windows, at least), hence we reopen it in
+    //       append mode, which leaves its contents untouched...
+
+    file.close();
+
+    if (file.open(QIODevice::Append)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+
+    return llvm::MemoryBuffer::getMemBufferCopy(llvm::StringRef(object.constData(), size_t(object.size())),
+                                                mFileName.toStdString());
+}
+
+//==============================================================================
+
+void CompilerObjectCache::removeObject() const
+{
+    // Remove our cached object, if any
+    // Note: this is typically done when our cached object cannot be loaded,
+    //       i.e. it is most likely corrupted...
+
+    if (!mFileName.isEmpty()) {
+        QFile::remove(mFileName);
+    }
+}
+
+//==============================================================================
+
+void CompilerObjectCache::notifyObjectCompiled(const llvm::Module *pModule,
+                                               llvm::MemoryBufferRef pObject)
+{
+    Q_UNUSED(pModule)
+
+    // Cache the given object
+    // Note: we use a QSaveFile object so that our cached object is written
+    //       atomically, i.e. another instance of OpenCOR will either see a
+    //       complete object or none at all. Also, there is nothing that we can
+    //       do if we cannot cache our object, hence we don't check for
+    //       errors...
+
+    if (mFileName.isEmpty() || !QDir().mkpath(directoryName())) {
+        return;
+    }
+
+    QSaveFile file(mFileName);
+
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(pObject.getBufferStart(), qint64(pObject.getBufferSize()));
+
+        if (file.commit()) {
+            // Make sure that our object cache doesn't grow forever
+
+            prune();
+        }
+    }
+}
+
+//==============================================================================
+
+std::unique_ptr<llvm::MemoryBuffer> CompilerObjectCache::getObject(const llvm::Module *pModule)
+{
+    Q_UNUSED(pModule)
+
+    // Return our cached object, if any
+
+    return object();
+}
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
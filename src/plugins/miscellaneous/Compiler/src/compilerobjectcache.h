@@ -0,0 +1,75 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Compiler object cache
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include <QByteArray>
+#include <QString>
+
+//==============================================================================
+
+#include "llvmclangbegin.h"
+    #include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvmclangend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace Compiler {
+
+//==============================================================================
+
+static const qint64 MaximumCacheSize = 256*1024*1024;
+
+//==============================================================================
+
+class CompilerObjectCache : public llvm::ObjectCache
+{
+public:
+    explicit CompilerObjectCache(const QByteArray &pKey);
+
+    static QString directoryName();
+
+    static void prune(qint64 pMaximumSize = MaximumCacheSize);
+
+    std::unique_ptr<llvm::MemoryBuffer> object() const;
+    void removeObject() const;
+
+    void notifyObjectCompiled(const llvm::Module *pModule,
+                              llvm::MemoryBufferRef pObject) override;
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *pModule) override;
+
+private:
+    QString mFileName;
+};
+
+//==============================================================================
+
+} // namespace Compiler
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
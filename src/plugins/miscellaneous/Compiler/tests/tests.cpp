@@ -23,6 +23,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "compilerengine.h"
 #include "compilermath.h"
+#include "compilerobjectcache.h"
 #include "tests.h"
 
 //==============================================================================
@@ -164,6 +165,152 @@ void Tests::voidFunctionTests()
 
 //==============================================================================
 
+void Tests::objectCacheTests()
+{
+    // Compile some code that cannot already be in our object cache
+
+    qint64 value = QDateTime::currentMSecsSinceEpoch();
+    QString code = QString("double function()\n"
+                           "{\n"
+                           "    return %1.0;\n"
+                           "}").arg(value);
+
+    QVERIFY(mCompilerEngine->compileCode(code));
+    QVERIFY(!mCompilerEngine->fromObjectCache());
+    QVERIFY(mCompilerEngine->function("function") != nullptr);
+
+    // Compile the same code using another compiler engine, which should result
+    // in our object being loaded from our object cache
+
+    OpenCOR::Compiler::CompilerEngine compilerEngine;
+
+    QVERIFY(compilerEngine.compileCode(code));
+    QVERIFY(compilerEngine.fromObjectCache());
+
+    QCOMPARE(reinterpret_cast<double (*)()>(compilerEngine.function("function"))(),
+             double(value));
+}
+
+//==============================================================================
+
+void Tests::objectCachePruningTests()
+{
+    // Compile two pieces of code that cannot already be in our object cache
+
+    qint64 value = QDateTime::currentMSecsSinceEpoch();
+    QString code = QString("double function()\n"
+                           "{\n"
+                           "    return %1.0;\n"
+                           "}");
+    QString code1 = code.arg(value);
+    QString code2 = code.arg(value+1);
+
+    QVERIFY(mCompilerEngine->compileCode(code1));
+    QVERIFY(mCompilerEngine->compileCode(code2));
+
+    // Use the object of our first piece of code, making sure that it has a
+    // more recent modification time than the object of our second piece of
+    // code (even on file systems with a coarse time resolution)
+
+    QTest::qSleep(1100);
+
+    QVERIFY(OpenCOR::Compiler::CompilerEngine::hasCachedObject(code1));
+
+    // Prune our object cache so that it can only hold our most recently used
+    // object, i.e. the object of our first piece of code
+
+    const QFileInfoList fileInfos = QDir(OpenCOR::Compiler::CompilerObjectCache::directoryName()).entryInfoList({ "*.o" }, QDir::Files,
+                                                                                                               QDir::Time);
+
+    QVERIFY(!fileInfos.isEmpty());
+
+    OpenCOR::Compiler::CompilerObjectCache::prune(fileInfos.first().size());
+
+    QVERIFY(OpenCOR::Compiler::CompilerEngine::hasCachedObject(code1));
+    QVERIFY(!OpenCOR::Compiler::CompilerEngine::hasCachedObject(code2));
+
+    // Compiling our second piece of code should therefore not use our object
+    // cache anymore
+
+    QVERIFY(mCompilerEngine->compileCode(code2));
+    QVERIFY(!mCompilerEngine->fromObjectCache());
+}
+
+//==============================================================================
+
+void Tests::optimisationLevelTests()
+{
+    // Compile the same code using both a fast and a full optimisation level,
+    // and check that we get the same result
+
+    QString code = "double function(double pNb)\n"
+                   "{\n"
+                   "    return 3.0*pNb+5.0;\n"
+                   "}";
+
+    QVERIFY(mCompilerEngine->compileCode(code, OpenCOR::Compiler::CompilerEngine::OptimisationLevel::Fast));
+    QCOMPARE(reinterpret_cast<double (*)(double)>(mCompilerEngine->function("function"))(mA),
+             3.0*mA+5.0);
+
+    QVERIFY(mCompilerEngine->compileCode(code, OpenCOR::Compiler::CompilerEngine::OptimisationLevel::Full));
+    QCOMPARE(reinterpret_cast<double (*)(double)>(mCompilerEngine->function("function"))(mA),
+             3.0*mA+5.0);
+
+    // Both objects should now be in our object cache
+
+    QVERIFY(OpenCOR::Compiler::CompilerEngine::hasCachedObject(code, OpenCOR::Compiler::CompilerEngine::OptimisationLevel::Fast));
+    QVERIFY(OpenCOR::Compiler::CompilerEngine::hasCachedObject(code, OpenCOR::Compiler::CompilerEngine::OptimisationLevel::Full));
+}
+
+//==============================================================================
+
+void Tests::irGeneratorTests()
+{
+    // Compile some code that our IR generator supports, i.e. that doesn't need
+    // to be compiled using Clang
+
+    QString code = "void function(double *pArrayA, double pNb)\n"
+                   "{\n"
+                   "    pArrayA[0] = (pNb > 0.0)?pow(pNb, 2)/2:-exp(pNb);\n"
+                   "    pArrayA[1] = !pArrayA[0] || ((pNb == 3) && sec(pNb));\n"
+                   "}";
+
+    QVERIFY(mCompilerEngine->compileCode(code));
+    QVERIFY(mCompilerEngine->fromObjectCache() || !mCompilerEngine->fromClang());
+
+    std::array<double, 2> arrayA = {};
+
+    reinterpret_cast<void (*)(double *, double)>(mCompilerEngine->function("function"))(arrayA.data(), 3.0);
+
+    QCOMPARE(arrayA[0], 4.5);
+    QCOMPARE(arrayA[1], 1.0);
+
+    reinterpret_cast<void (*)(double *, double)>(mCompilerEngine->function("function"))(arrayA.data(), -mA);
+
+    QCOMPARE(arrayA[0], -exp(-mA));
+    QCOMPARE(arrayA[1], 0.0);
+
+    // Compile some code that our IR generator doesn't support, i.e. that needs
+    // to be compiled using Clang
+
+    code = "double function(double pNb)\n"
+           "{\n"
+           "    return (double) (int) pNb;\n"
+           "}";
+
+    QVERIFY(mCompilerEngine->compileCode(code));
+    QVERIFY(mCompilerEngine->fromObjectCache() || mCompilerEngine->fromClang());
+    QCOMPARE(reinterpret_cast<double (*)(double)>(mCompilerEngine->function("function"))(mA),
+             double(int(mA)));
+
+    // Check that invalid code, which our IR generator doesn't support, still
+    // gets reported as such by Clang
+
+    QVERIFY(!mCompilerEngine->compileCode("double function(double pNb) { return pNb % 3; }"));
+}
+
+//==============================================================================
+
 void Tests::timesOperatorTests()
 {
     QVERIFY(mCompilerEngine->compileCode("double function(double pNb1, double pNb2)\n"
@@ -62,6 +62,11 @@ private slots:
 
     void voidFunctionTests();
 
+    void objectCacheTests();
+    void objectCachePruningTests();
+    void optimisationLevelTests();
+    void irGeneratorTests();
+
     void timesOperatorTests();
     void divideOperatorTests();
     void moduloOperatorTests();
@@ -129,6 +129,9 @@ SimulationExperimentViewSimulationWidget::SimulationExperimentViewSimulationWidg
     connect(mSimulation, &SimulationSupport::Simulation::error,
             this, QOverload<const QString &>::of(&SimulationExperimentViewSimulationWidget::simulationError));
 
+    connect(mSimulation, &SimulationSupport::Simulation::resultsAvailable,
+            this, &SimulationExperimentViewSimulationWidget::simulationResultsAvailable);
+
     connect(mSimulation->data(), &SimulationSupport::SimulationData::dataModified,
             this, &SimulationExperimentViewSimulationWidget::simulationDataModified);
 
@@ -1651,12 +1654,20 @@ void SimulationExperimentViewSimulationWidget::addSedmlSimulationAlgorithm(libse
 {
     // Customise the given algorithm using the given solver interface and
     // properties
+    // Note: a solver property that doesn't have a KiSAO id (e.g. CVODE's root
+    //       finding) cannot be exported as an algorithm parameter, so we skip
+    //       it...
 
     if (pSolverInterface != nullptr) {
         const QStringList solverPropertyKeys = pSolverProperties.keys();
 
         for (const auto &solverProperty : solverPropertyKeys) {
             QString kisaoId = pSolverInterface->kisaoId(solverProperty);
+
+            if (kisaoId.isEmpty()) {
+                continue;
+            }
+
             QVariant solverPropertyValue = pSolverProperties.value(solverProperty);
             QString value = (solverPropertyValue.type() == QVariant::Double)?
                                 QString::number(solverPropertyValue.toDouble(), 'g', 15):
@@ -3159,6 +3170,15 @@ void SimulationExperimentViewSimulationWidget::simulationDone(qint64 pElapsedTim
 
     mContentsWidget->informationWidget()->parametersWidget()->updateParameters(mSimulation->currentPoint());
 
+    // Make sure that our final simulation results are accounted for
+    // Note: our simulation's last resultsAvailable() signal may have been
+    //       handled while our simulation's thread was still running, in which
+    //       case checkSimulationResults() wouldn't have realised that our
+    //       simulation is over, i.e. it wouldn't have stopped tracking our
+    //       simulation results nor reset our simulation progress...
+
+    mViewWidget->checkSimulationResults(mSimulation->fileName());
+
     // Stop tracking our simulation progress and reset our file tab icon
 
     mProgress = -1;
@@ -3275,6 +3295,19 @@ void SimulationExperimentViewSimulationWidget::simulationResultsRunAdded()
 
 //==============================================================================
 
+void SimulationExperimentViewSimulationWidget::simulationResultsAvailable()
+{
+    // New simulation results are available, so check our simulation results
+    // Note: our simulation lets us know about new results at a given refresh
+    //       rate, so several of them may be pending by the time we get here, in
+    //       which case only the first one will result in an update (see
+    //       SimulationExperimentViewWidget::checkSimulationResults())...
+
+    mViewWidget->checkSimulationResults(mSimulation->fileName());
+}
+
+//==============================================================================
+
 void SimulationExperimentViewSimulationWidget::simulationPropertyChanged(Core::Property *pProperty)
 {
     // Update our simulation properties, as well as our plots
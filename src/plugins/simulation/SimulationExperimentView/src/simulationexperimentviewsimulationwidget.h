@@ -428,6 +428,7 @@ private slots:
 
     void simulationResultsReset();
     void simulationResultsRunAdded();
+    void simulationResultsAvailable();
 
     void simulationPropertyChanged(Core::Property *pProperty);
     void solversPropertyChanged(Core::Property *pProperty);
@@ -568,20 +568,40 @@ void SimulationExperimentViewWidget::checkSimulationResults(const QString &pFile
         }
     }
 
-    // Ask to recheck our simulation widget's results, but only if its
-    // simulation is still running
-
-    if (   simulation->isRunning()
-        || (crtSimulationResultsSize != simulation->results()->size())) {
-        QTimer::singleShot(0, this, std::bind(&SimulationExperimentViewWidget::checkSimulationResults,
-                                              this, pFileName,
-                                              SimulationExperimentViewSimulationWidget::Task::None));
-    } else if (!simulation->isRunning() && !simulation->isPaused()) {
+    // Stop tracking our simulation widget's results, if its simulation is over
+    // Note: while our simulation is running, we get to check its results
+    //       whenever it lets us know that new results are available (see
+    //       SimulationExperimentViewSimulationWidget::simulationResultsAvailable()),
+    //       as well as once it is done (see
+    //       SimulationExperimentViewSimulationWidget::simulationDone())...
+
+    if (   !simulation->isRunning() && !simulation->isPaused()
+        && (crtSimulationResultsSize == simulation->results()->size())) {
         // The simulation is over, so stop tracking the result's size and reset
         // the simulation progress of the given file
 
         mSimulationResultsSizes.remove(pFileName);
 
+        // Release the memory that was used by the simulation results while
+        // they were growing and shrink them to their actual size
+        // Note #1: all our graphs have been updated above, so none of them
+        //          refers to that memory anymore...
+        // Note #2: if some of the simulation results got shrunk, then our
+        //          graphs still refer to their unshrunk version, so we update
+        //          all our graphs again before compacting the simulation
+        //          results again, thus releasing their unshrunk version...
+
+        if (simulation->results()->dataStore()->compact()) {
+            for (auto currentSimulationWidget : qAsConst(mSimulationWidgets)) {
+                currentSimulationWidget->updateSimulationResults(simulationWidget,
+                                                                 crtSimulationResultsSize,
+                                                                 simulationRunsCount-1,
+                                                                 SimulationExperimentViewSimulationWidget::Task::None);
+            }
+
+            simulation->results()->dataStore()->compact();
+        }
+
         simulationWidget->resetSimulationProgress();
     }
 }
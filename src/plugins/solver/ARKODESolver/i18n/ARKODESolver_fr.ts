@@ -0,0 +1,51 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="fr_FR" sourcelanguage="en_GB">
+<context>
+    <name>OpenCOR::ARKODESolver::ArkodeSolver</name>
+    <message>
+        <source>the &quot;Maximum step&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Pas maximum&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Maximum number of steps&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Nombre maximum de pas&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Integration method&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Méthode d&apos;intégration&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Upper half-bandwidth&quot; property must have a value between 0 and %1</source>
+        <translation>la propriété &quot;Demi largeur de bande supérieure&quot; doit avoir une valeur comprise entre 0 et %1</translation>
+    </message>
+    <message>
+        <source>the &quot;Upper half-bandwidth&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Demi largeur de bande supérieure&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Lower half-bandwidth&quot; property must have a value between 0 and %1</source>
+        <translation>la propriété &quot;Demi largeur de bande inférieure&quot; doit avoir une valeur comprise entre 0 et %1</translation>
+    </message>
+    <message>
+        <source>the &quot;Lower half-bandwidth&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Demi largeur de bande inférieure&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Linear solver&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Solveur linéaire&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Relative tolerance&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Tolérance relative&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Absolute tolerance&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Tolérance absolue&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+    <message>
+        <source>the &quot;Interpolate solution&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Interpoler solution&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+</context>
+</TS>
@@ -0,0 +1,727 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// ARKODE solver
+//==============================================================================
+
+#include "arkodesolver.h"
+
+//==============================================================================
+
+#include <cstring>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "arkode/arkode_arkstep.h"
+    #include "nvector/nvector_serial.h"
+    #include "sunlinsol/sunlinsol_band.h"
+    #include "sunlinsol/sunlinsol_dense.h"
+    #include "sunmatrix/sunmatrix_band.h"
+    #include "sunmatrix/sunmatrix_dense.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace ARKODESolver {
+
+//==============================================================================
+
+int rhsFunction(double pVoi, N_Vector pStates, N_Vector pRates, void *pUserData)
+{
+    // Compute the RHS function
+
+    auto userData = static_cast<ArkodeSolverUserData *>(pUserData);
+
+    userData->computeRates()(pVoi, userData->constants(),
+                             N_VGetArrayPointer_Serial(pRates),
+                             N_VGetArrayPointer_Serial(pStates),
+                             userData->algebraic());
+
+    return 0;
+}
+
+//==============================================================================
+
+int imexExplicitRhsFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                            void *pUserData)
+{
+    // Compute the explicit part of the RHS function, i.e. our rates minus
+    // their implicit part
+
+    auto userData = static_cast<ArkodeSolverUserData *>(pUserData);
+    double *states = N_VGetArrayPointer_Serial(pStates);
+    double *rates = N_VGetArrayPointer_Serial(pRates);
+
+    userData->computeQuasiLinearCoefficients(pVoi, states);
+
+    const QVector<int> &quasiLinearStates = userData->quasiLinearStates();
+    const double *quasiLinearCoefficients = userData->quasiLinearCoefficients();
+
+    memcpy(rates, userData->quasiLinearRates(),
+           size_t(N_VGetLength_Serial(pRates))*sizeof(double));
+
+    for (int i = 0, iMax = quasiLinearStates.count(); i < iMax; ++i) {
+        int state = quasiLinearStates[i];
+
+        rates[state] -= quasiLinearCoefficients[i]*states[state];
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+int imexImplicitRhsFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                            void *pUserData)
+{
+    // Compute the implicit part of the RHS function, i.e. b*x for each state
+    // which rate is of the form dx/dt = a+b*x, and zero for the other states
+
+    auto userData = static_cast<ArkodeSolverUserData *>(pUserData);
+    double *states = N_VGetArrayPointer_Serial(pStates);
+    double *rates = N_VGetArrayPointer_Serial(pRates);
+
+    userData->computeQuasiLinearCoefficients(pVoi, states);
+
+    const QVector<int> &quasiLinearStates = userData->quasiLinearStates();
+    const double *quasiLinearCoefficients = userData->quasiLinearCoefficients();
+
+    N_VConst(0.0, pRates);
+
+    for (int i = 0, iMax = quasiLinearStates.count(); i < iMax; ++i) {
+        int state = quasiLinearStates[i];
+
+        rates[state] = quasiLinearCoefficients[i]*states[state];
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+int jacobianFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                     SUNMatrix pJacobian, void *pUserData, N_Vector pTemp1,
+                     N_Vector pTemp2, N_Vector pTemp3)
+{
+    Q_UNUSED(pRates)
+    Q_UNUSED(pTemp1)
+    Q_UNUSED(pTemp2)
+    Q_UNUSED(pTemp3)
+
+    // Compute the (non-zero) entries of our Jacobian
+
+    auto userData = static_cast<ArkodeSolverUserData *>(pUserData);
+    double *jacobian = userData->jacobian();
+
+    userData->computeJacobian()(pVoi, userData->constants(), userData->rates(),
+                                N_VGetArrayPointer_Serial(pStates),
+                                userData->algebraic(), jacobian);
+
+    // Copy those entries to our dense/banded matrix
+    // Note: in the case of a banded matrix, the entries that are outside of our
+    //       band are ignored, just like they would be if our Jacobian was
+    //       approximated using finite differences...
+
+    const QVector<int> &rows = userData->jacobianRows();
+    const QVector<int> &columns = userData->jacobianColumns();
+
+    SUNMatZero(pJacobian);
+
+    if (SUNMatGetID(pJacobian) == SUNMATRIX_DENSE) {
+        for (int i = 0, iMax = rows.count(); i < iMax; ++i) {
+            SM_ELEMENT_D(pJacobian, rows[i], columns[i]) = jacobian[i];
+        }
+    } else {
+        sunindextype upperHalfBandwidth = SM_UBAND_B(pJacobian);
+        sunindextype lowerHalfBandwidth = SM_LBAND_B(pJacobian);
+
+        for (int i = 0, iMax = rows.count(); i < iMax; ++i) {
+            if (   (columns[i]-rows[i] <= upperHalfBandwidth)
+                && (rows[i]-columns[i] <= lowerHalfBandwidth)) {
+                SM_ELEMENT_B(pJacobian, rows[i], columns[i]) = jacobian[i];
+            }
+        }
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+int imexJacobianFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                         SUNMatrix pJacobian, void *pUserData, N_Vector pTemp1,
+                         N_Vector pTemp2, N_Vector pTemp3)
+{
+    Q_UNUSED(pRates)
+    Q_UNUSED(pTemp1)
+    Q_UNUSED(pTemp2)
+    Q_UNUSED(pTemp3)
+
+    // Compute the Jacobian of the implicit part of our RHS function, which we
+    // approximate by a diagonal matrix that contains our quasi-linear
+    // coefficients
+    // Note: our matrix is a banded matrix with no upper/lower band, i.e. it
+    //       can be factorised in linear time...
+
+    auto userData = static_cast<ArkodeSolverUserData *>(pUserData);
+
+    userData->computeQuasiLinearCoefficients(pVoi, N_VGetArrayPointer_Serial(pStates));
+
+    const QVector<int> &quasiLinearStates = userData->quasiLinearStates();
+    const double *quasiLinearCoefficients = userData->quasiLinearCoefficients();
+
+    SUNMatZero(pJacobian);
+
+    for (int i = 0, iMax = quasiLinearStates.count(); i < iMax; ++i) {
+        int state = quasiLinearStates[i];
+
+        SM_ELEMENT_B(pJacobian, state, state) = quasiLinearCoefficients[i];
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
+                  char *pErrorMessage, void *pUserData)
+{
+    Q_UNUSED(pModule)
+    Q_UNUSED(pFunction)
+
+    // Forward errors to our ArkodeSolver object
+
+    if (pErrorCode != ARK_WARNING) {
+        static_cast<ArkodeSolver *>(pUserData)->emitError(pErrorMessage);
+    }
+}
+
+//==============================================================================
+
+ArkodeSolverUserData::ArkodeSolverUserData(int pRatesStatesCount,
+                                           double *pConstants, double *pRates,
+                                           double *pAlgebraic,
+                                           Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                           Solver::OdeSolver::ComputeJacobianFunction pComputeJacobian,
+                                           const QVector<int> &pJacobianRows,
+                                           const QVector<int> &pJacobianColumns,
+                                           Solver::OdeSolver::ComputeJacobianFunction pComputeQuasiLinearCoefficients,
+                                           const QVector<int> &pQuasiLinearStates) :
+    mConstants(pConstants),
+    mRates(pRates),
+    mAlgebraic(pAlgebraic),
+    mComputeRates(pComputeRates),
+    mComputeJacobian(pComputeJacobian),
+    mJacobianRows(pJacobianRows),
+    mJacobianColumns(pJacobianColumns),
+    mJacobian(pJacobianRows.count()),
+    mComputeQuasiLinearCoefficients(pComputeQuasiLinearCoefficients),
+    mQuasiLinearStates(pQuasiLinearStates)
+{
+    // Allocate the arrays needed to keep track of our last quasi-linear
+    // coefficients, if needed
+
+    if (pComputeQuasiLinearCoefficients != nullptr) {
+        mQuasiLinearCoefficientsStates.resize(pRatesStatesCount);
+        mQuasiLinearCoefficientsRates.resize(pRatesStatesCount);
+        mQuasiLinearCoefficients.resize(pQuasiLinearStates.count());
+    }
+}
+
+//==============================================================================
+
+double * ArkodeSolverUserData::constants() const
+{
+    // Return our constants array
+
+    return mConstants;
+}
+
+//==============================================================================
+
+double * ArkodeSolverUserData::rates() const
+{
+    // Return our rates array
+
+    return mRates;
+}
+
+//==============================================================================
+
+double * ArkodeSolverUserData::algebraic() const
+{
+    // Return our algebraic array
+
+    return mAlgebraic;
+}
+
+//==============================================================================
+
+Solver::OdeSolver::ComputeRatesFunction ArkodeSolverUserData::computeRates() const
+{
+    // Return our compute rates function
+
+    return mComputeRates;
+}
+
+//==============================================================================
+
+Solver::OdeSolver::ComputeJacobianFunction ArkodeSolverUserData::computeJacobian() const
+{
+    // Return our compute Jacobian function
+
+    return mComputeJacobian;
+}
+
+//==============================================================================
+
+const QVector<int> & ArkodeSolverUserData::jacobianRows() const
+{
+    // Return the row of each entry of our Jacobian
+
+    return mJacobianRows;
+}
+
+//==============================================================================
+
+const QVector<int> & ArkodeSolverUserData::jacobianColumns() const
+{
+    // Return the column of each entry of our Jacobian
+
+    return mJacobianColumns;
+}
+
+//==============================================================================
+
+double * ArkodeSolverUserData::jacobian()
+{
+    // Return our Jacobian entries
+
+    return mJacobian.data();
+}
+
+//==============================================================================
+
+const QVector<int> & ArkodeSolverUserData::quasiLinearStates() const
+{
+    // Return the state to which each of our quasi-linear coefficients
+    // corresponds
+
+    return mQuasiLinearStates;
+}
+
+//==============================================================================
+
+void ArkodeSolverUserData::computeQuasiLinearCoefficients(double pVoi,
+                                                          const double *pStates)
+{
+    // Compute our rates and quasi-linear coefficients for the given states,
+    // unless we have just done so
+    // Note: ARKODE evaluates both the explicit and the implicit parts of our
+    //       RHS function (and sometimes our Jacobian) at the same point, so
+    //       this saves us from computing our rates several times over...
+
+    int statesCount = mQuasiLinearCoefficientsStates.count();
+    double *states = mQuasiLinearCoefficientsStates.data();
+
+    if (   mQuasiLinearCoefficientsComputed
+        && (pVoi == mQuasiLinearCoefficientsVoi)
+        && (memcmp(pStates, states, size_t(statesCount)*sizeof(double)) == 0)) {
+        return;
+    }
+
+    memcpy(states, pStates, size_t(statesCount)*sizeof(double));
+
+    mComputeQuasiLinearCoefficients(pVoi, mConstants,
+                                    mQuasiLinearCoefficientsRates.data(),
+                                    states, mAlgebraic,
+                                    mQuasiLinearCoefficients.data());
+
+    mQuasiLinearCoefficientsComputed = true;
+    mQuasiLinearCoefficientsVoi = pVoi;
+}
+
+//==============================================================================
+
+void ArkodeSolverUserData::resetQuasiLinearCoefficients()
+{
+    // Make sure that our quasi-linear coefficients get recomputed next time
+    // round (e.g. because some of our constants have been modified)
+
+    mQuasiLinearCoefficientsComputed = false;
+}
+
+//==============================================================================
+
+const double * ArkodeSolverUserData::quasiLinearRates() const
+{
+    // Return the rates that were last computed with our quasi-linear
+    // coefficients
+
+    return mQuasiLinearCoefficientsRates.constData();
+}
+
+//==============================================================================
+
+const double * ArkodeSolverUserData::quasiLinearCoefficients() const
+{
+    // Return our last quasi-linear coefficients
+
+    return mQuasiLinearCoefficients.constData();
+}
+
+//==============================================================================
+
+ArkodeSolver::~ArkodeSolver()
+{
+    // Make sure that the solver has been initialised
+
+    if (mSolver == nullptr) {
+        return;
+    }
+
+    // Delete some internal objects
+
+    N_VDestroy_Serial(mStatesVector);
+    SUNLinSolFree(mLinearSolver);
+    SUNMatDestroy(mMatrix);
+
+    ARKStepFree(&mSolver);
+
+    SUNContext_Free(&mContext);
+
+    delete mUserData;
+}
+
+//==============================================================================
+
+bool ArkodeSolver::needJacobian() const
+{
+    // We need the Jacobian of our model if we are to use a DIRK method
+    // Note: this is also the case if we are to use an IMEX method since we
+    //       fall back to a DIRK method if our model has no implicit part (see
+    //       initialize()), something that we only know once our quasi-linear
+    //       coefficients have been retrieved...
+
+    QString integrationMethod = mProperties.value(IntegrationMethodId).toString();
+
+    return (integrationMethod == DirkMethod) || (integrationMethod == ImexMethod);
+}
+
+//==============================================================================
+
+bool ArkodeSolver::needQuasiLinearCoefficients() const
+{
+    // We need the quasi-linear coefficients of our model if we are to use an
+    // IMEX method since they are what we use to determine the implicit part of
+    // our model
+
+    return mProperties.value(IntegrationMethodId).toString() == ImexMethod;
+}
+
+//==============================================================================
+
+void ArkodeSolver::initialize(double pVoi, int pRatesStatesCount,
+                              double *pConstants, double *pRates,
+                              double *pStates, double *pAlgebraic,
+                              ComputeRatesFunction pComputeRates)
+{
+    // Retrieve our properties
+
+    double maximumStep = MaximumStepDefaultValue;
+    int maximumNumberOfSteps = MaximumNumberOfStepsDefaultValue;
+    QString integrationMethod = IntegrationMethodDefaultValue;
+    QString linearSolver = LinearSolverDefaultValue;
+    int upperHalfBandwidth = UpperHalfBandwidthDefaultValue;
+    int lowerHalfBandwidth = LowerHalfBandwidthDefaultValue;
+    double relativeTolerance = RelativeToleranceDefaultValue;
+    double absoluteTolerance = AbsoluteToleranceDefaultValue;
+
+    if (mProperties.contains(MaximumStepId)) {
+        maximumStep = mProperties.value(MaximumStepId).toDouble();
+    } else {
+        emit error(tr(R"(the "Maximum step" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(MaximumNumberOfStepsId)) {
+        maximumNumberOfSteps = mProperties.value(MaximumNumberOfStepsId).toInt();
+    } else {
+        emit error(tr(R"(the "Maximum number of steps" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(IntegrationMethodId)) {
+        integrationMethod = mProperties.value(IntegrationMethodId).toString();
+
+        if (integrationMethod == DirkMethod) {
+            // We are dealing with a DIRK method, so retrieve and check its
+            // linear solver
+
+            if (mProperties.contains(LinearSolverId)) {
+                linearSolver = mProperties.value(LinearSolverId).toString();
+
+                if (linearSolver == BandedLinearSolver) {
+                    // We are dealing with a banded linear solver, so we need
+                    // both an upper and a lower half bandwidth
+
+                    if (mProperties.contains(UpperHalfBandwidthId)) {
+                        upperHalfBandwidth = mProperties.value(UpperHalfBandwidthId).toInt();
+
+                        if (upperHalfBandwidth >= pRatesStatesCount) {
+                            emit error(tr(R"(the "Upper half-bandwidth" property must have a value between 0 and %1)").arg(pRatesStatesCount-1));
+
+                            return;
+                        }
+                    } else {
+                        emit error(tr(R"(the "Upper half-bandwidth" property value could not be retrieved)"));
+
+                        return;
+                    }
+
+                    if (mProperties.contains(LowerHalfBandwidthId)) {
+                        lowerHalfBandwidth = mProperties.value(LowerHalfBandwidthId).toInt();
+
+                        if (lowerHalfBandwidth >= pRatesStatesCount) {
+                            emit error(tr(R"(the "Lower half-bandwidth" property must have a value between 0 and %1)").arg(pRatesStatesCount-1));
+
+                            return;
+                        }
+                    } else {
+                        emit error(tr(R"(the "Lower half-bandwidth" property value could not be retrieved)"));
+
+                        return;
+                    }
+                }
+            } else {
+                emit error(tr(R"(the "Linear solver" property value could not be retrieved)"));
+
+                return;
+            }
+        }
+    } else {
+        emit error(tr(R"(the "Integration method" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(RelativeToleranceId)) {
+        relativeTolerance = mProperties.value(RelativeToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Relative tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(AbsoluteToleranceId)) {
+        absoluteTolerance = mProperties.value(AbsoluteToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Absolute tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(InterpolateSolutionId)) {
+        mInterpolateSolution = mProperties.value(InterpolateSolutionId).toBool();
+    } else {
+        emit error(tr(R"(the "Interpolate solution" property value could not be retrieved)"));
+
+        return;
+    }
+
+    // Initialise our ODE solver
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // Use a DIRK method rather than an IMEX one if our model has no implicit
+    // part, i.e. if we couldn't get its quasi-linear coefficients (e.g.
+    // because it has some NLA systems) or if none of its states has a rate of
+    // the form dx/dt = a+b*x
+    // Note: this means treating the whole of our model implicitly, which is
+    //       the safe option since we don't know whether it is stiff...
+
+    if (   (integrationMethod == ImexMethod)
+        && ((mComputeQuasiLinearCoefficients == nullptr) || mQuasiLinearStates.isEmpty())) {
+        integrationMethod = DirkMethod;
+    }
+
+    // Create our SUNDIALS context
+
+    SUNContext_Create(nullptr, &mContext);
+
+    // Create our states vector
+
+    mStatesVector = N_VMake_Serial(pRatesStatesCount, pStates, mContext);
+
+    // Create our ARKODE solver, using an explicit, an implicit or an
+    // implicit-explicit additive Runge-Kutta method
+
+    if (integrationMethod == ErkMethod) {
+        mSolver = ARKStepCreate(rhsFunction, nullptr, pVoi, mStatesVector, mContext);
+    } else if (integrationMethod == DirkMethod) {
+        mSolver = ARKStepCreate(nullptr, rhsFunction, pVoi, mStatesVector, mContext);
+    } else {
+        mSolver = ARKStepCreate(imexExplicitRhsFunction, imexImplicitRhsFunction,
+                                pVoi, mStatesVector, mContext);
+    }
+
+    // Use our own error handler
+
+    ARKStepSetErrHandlerFn(mSolver, errorHandler, this);
+
+    // Set our user data
+
+    mUserData = new ArkodeSolverUserData(pRatesStatesCount, pConstants, pRates,
+                                         pAlgebraic, pComputeRates,
+                                         mComputeJacobian, mJacobianRows,
+                                         mJacobianColumns,
+                                         (integrationMethod == ImexMethod)?
+                                             mComputeQuasiLinearCoefficients:
+                                             nullptr,
+                                         mQuasiLinearStates);
+
+    ARKStepSetUserData(mSolver, mUserData);
+
+    // Set our maximum step
+
+    ARKStepSetMaxStep(mSolver, maximumStep);
+
+    // Set our maximum number of steps
+
+    ARKStepSetMaxNumSteps(mSolver, maximumNumberOfSteps);
+
+    // Set our linear solver, if needed
+
+    if (integrationMethod == DirkMethod) {
+        if (linearSolver == DenseLinearSolver) {
+            mMatrix = SUNDenseMatrix(pRatesStatesCount, pRatesStatesCount, mContext);
+            mLinearSolver = SUNLinSol_Dense(mStatesVector, mMatrix, mContext);
+        } else {
+            mMatrix = SUNBandMatrix(pRatesStatesCount, upperHalfBandwidth,
+                                                       lowerHalfBandwidth, mContext);
+            mLinearSolver = SUNLinSol_Band(mStatesVector, mMatrix, mContext);
+        }
+
+        ARKStepSetLinearSolver(mSolver, mLinearSolver, mMatrix);
+
+        // Use our Jacobian function rather than a finite difference
+        // approximation, if we have a function that computes the Jacobian of
+        // our model
+
+        if (mComputeJacobian != nullptr) {
+            ARKStepSetJacFn(mSolver, jacobianFunction);
+        }
+    } else if (integrationMethod == ImexMethod) {
+        mMatrix = SUNBandMatrix(pRatesStatesCount, 0, 0, mContext);
+        mLinearSolver = SUNLinSol_Band(mStatesVector, mMatrix, mContext);
+
+        ARKStepSetLinearSolver(mSolver, mLinearSolver, mMatrix);
+        ARKStepSetJacFn(mSolver, imexJacobianFunction);
+    }
+
+    // Set our relative and absolute tolerances
+
+    ARKStepSStolerances(mSolver, relativeTolerance, absoluteTolerance);
+}
+
+//==============================================================================
+
+void ArkodeSolver::reinitialize(double pVoi)
+{
+    // Reinitialise our ARKODE object
+
+    mUserData->resetQuasiLinearCoefficients();
+
+    ARKStepReset(mSolver, pVoi, mStatesVector);
+}
+
+//==============================================================================
+
+void ArkodeSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // Solve the model
+
+    if (!mInterpolateSolution) {
+        ARKStepSetStopTime(mSolver, pVoiEnd);
+    }
+
+    ARKStepEvolve(mSolver, pVoiEnd, mStatesVector, &pVoi, ARK_NORMAL);
+
+    // Compute the rates one more time to get up to date values for the rates
+    // Note: another way of doing this would be to copy the contents of the
+    //       calculated rates in our RHS function(s), but that's bound to be
+    //       more time consuming since a call to ARKStepEvolve() is likely to
+    //       generate quite a few calls to those functions...
+
+    mComputeRates(pVoiEnd, mConstants, mRates,
+                  N_VGetArrayPointer_Serial(mStatesVector), mAlgebraic);
+}
+
+//==============================================================================
+
+Solver::Solver::Statistics ArkodeSolver::statistics() const
+{
+    // Return the statistics of our ARKODE object
+    // Note #1: ARKODE keeps track of those counters anyway, so retrieving them
+    //          comes at no cost...
+    // Note #2: unlike CVODES, resetting our ARKODE object doesn't reset its
+    //          counters, so no need to keep track of them ourselves...
+    // Note #3: we use both the explicit and implicit RHS evaluations since, in
+    //          the IMEX case, both parts of our model get evaluated...
+
+    Statistics res;
+
+    if (mStatisticsEnabled && (mSolver != nullptr)) {
+        long int steps = 0;
+        long int explicitRhsEvaluations = 0;
+        long int implicitRhsEvaluations = 0;
+        long int jacobianEvaluations = 0;
+        long int linearSolverSetups = 0;
+        long int errorTestFailures = 0;
+
+        ARKStepGetNumSteps(mSolver, &steps);
+        ARKStepGetNumRhsEvals(mSolver, &explicitRhsEvaluations, &implicitRhsEvaluations);
+        ARKStepGetNumJacEvals(mSolver, &jacobianEvaluations);
+        ARKStepGetNumLinSolvSetups(mSolver, &linearSolverSetups);
+        ARKStepGetNumErrTestFails(mSolver, &errorTestFailures);
+
+        res[OpenCOR::Solver::StepsStatistic] = quint64(steps);
+        res[OpenCOR::Solver::RhsEvaluationsStatistic] = quint64(explicitRhsEvaluations+implicitRhsEvaluations);
+        res[OpenCOR::Solver::JacobianEvaluationsStatistic] = quint64(jacobianEvaluations);
+        res[OpenCOR::Solver::LinearSolverSetupsStatistic] = quint64(linearSolverSetups);
+        res[OpenCOR::Solver::ErrorTestFailuresStatistic] = quint64(errorTestFailures);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+} // namespace ARKODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,193 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// ARKODE solver
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "solverinterface.h"
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "sundials/sundials_linearsolver.h"
+    #include "sundials/sundials_matrix.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace ARKODESolver {
+
+//==============================================================================
+
+static const auto MaximumStepId          = QStringLiteral("MaximumStep");
+static const auto MaximumNumberOfStepsId = QStringLiteral("MaximumNumberOfSteps");
+static const auto IntegrationMethodId    = QStringLiteral("IntegrationMethod");
+static const auto LinearSolverId         = QStringLiteral("LinearSolver");
+static const auto UpperHalfBandwidthId   = QStringLiteral("UpperHalfBandwidth");
+static const auto LowerHalfBandwidthId   = QStringLiteral("LowerHalfBandwidth");
+static const auto RelativeToleranceId    = QStringLiteral("RelativeTolerance");
+static const auto AbsoluteToleranceId    = QStringLiteral("AbsoluteTolerance");
+static const auto InterpolateSolutionId  = QStringLiteral("InterpolateSolution");
+
+//==============================================================================
+
+static const auto ErkMethod  = QStringLiteral("ERK");
+static const auto DirkMethod = QStringLiteral("DIRK");
+static const auto ImexMethod = QStringLiteral("IMEX");
+
+//==============================================================================
+
+static const auto DenseLinearSolver  = QStringLiteral("Dense");
+static const auto BandedLinearSolver = QStringLiteral("Banded");
+
+//==============================================================================
+
+// Default ARKODE parameter values
+// Note #1: a maximum step of 0 means that there is no maximum step as such and
+//          that ARKODE can use whatever step it sees fit...
+// Note #2: ARKODE's default maximum number of steps is 500, which ought to be
+//          big enough in most cases...
+
+static const double MaximumStepDefaultValue = 0.0;
+
+enum {
+    MaximumNumberOfStepsDefaultValue = 500
+};
+
+static const auto IntegrationMethodDefaultValue = ImexMethod;
+static const auto LinearSolverDefaultValue = DenseLinearSolver;
+
+enum {
+    UpperHalfBandwidthDefaultValue = 0,
+    LowerHalfBandwidthDefaultValue = 0
+};
+
+static const double RelativeToleranceDefaultValue = 1.0e-7;
+static const double AbsoluteToleranceDefaultValue = 1.0e-7;
+
+static const bool InterpolateSolutionDefaultValue = true;
+
+//==============================================================================
+
+class ArkodeSolverUserData
+{
+public:
+    explicit ArkodeSolverUserData(int pRatesStatesCount, double *pConstants,
+                                  double *pRates, double *pAlgebraic,
+                                  Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                  Solver::OdeSolver::ComputeJacobianFunction pComputeJacobian,
+                                  const QVector<int> &pJacobianRows,
+                                  const QVector<int> &pJacobianColumns,
+                                  Solver::OdeSolver::ComputeJacobianFunction pComputeQuasiLinearCoefficients,
+                                  const QVector<int> &pQuasiLinearStates);
+
+    double * constants() const;
+    double * rates() const;
+    double * algebraic() const;
+
+    Solver::OdeSolver::ComputeRatesFunction computeRates() const;
+    Solver::OdeSolver::ComputeJacobianFunction computeJacobian() const;
+
+    const QVector<int> & jacobianRows() const;
+    const QVector<int> & jacobianColumns() const;
+
+    double * jacobian();
+
+    const QVector<int> & quasiLinearStates() const;
+
+    void computeQuasiLinearCoefficients(double pVoi, const double *pStates);
+    void resetQuasiLinearCoefficients();
+
+    const double * quasiLinearRates() const;
+    const double * quasiLinearCoefficients() const;
+
+private:
+    double *mConstants;
+    double *mRates;
+    double *mAlgebraic;
+
+    Solver::OdeSolver::ComputeRatesFunction mComputeRates;
+    Solver::OdeSolver::ComputeJacobianFunction mComputeJacobian;
+
+    QVector<int> mJacobianRows;
+    QVector<int> mJacobianColumns;
+
+    QVector<double> mJacobian;
+
+    Solver::OdeSolver::ComputeJacobianFunction mComputeQuasiLinearCoefficients;
+
+    QVector<int> mQuasiLinearStates;
+
+    bool mQuasiLinearCoefficientsComputed = false;
+    double mQuasiLinearCoefficientsVoi = 0.0;
+    QVector<double> mQuasiLinearCoefficientsStates;
+    QVector<double> mQuasiLinearCoefficientsRates;
+    QVector<double> mQuasiLinearCoefficients;
+};
+
+//==============================================================================
+
+class ArkodeSolver : public OpenCOR::Solver::OdeSolver
+{
+    Q_OBJECT
+
+public:
+    ~ArkodeSolver() override;
+
+    bool needJacobian() const override;
+    bool needQuasiLinearCoefficients() const override;
+
+    void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
+                    double *pRates, double *pStates, double *pAlgebraic,
+                    ComputeRatesFunction pComputeRates) override;
+    void reinitialize(double pVoi) override;
+
+    void solve(double &pVoi, double pVoiEnd) const override;
+
+    Statistics statistics() const override;
+
+private:
+    void *mSolver = nullptr;
+
+    SUNContext mContext = nullptr;
+
+    N_Vector mStatesVector = nullptr;
+
+    SUNMatrix mMatrix = nullptr;
+    SUNLinearSolver mLinearSolver = nullptr;
+
+    ArkodeSolverUserData *mUserData = nullptr;
+
+    bool mInterpolateSolution = InterpolateSolutionDefaultValue;
+};
+
+//==============================================================================
+
+} // namespace ARKODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,65 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// ARKODE solver plugin
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "i18ninterface.h"
+#include "plugininfo.h"
+#include "solverinterface.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace ARKODESolver {
+
+//==============================================================================
+
+PLUGININFO_FUNC ARKODESolverPluginInfo();
+
+//==============================================================================
+
+class ARKODESolverPlugin : public QObject, public I18nInterface,
+                           public SolverInterface
+{
+    Q_OBJECT
+
+    Q_PLUGIN_METADATA(IID "OpenCOR.ARKODESolverPlugin" FILE "arkodesolverplugin.json")
+
+    Q_INTERFACES(OpenCOR::I18nInterface)
+    Q_INTERFACES(OpenCOR::SolverInterface)
+
+public:
+#include "i18ninterface.inl"
+#include "solverinterface.inl"
+};
+
+//==============================================================================
+
+} // namespace ARKODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -55,5 +55,9 @@
         <source>the &quot;Interpolate solution&quot; property value could not be retrieved</source>
         <translation>la valeur de la propriété &quot;Interpoler solution&quot; n&apos;a pas pu être retrouvée</translation>
     </message>
+    <message>
+        <source>the &quot;Thread count&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Nombre de threads&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
 </context>
 </TS>
@@ -22,6 +22,12 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "cvodesolver.h"
+#include "cvodesolversparselinearsolver.h"
+#include "cvodesolverthreadedvector.h"
+
+//==============================================================================
+
+#include <algorithm>
 
 //==============================================================================
 
@@ -35,6 +41,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
     #include "sunlinsol/sunlinsol_spbcgs.h"
     #include "sunlinsol/sunlinsol_spgmr.h"
     #include "sunlinsol/sunlinsol_sptfqmr.h"
+    #include "sunmatrix/sunmatrix_sparse.h"
     #include "sunnonlinsol/sunnonlinsol_fixedpoint.h"
 #include "sundialsend.h"
 
@@ -61,6 +68,90 @@ int rhsFunction(double pVoi, N_Vector pStates, N_Vector pRates, void *pUserData)
 
 //==============================================================================
 
+int jacobianFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                     SUNMatrix pJacobian, void *pUserData, N_Vector pTemp1,
+                     N_Vector pTemp2, N_Vector pTemp3)
+{
+    Q_UNUSED(pRates)
+    Q_UNUSED(pTemp1)
+    Q_UNUSED(pTemp2)
+    Q_UNUSED(pTemp3)
+
+    // Compute the (non-zero) entries of our Jacobian
+
+    auto userData = static_cast<CvodeSolverUserData *>(pUserData);
+    double *jacobian = userData->jacobian();
+
+    userData->computeJacobian()(pVoi, userData->constants(), userData->rates(),
+                                N_VGetArrayPointer_Serial(pStates),
+                                userData->algebraic(), jacobian);
+
+    // Copy those entries to our dense/banded/sparse matrix
+    // Note #1: in the case of a banded matrix, the entries that are outside of
+    //          our band are ignored, just like they would be if our Jacobian
+    //          was approximated using finite differences...
+    // Note #2: in the case of a sparse matrix, SUNMatZero() also resets its
+    //          sparsity pattern, hence we set it again...
+
+    const QVector<int> &rows = userData->jacobianRows();
+    const QVector<int> &columns = userData->jacobianColumns();
+
+    SUNMatZero(pJacobian);
+
+    if (SUNMatGetID(pJacobian) == SUNMATRIX_DENSE) {
+        for (int i = 0, iMax = rows.count(); i < iMax; ++i) {
+            SM_ELEMENT_D(pJacobian, rows[i], columns[i]) = jacobian[i];
+        }
+    } else if (SUNMatGetID(pJacobian) == SUNMATRIX_BAND) {
+        sunindextype upperHalfBandwidth = SM_UBAND_B(pJacobian);
+        sunindextype lowerHalfBandwidth = SM_LBAND_B(pJacobian);
+
+        for (int i = 0, iMax = rows.count(); i < iMax; ++i) {
+            if (   (columns[i]-rows[i] <= upperHalfBandwidth)
+                && (rows[i]-columns[i] <= lowerHalfBandwidth)) {
+                SM_ELEMENT_B(pJacobian, rows[i], columns[i]) = jacobian[i];
+            }
+        }
+    } else {
+        const QVector<sunindextype> &columnPointers = userData->sparseColumnPointers();
+        const QVector<sunindextype> &rowIndices = userData->sparseRowIndices();
+        const QVector<int> &positions = userData->sparsePositions();
+        double *data = SM_DATA_S(pJacobian);
+
+        std::copy(columnPointers.constBegin(), columnPointers.constEnd(), SM_INDEXPTRS_S(pJacobian));
+        std::copy(rowIndices.constBegin(), rowIndices.constEnd(), SM_INDEXVALS_S(pJacobian));
+
+        for (int i = 0, iMax = positions.count(); i < iMax; ++i) {
+            data[positions[i]] = jacobian[i];
+        }
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+int rootFindingFunction(double pVoi, N_Vector pStates,
+                        double *pConditionVariables, void *pUserData)
+{
+    // Compute our condition variables, making sure that our algebraic
+    // variables are up to date first
+
+    auto userData = static_cast<CvodeSolverUserData *>(pUserData);
+    double *states = N_VGetArrayPointer_Serial(pStates);
+
+    userData->computeRates()(pVoi, userData->constants(), userData->rates(),
+                             states, userData->algebraic());
+    userData->computeRootInformation()(pVoi, userData->constants(),
+                                       userData->rates(), states,
+                                       userData->algebraic(),
+                                       pConditionVariables);
+
+    return 0;
+}
+
+//==============================================================================
+
 void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
                   char *pErrorMessage, void *pUserData)
 {
@@ -76,12 +167,64 @@ void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
 
 //==============================================================================
 
-CvodeSolverUserData::CvodeSolverUserData(double *pConstants, double *pAlgebraic,
-                                         Solver::OdeSolver::ComputeRatesFunction pComputeRates) :
+CvodeSolverUserData::CvodeSolverUserData(int pRatesStatesCount,
+                                         double *pConstants, double *pRates,
+                                         double *pAlgebraic,
+                                         Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                         Solver::OdeSolver::ComputeJacobianFunction pComputeJacobian,
+                                         const QVector<int> &pJacobianRows,
+                                         const QVector<int> &pJacobianColumns,
+                                         Solver::OdeSolver::ComputeRootInformationFunction pComputeRootInformation) :
     mConstants(pConstants),
+    mRates(pRates),
     mAlgebraic(pAlgebraic),
-    mComputeRates(pComputeRates)
+    mComputeRates(pComputeRates),
+    mComputeJacobian(pComputeJacobian),
+    mComputeRootInformation(pComputeRootInformation),
+    mJacobianRows(pJacobianRows),
+    mJacobianColumns(pJacobianColumns),
+    mJacobian(pJacobianRows.count())
 {
+    // Determine the (CSC) sparsity pattern of our Jacobian, making sure that
+    // its diagonal is included since CVODES needs to compute I-gamma*J, as
+    // well as the position of each of its entries within that pattern
+
+    if (pJacobianRows.isEmpty()) {
+        return;
+    }
+
+    QVector<QVector<sunindextype>> columnsRows(pRatesStatesCount);
+
+    for (int i = 0; i < pRatesStatesCount; ++i) {
+        columnsRows[i] << i;
+    }
+
+    for (int i = 0, iMax = pJacobianRows.count(); i < iMax; ++i) {
+        columnsRows[pJacobianColumns[i]] << pJacobianRows[i];
+    }
+
+    mSparseColumnPointers << 0;
+
+    for (auto &columnRows : columnsRows) {
+        std::sort(columnRows.begin(), columnRows.end());
+
+        columnRows.erase(std::unique(columnRows.begin(), columnRows.end()),
+                         columnRows.end());
+
+        mSparseRowIndices << columnRows;
+        mSparseColumnPointers << mSparseRowIndices.count();
+    }
+
+    mSparsePositions.reserve(pJacobianRows.count());
+
+    for (int i = 0, iMax = pJacobianRows.count(); i < iMax; ++i) {
+        const QVector<sunindextype> &columnRows = columnsRows[pJacobianColumns[i]];
+
+        mSparsePositions << int(mSparseColumnPointers[pJacobianColumns[i]])
+                           +int(std::lower_bound(columnRows.constBegin(),
+                                                 columnRows.constEnd(),
+                                                 pJacobianRows[i])-columnRows.constBegin());
+    }
 }
 
 //==============================================================================
@@ -95,6 +238,15 @@ double * CvodeSolverUserData::constants() const
 
 //==============================================================================
 
+double * CvodeSolverUserData::rates() const
+{
+    // Return our rates array
+
+    return mRates;
+}
+
+//==============================================================================
+
 double * CvodeSolverUserData::algebraic() const
 {
     // Return our algebraic array
@@ -113,6 +265,89 @@ Solver::OdeSolver::ComputeRatesFunction CvodeSolverUserData::computeRates() cons
 
 //==============================================================================
 
+Solver::OdeSolver::ComputeJacobianFunction CvodeSolverUserData::computeJacobian() const
+{
+    // Return our compute Jacobian function
+
+    return mComputeJacobian;
+}
+
+//==============================================================================
+
+Solver::OdeSolver::ComputeRootInformationFunction CvodeSolverUserData::computeRootInformation() const
+{
+    // Return our compute root information function
+
+    return mComputeRootInformation;
+}
+
+//==============================================================================
+
+const QVector<int> & CvodeSolverUserData::jacobianRows() const
+{
+    // Return the row of each entry of our Jacobian
+
+    return mJacobianRows;
+}
+
+//==============================================================================
+
+const QVector<int> & CvodeSolverUserData::jacobianColumns() const
+{
+    // Return the column of each entry of our Jacobian
+
+    return mJacobianColumns;
+}
+
+//==============================================================================
+
+double * CvodeSolverUserData::jacobian()
+{
+    // Return our Jacobian entries
+
+    return mJacobian.data();
+}
+
+//==============================================================================
+
+int CvodeSolverUserData::sparseNonZerosCount() const
+{
+    // Return the number of non-zero entries in the sparsity pattern of our
+    // Jacobian
+
+    return mSparseRowIndices.count();
+}
+
+//==============================================================================
+
+const QVector<sunindextype> & CvodeSolverUserData::sparseColumnPointers() const
+{
+    // Return the column pointers of the sparsity pattern of our Jacobian
+
+    return mSparseColumnPointers;
+}
+
+//==============================================================================
+
+const QVector<sunindextype> & CvodeSolverUserData::sparseRowIndices() const
+{
+    // Return the row indices of the sparsity pattern of our Jacobian
+
+    return mSparseRowIndices;
+}
+
+//==============================================================================
+
+const QVector<int> & CvodeSolverUserData::sparsePositions() const
+{
+    // Return the position of each entry of our Jacobian within its sparsity
+    // pattern
+
+    return mSparsePositions;
+}
+
+//==============================================================================
+
 CvodeSolver::~CvodeSolver()
 {
     // Make sure that the solver has been initialised
@@ -131,6 +366,34 @@ CvodeSolver::~CvodeSolver()
     CVodeFree(&mSolver);
 
     delete mUserData;
+    delete mThreadedVector;
+}
+
+//==============================================================================
+
+bool CvodeSolver::needJacobian() const
+{
+    // We need the Jacobian of our model if we are to use a Newton iteration
+    // with a dense, a banded or a sparse linear solver
+
+    return    (mProperties.value(IterationTypeId).toString() == NewtonIteration)
+           && (   (mProperties.value(LinearSolverId).toString() == DenseLinearSolver)
+               || (mProperties.value(LinearSolverId).toString() == BandedLinearSolver)
+               || (mProperties.value(LinearSolverId).toString() == SparseLinearSolver));
+}
+
+//==============================================================================
+
+bool CvodeSolver::needRootInformation() const
+{
+    // We need the root information of our model if we are to use root finding,
+    // so that we can stop at each of its discontinuities rather than have
+    // CVODES shrink its step size (and fail error tests) to get through them
+    // Note: root finding is not free (our model's conditions get evaluated at
+    //       each step), so it can be turned off for models whose
+    //       discontinuities are known not to matter...
+
+    return mProperties.value(RootFindingId, RootFindingDefaultValue).toBool();
 }
 
 //==============================================================================
@@ -152,6 +415,7 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
     int lowerHalfBandwidth = LowerHalfBandwidthDefaultValue;
     double relativeTolerance = RelativeToleranceDefaultValue;
     double absoluteTolerance = AbsoluteToleranceDefaultValue;
+    int threadCount = ThreadCountDefaultValue;
 
     if (mProperties.contains(MaximumStepId)) {
         maximumStep = mProperties.value(MaximumStepId).toDouble();
@@ -190,9 +454,10 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
                 bool needUpperAndLowerHalfBandwidths = false;
 
                 if (   (linearSolver == DenseLinearSolver)
-                    || (linearSolver == DiagonalLinearSolver)) {
-                    // We are dealing with a dense/diagonal linear solver, so
-                    // nothing more to do
+                    || (linearSolver == DiagonalLinearSolver)
+                    || (linearSolver == SparseLinearSolver)) {
+                    // We are dealing with a dense/diagonal/sparse linear
+                    // solver, so nothing more to do
                 } else if (linearSolver == BandedLinearSolver) {
                     // We are dealing with a banded linear solver, so we need
                     // both an upper and a lower half bandwidth
@@ -283,6 +548,14 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
         return;
     }
 
+    if (mProperties.contains(ThreadCountId)) {
+        threadCount = mProperties.value(ThreadCountId).toInt();
+    } else {
+        emit error(tr(R"(the "Thread count" property value could not be retrieved)"));
+
+        return;
+    }
+
     // Initialise our ODE solver
 
     OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
@@ -298,6 +571,21 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
 
     mStatesVector = N_VMake_Serial(pRatesStatesCount, pStates, context);
 
+    // Share the operations on our states vector (and therefore on all the
+    // vectors that CVODES will clone from it) between several threads, if
+    // requested
+    // Note: this is only worth it for very large models (e.g. tissue-scale
+    //       models with tens of thousands of states), which is why operations
+    //       on smaller vectors are still carried out by the calling thread
+    //       only (see CvodeSolverThreadedVector)...
+
+    if (threadCount > 1) {
+        mThreadedVector = new CvodeSolverThreadedVector(threadCount);
+
+        mThreadedVector->install(mStatesVector);
+        mThreadedVector->activate();
+    }
+
     // Create our CVODES solver
 
     bool newtonIteration = iterationType == NewtonIteration;
@@ -314,10 +602,21 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
 
     // Set our user data
 
-    mUserData = new CvodeSolverUserData(pConstants, pAlgebraic, pComputeRates);
+    mUserData = new CvodeSolverUserData(pRatesStatesCount, pConstants, pRates,
+                                        pAlgebraic,
+                                        pComputeRates, mComputeJacobian,
+                                        mJacobianRows, mJacobianColumns,
+                                        mComputeRootInformation);
 
     CVodeSetUserData(mSolver, mUserData);
 
+    // Set our root finding function, if needed, so that we can stop at each of
+    // the discontinuities of our model
+
+    if ((mComputeRootInformation != nullptr) && (mConditionVariablesCount != 0)) {
+        CVodeRootInit(mSolver, mConditionVariablesCount, rootFindingFunction);
+    }
+
     // Set our maximum step
 
     CVodeSetMaxStep(mSolver, maximumStep);
@@ -329,6 +628,15 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
     // Set our linear solver, if needed
 
     if (newtonIteration) {
+        // Use a dense linear solver rather than a sparse one if we don't have
+        // a function that computes the Jacobian of our model
+        // Note: SUNDIALS cannot approximate a sparse Jacobian using finite
+        //       differences...
+
+        if ((linearSolver == SparseLinearSolver) && (mComputeJacobian == nullptr)) {
+            linearSolver = DenseLinearSolver;
+        }
+
         if (linearSolver == DenseLinearSolver) {
             mMatrix = SUNDenseMatrix(pRatesStatesCount, pRatesStatesCount, context);
             mLinearSolver = SUNLinSol_Dense(mStatesVector, mMatrix, context);
@@ -339,6 +647,13 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
                                                        lowerHalfBandwidth, context);
             mLinearSolver = SUNLinSol_Band(mStatesVector, mMatrix, context);
 
+            CVodeSetLinearSolver(mSolver, mLinearSolver, mMatrix);
+        } else if (linearSolver == SparseLinearSolver) {
+            mMatrix = SUNSparseMatrix(pRatesStatesCount, pRatesStatesCount,
+                                      mUserData->sparseNonZerosCount(),
+                                      CSC_MAT, context);
+            mLinearSolver = CvodeSolverSparseLinearSolver::create(context);
+
             CVodeSetLinearSolver(mSolver, mLinearSolver, mMatrix);
         } else if (linearSolver == DiagonalLinearSolver) {
             CVDiag(mSolver);
@@ -369,6 +684,14 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
                 CVodeSetLinearSolver(mSolver, mLinearSolver, mMatrix);
             }
         }
+
+        // Use our Jacobian function rather than a finite difference
+        // approximation, if we have a matrix-based linear solver and a
+        // function that computes the Jacobian of our model
+
+        if ((mMatrix != nullptr) && (mComputeJacobian != nullptr)) {
+            CVodeSetJacFn(mSolver, jacobianFunction);
+        }
     } else {
         mNonLinearSolver = SUNNonlinSol_FixedPoint(mStatesVector, 0, context);
 
@@ -384,22 +707,55 @@ void CvodeSolver::initialize(double pVoi, int pRatesStatesCount,
 
 void CvodeSolver::reinitialize(double pVoi)
 {
+    // Make sure that our threaded vector, if any, is used by the calling thread
+
+    if (mThreadedVector != nullptr) {
+        mThreadedVector->activate();
+    }
+
     // Reinitialise our CVODES object
 
-    CVodeReInit(mSolver, pVoi, mStatesVector);
+    restart(pVoi);
 }
 
 //==============================================================================
 
 void CvodeSolver::solve(double &pVoi, double pVoiEnd) const
 {
-    // Solve the model
+    // Make sure that our threaded vector, if any, is used by the calling thread
 
-    if (!mInterpolateSolution) {
-        CVodeSetStopTime(mSolver, pVoiEnd);
+    if (mThreadedVector != nullptr) {
+        mThreadedVector->activate();
     }
 
-    CVode(mSolver, pVoiEnd, mStatesVector, &pVoi, CV_NORMAL);
+    // Solve the model, restarting our CVODES object at each discontinuity that
+    // we come across
+    // Note #1: CVode() returns CV_ROOT_RETURN when it finds a root of one of
+    //          our condition variables, in which case pVoi and our states
+    //          correspond to that root. Restarting from there is much cheaper
+    //          than having CVODES shrink its step size (and fail error tests)
+    //          to get through the discontinuity...
+    // Note #2: we (re)set our stop time before each call to CVode() since it
+    //          may have been cancelled in between, e.g. as a result of
+    //          reinitialising our CVODES object...
+
+    forever {
+        if (!mInterpolateSolution) {
+            CVodeSetStopTime(mSolver, pVoiEnd);
+        }
+
+        if (CVode(mSolver, pVoiEnd, mStatesVector, &pVoi, CV_NORMAL) != CV_ROOT_RETURN) {
+            break;
+        }
+
+        restart(pVoi);
+
+        if (qFuzzyCompare(pVoi, pVoiEnd)) {
+            pVoi = pVoiEnd;
+
+            break;
+        }
+    }
 
     // Compute the rates one more time to get up to date values for the rates
     // Note: another way of doing this would be to copy the contents of the
@@ -414,6 +770,56 @@ void CvodeSolver::solve(double &pVoi, double pVoiEnd) const
 
 //==============================================================================
 
+void CvodeSolver::restart(double pVoi) const
+{
+    // Keep track of our statistics, if needed, since reinitialising our CVODES
+    // object resets its counters
+
+    if (mStatisticsEnabled) {
+        mStatistics = statistics();
+    }
+
+    // Reinitialise our CVODES object
+
+    CVodeReInit(mSolver, pVoi, mStatesVector);
+}
+
+//==============================================================================
+
+Solver::Solver::Statistics CvodeSolver::statistics() const
+{
+    // Return our statistics, i.e. those that we have kept track of so far and
+    // those of our current CVODES object
+    // Note: CVODES keeps track of those counters anyway, so retrieving them
+    //       comes at no cost...
+
+    Statistics res = mStatistics;
+
+    if (mStatisticsEnabled && (mSolver != nullptr)) {
+        long int steps = 0;
+        long int rhsEvaluations = 0;
+        long int jacobianEvaluations = 0;
+        long int linearSolverSetups = 0;
+        long int errorTestFailures = 0;
+
+        CVodeGetNumSteps(mSolver, &steps);
+        CVodeGetNumRhsEvals(mSolver, &rhsEvaluations);
+        CVodeGetNumJacEvals(mSolver, &jacobianEvaluations);
+        CVodeGetNumLinSolvSetups(mSolver, &linearSolverSetups);
+        CVodeGetNumErrTestFails(mSolver, &errorTestFailures);
+
+        res[OpenCOR::Solver::StepsStatistic] += quint64(steps);
+        res[OpenCOR::Solver::RhsEvaluationsStatistic] += quint64(rhsEvaluations);
+        res[OpenCOR::Solver::JacobianEvaluationsStatistic] += quint64(jacobianEvaluations);
+        res[OpenCOR::Solver::LinearSolverSetupsStatistic] += quint64(linearSolverSetups);
+        res[OpenCOR::Solver::ErrorTestFailuresStatistic] += quint64(errorTestFailures);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 } // namespace CVODESolver
 } // namespace OpenCOR
 
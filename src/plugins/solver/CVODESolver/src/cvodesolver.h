@@ -53,6 +53,8 @@ static const auto LowerHalfBandwidthId   = QStringLiteral("LowerHalfBandwidth");
 static const auto RelativeToleranceId    = QStringLiteral("RelativeTolerance");
 static const auto AbsoluteToleranceId    = QStringLiteral("AbsoluteTolerance");
 static const auto InterpolateSolutionId  = QStringLiteral("InterpolateSolution");
+static const auto RootFindingId          = QStringLiteral("RootFinding");
+static const auto ThreadCountId          = QStringLiteral("ThreadCount");
 
 //==============================================================================
 
@@ -72,6 +74,7 @@ static const auto DiagonalLinearSolver = QStringLiteral("Diagonal");
 static const auto GmresLinearSolver    = QStringLiteral("GMRES");
 static const auto BiCgStabLinearSolver = QStringLiteral("BiCGStab");
 static const auto TfqmrLinearSolver    = QStringLiteral("TFQMR");
+static const auto SparseLinearSolver   = QStringLiteral("Sparse");
 
 //==============================================================================
 
@@ -106,25 +109,66 @@ static const double RelativeToleranceDefaultValue = 1.0e-7;
 static const double AbsoluteToleranceDefaultValue = 1.0e-7;
 
 static const bool InterpolateSolutionDefaultValue = true;
+static const bool RootFindingDefaultValue = true;
+
+enum {
+    ThreadCountDefaultValue = 1
+};
+
+//==============================================================================
+
+class CvodeSolverThreadedVector;
 
 //==============================================================================
 
 class CvodeSolverUserData
 {
 public:
-    explicit CvodeSolverUserData(double *pConstants, double *pAlgebraic,
-                                 Solver::OdeSolver::ComputeRatesFunction pComputeRates);
+    explicit CvodeSolverUserData(int pRatesStatesCount, double *pConstants,
+                                 double *pRates,
+                                 double *pAlgebraic,
+                                 Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                 Solver::OdeSolver::ComputeJacobianFunction pComputeJacobian,
+                                 const QVector<int> &pJacobianRows,
+                                 const QVector<int> &pJacobianColumns,
+                                 Solver::OdeSolver::ComputeRootInformationFunction pComputeRootInformation);
 
     double * constants() const;
+    double * rates() const;
     double * algebraic() const;
 
     Solver::OdeSolver::ComputeRatesFunction computeRates() const;
+    Solver::OdeSolver::ComputeJacobianFunction computeJacobian() const;
+    Solver::OdeSolver::ComputeRootInformationFunction computeRootInformation() const;
+
+    const QVector<int> & jacobianRows() const;
+    const QVector<int> & jacobianColumns() const;
+
+    double * jacobian();
+
+    int sparseNonZerosCount() const;
+
+    const QVector<sunindextype> & sparseColumnPointers() const;
+    const QVector<sunindextype> & sparseRowIndices() const;
+    const QVector<int> & sparsePositions() const;
 
 private:
     double *mConstants;
+    double *mRates;
     double *mAlgebraic;
 
     Solver::OdeSolver::ComputeRatesFunction mComputeRates;
+    Solver::OdeSolver::ComputeJacobianFunction mComputeJacobian;
+    Solver::OdeSolver::ComputeRootInformationFunction mComputeRootInformation;
+
+    QVector<int> mJacobianRows;
+    QVector<int> mJacobianColumns;
+
+    QVector<double> mJacobian;
+
+    QVector<sunindextype> mSparseColumnPointers;
+    QVector<sunindextype> mSparseRowIndices;
+    QVector<int> mSparsePositions;
 };
 
 //==============================================================================
@@ -136,6 +180,9 @@ class CvodeSolver : public OpenCOR::Solver::OdeSolver
 public:
     ~CvodeSolver() override;
 
+    bool needJacobian() const override;
+    bool needRootInformation() const override;
+
     void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
@@ -143,6 +190,8 @@ public:
 
     void solve(double &pVoi, double pVoiEnd) const override;
 
+    Statistics statistics() const override;
+
 private:
     void *mSolver = nullptr;
 
@@ -154,7 +203,13 @@ private:
 
     CvodeSolverUserData *mUserData = nullptr;
 
+    CvodeSolverThreadedVector *mThreadedVector = nullptr;
+
     bool mInterpolateSolution = InterpolateSolutionDefaultValue;
+
+    mutable Statistics mStatistics;
+
+    void restart(double pVoi) const;
 };
 
 //==============================================================================
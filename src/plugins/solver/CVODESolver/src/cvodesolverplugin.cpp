@@ -84,6 +84,7 @@ QString CVODESolverPlugin::id(const QString &pKisaoId) const
     static const QString Kisao0000209 = "KISAO:0000209";
     static const QString Kisao0000211 = "KISAO:0000211";
     static const QString Kisao0000481 = "KISAO:0000481";
+    static const QString Kisao0000529 = "KISAO:0000529";
 
     if (pKisaoId == Kisao0000019) {
         return solverName();
@@ -133,6 +134,10 @@ QString CVODESolverPlugin::id(const QString &pKisaoId) const
         return InterpolateSolutionId;
     }
 
+    if (pKisaoId == Kisao0000529) {
+        return ThreadCountId;
+    }
+
     return {};
 }
 
@@ -190,6 +195,10 @@ QString CVODESolverPlugin::kisaoId(const QString &pId) const
         return "KISAO:0000481";
     }
 
+    if (pId == ThreadCountId) {
+        return "KISAO:0000529";
+    }
+
     return {};
 }
 
@@ -261,6 +270,14 @@ Solver::Properties CVODESolverPlugin::solverProperties() const
                                                                     { "en", QString::fromUtf8("Interpolate solution") },
                                                                     { "fr", QString::fromUtf8("Interpoler solution") }
                                                                 };
+    static const Descriptions RootFindingDescriptions = {
+                                                            { "en", QString::fromUtf8("Root finding") },
+                                                            { "fr", QString::fromUtf8("Recherche de racines") }
+                                                        };
+    static const Descriptions ThreadCountDescriptions = {
+                                                            { "en", QString::fromUtf8("Thread count") },
+                                                            { "fr", QString::fromUtf8("Nombre de threads") }
+                                                        };
     static const QStringList IntegrationMethodListValues = {
                                                                AdamsMoultonMethod,
                                                                BdfMethod
@@ -275,7 +292,8 @@ Solver::Properties CVODESolverPlugin::solverProperties() const
                                                           DiagonalLinearSolver,
                                                           GmresLinearSolver,
                                                           BiCgStabLinearSolver,
-                                                          TfqmrLinearSolver
+                                                          TfqmrLinearSolver,
+                                                          SparseLinearSolver
                                                       };
     static const QStringList PreconditionerListValues = {
                                                             NoPreconditioner,
@@ -292,7 +310,9 @@ Solver::Properties CVODESolverPlugin::solverProperties() const
              Solver::Property(Solver::Property::Type::IntegerGe0, LowerHalfBandwidthId, LowerHalfBandwidthDescriptions, {}, LowerHalfBandwidthDefaultValue, false),
              Solver::Property(Solver::Property::Type::DoubleGe0, RelativeToleranceId, RelativeToleranceDescriptions, {}, RelativeToleranceDefaultValue, false),
              Solver::Property(Solver::Property::Type::DoubleGe0, AbsoluteToleranceId, AbsoluteToleranceDescriptions, {}, AbsoluteToleranceDefaultValue, false),
-             Solver::Property(Solver::Property::Type::Boolean, InterpolateSolutionId, InterpolateSolutionDescriptions, {}, InterpolateSolutionDefaultValue, false) };
+             Solver::Property(Solver::Property::Type::Boolean, InterpolateSolutionId, InterpolateSolutionDescriptions, {}, InterpolateSolutionDefaultValue, false),
+             Solver::Property(Solver::Property::Type::Boolean, RootFindingId, RootFindingDescriptions, {}, RootFindingDefaultValue, false),
+             Solver::Property(Solver::Property::Type::IntegerGt0, ThreadCountId, ThreadCountDescriptions, {}, ThreadCountDefaultValue, false) };
 }
 
 //==============================================================================
@@ -312,8 +332,9 @@ QMap<QString, bool> CVODESolverPlugin::solverPropertiesVisibility(const QMap<QSt
         QString linearSolver = pSolverPropertiesValues.value(LinearSolverId);
 
         if (   (linearSolver == DenseLinearSolver)
-            || (linearSolver == DiagonalLinearSolver)) {
-            // Dense/diagonal linear solver
+            || (linearSolver == DiagonalLinearSolver)
+            || (linearSolver == SparseLinearSolver)) {
+            // Dense/diagonal/sparse linear solver
 
             res.insert(PreconditionerId, false);
             res.insert(UpperHalfBandwidthId, false);
@@ -0,0 +1,431 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver sparse linear solver
+//==============================================================================
+
+#include "cvodesolversparselinearsolver.h"
+
+//==============================================================================
+
+#include <QtMath>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "nvector/nvector_serial.h"
+    #include "sunmatrix/sunmatrix_sparse.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CVODESolver {
+
+//==============================================================================
+
+// Threshold used to decide whether a diagonal entry is large enough to be
+// used as a pivot, in which case it is preferred to the largest entry of its
+// column (so as to preserve the sparsity of our matrix as much as possible)
+
+static const double PivotTolerance = 1.0e-3;
+
+//==============================================================================
+
+SUNLinearSolver CvodeSolverSparseLinearSolver::create(SUNContext pContext)
+{
+    // Create a SUNDIALS linear solver that uses a left-looking sparse LU
+    // factorisation with partial (threshold) pivoting, i.e. the algorithm of
+    // Gilbert and Peierls, which is also what KLU uses
+    // Note: our linear solver expects a square CSC matrix...
+
+    SUNLinearSolver res = SUNLinSolNewEmpty(pContext);
+
+    res->ops->gettype = typeFunction;
+    res->ops->getid = idFunction;
+    res->ops->setup = setupFunction;
+    res->ops->solve = solveFunction;
+    res->ops->free = freeFunction;
+
+    res->content = new CvodeSolverSparseLinearSolver();
+
+    return res;
+}
+
+//==============================================================================
+
+void CvodeSolverSparseLinearSolver::resize(int pSize)
+{
+    // Resize our work arrays, if needed
+
+    if (pSize == mSize) {
+        return;
+    }
+
+    mSize = pSize;
+
+    mPivots.resize(pSize);
+
+    mLowerColumnPointers.resize(pSize+1);
+    mUpperColumnPointers.resize(pSize+1);
+
+    mValues.fill(0.0, pSize);
+    mRows.resize(pSize);
+    mStack.resize(pSize);
+    mStackPositions.resize(pSize);
+    mMarked.fill(false, pSize);
+
+    mSolution.resize(pSize);
+}
+
+//==============================================================================
+
+int CvodeSolverSparseLinearSolver::reach(const sunindextype *pColumnPointers,
+                                         const sunindextype *pRowIndices,
+                                         int pColumn)
+{
+    // Determine the rows that will be non-zero once we have solved L*x = b,
+    // with b the given column of our matrix, and return them in topological
+    // order in mRows[top..mSize-1]
+    // Note: this is done using a non-recursive depth-first search of the graph
+    //       of L, which means that the cost of solving L*x = b is proportional
+    //       to the number of floating point operations involved rather than
+    //       to the size of our matrix...
+
+    const int *pivots = mPivots.constData();
+    const int *lowerColumnPointers = mLowerColumnPointers.constData();
+    const int *lowerRowIndices = mLowerRowIndices.constData();
+    int *rows = mRows.data();
+    int *stack = mStack.data();
+    int *stackPositions = mStackPositions.data();
+    bool *marked = mMarked.data();
+    int top = mSize;
+
+    for (sunindextype i = pColumnPointers[pColumn], iMax = pColumnPointers[pColumn+1];
+         i < iMax; ++i) {
+        int row = int(pRowIndices[i]);
+
+        if (marked[row]) {
+            continue;
+        }
+
+        int head = 0;
+
+        stack[0] = row;
+
+        while (head >= 0) {
+            int node = stack[head];
+            int lowerColumn = pivots[node];
+
+            if (!marked[node]) {
+                marked[node] = true;
+
+                stackPositions[head] = (lowerColumn < 0)?0:lowerColumnPointers[lowerColumn];
+            }
+
+            bool done = true;
+
+            if (lowerColumn >= 0) {
+                for (int j = stackPositions[head], jMax = lowerColumnPointers[lowerColumn+1];
+                     j < jMax; ++j) {
+                    int child = lowerRowIndices[j];
+
+                    if (!marked[child]) {
+                        stackPositions[head] = j+1;
+                        stack[++head] = child;
+
+                        done = false;
+
+                        break;
+                    }
+                }
+            }
+
+            if (done) {
+                --head;
+
+                rows[--top] = node;
+            }
+        }
+    }
+
+    for (int i = top; i < mSize; ++i) {
+        marked[rows[i]] = false;
+    }
+
+    return top;
+}
+
+//==============================================================================
+
+bool CvodeSolverSparseLinearSolver::factorize(SUNMatrix pMatrix)
+{
+    // Factorise our matrix, i.e. compute P*A = L*U, one column at a time
+
+    int size = int(SM_COLUMNS_S(pMatrix));
+    const sunindextype *columnPointers = SM_INDEXPTRS_S(pMatrix);
+    const sunindextype *rowIndices = SM_INDEXVALS_S(pMatrix);
+    const double *matrixValues = SM_DATA_S(pMatrix);
+
+    resize(size);
+
+    mPivots.fill(-1);
+
+    mLowerRowIndices.clear();
+    mLowerValues.clear();
+    mUpperRowIndices.clear();
+    mUpperValues.clear();
+
+    int *pivots = mPivots.data();
+    int *lowerColumnPointers = mLowerColumnPointers.data();
+    int *upperColumnPointers = mUpperColumnPointers.data();
+    double *values = mValues.data();
+    const int *rows = mRows.constData();
+
+    for (int k = 0; k < size; ++k) {
+        lowerColumnPointers[k] = mLowerRowIndices.count();
+        upperColumnPointers[k] = mUpperRowIndices.count();
+
+        // Solve L*x = A(:,k), knowing that x is non-zero only for
+        // mRows[top..size-1]
+
+        int top = reach(columnPointers, rowIndices, k);
+
+        for (sunindextype i = columnPointers[k], iMax = columnPointers[k+1];
+             i < iMax; ++i) {
+            values[rowIndices[i]] = matrixValues[i];
+        }
+
+        const int *lowerRowIndices = mLowerRowIndices.constData();
+        const double *lowerValues = mLowerValues.constData();
+
+        for (int i = top; i < size; ++i) {
+            int row = rows[i];
+            int lowerColumn = pivots[row];
+
+            if (lowerColumn < 0) {
+                continue;
+            }
+
+            double value = values[row];
+
+            for (int j = lowerColumnPointers[lowerColumn]+1, jMax = lowerColumnPointers[lowerColumn+1];
+                 j < jMax; ++j) {
+                values[lowerRowIndices[j]] -= lowerValues[j]*value;
+            }
+        }
+
+        // Keep track of the entries of U and look for our pivot, i.e. the
+        // largest entry in a row that hasn't yet been pivoted, unless our
+        // diagonal entry is large enough
+
+        int pivotRow = -1;
+        double pivotMagnitude = -1.0;
+
+        for (int i = top; i < size; ++i) {
+            int row = rows[i];
+
+            if (pivots[row] < 0) {
+                double magnitude = qFabs(values[row]);
+
+                if (magnitude > pivotMagnitude) {
+                    pivotRow = row;
+                    pivotMagnitude = magnitude;
+                }
+            } else {
+                mUpperRowIndices << pivots[row];
+                mUpperValues << values[row];
+            }
+        }
+
+        if ((pivotRow == -1) || qIsNull(pivotMagnitude)) {
+            // Our matrix is (numerically) singular, so reset our work array
+            // and leave
+
+            for (int i = top; i < size; ++i) {
+                values[rows[i]] = 0.0;
+            }
+
+            return false;
+        }
+
+        if (   (pivots[k] < 0)
+            && (qFabs(values[k]) >= PivotTolerance*pivotMagnitude)) {
+            pivotRow = k;
+        }
+
+        double pivot = values[pivotRow];
+
+        mUpperRowIndices << k;
+        mUpperValues << pivot;
+
+        pivots[pivotRow] = k;
+
+        // Keep track of the entries of L, which has a unit diagonal, and reset
+        // our work array
+
+        mLowerRowIndices << pivotRow;
+        mLowerValues << 1.0;
+
+        for (int i = top; i < size; ++i) {
+            int row = rows[i];
+
+            if (pivots[row] < 0) {
+                mLowerRowIndices << row;
+                mLowerValues << values[row]/pivot;
+            }
+
+            values[row] = 0.0;
+        }
+    }
+
+    lowerColumnPointers[size] = mLowerRowIndices.count();
+    upperColumnPointers[size] = mUpperRowIndices.count();
+
+    // Renumber the rows of L so that they refer to our pivoted rows
+
+    for (auto &lowerRowIndex : mLowerRowIndices) {
+        lowerRowIndex = pivots[lowerRowIndex];
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+void CvodeSolverSparseLinearSolver::solve(double *pX, const double *pB)
+{
+    // Solve A*x = b, i.e. L*U*x = P*b
+
+    const int *pivots = mPivots.constData();
+    const int *lowerColumnPointers = mLowerColumnPointers.constData();
+    const int *lowerRowIndices = mLowerRowIndices.constData();
+    const double *lowerValues = mLowerValues.constData();
+    const int *upperColumnPointers = mUpperColumnPointers.constData();
+    const int *upperRowIndices = mUpperRowIndices.constData();
+    const double *upperValues = mUpperValues.constData();
+    double *solution = mSolution.data();
+
+    for (int i = 0; i < mSize; ++i) {
+        solution[pivots[i]] = pB[i];
+    }
+
+    for (int i = 0; i < mSize; ++i) {
+        double value = solution[i];
+
+        for (int j = lowerColumnPointers[i]+1, jMax = lowerColumnPointers[i+1];
+             j < jMax; ++j) {
+            solution[lowerRowIndices[j]] -= lowerValues[j]*value;
+        }
+    }
+
+    for (int i = mSize-1; i >= 0; --i) {
+        int diagonal = upperColumnPointers[i+1]-1;
+
+        solution[i] /= upperValues[diagonal];
+
+        double value = solution[i];
+
+        for (int j = upperColumnPointers[i]; j < diagonal; ++j) {
+            solution[upperRowIndices[j]] -= upperValues[j]*value;
+        }
+    }
+
+    memcpy(pX, solution, size_t(mSize)*sizeof(double));
+}
+
+//==============================================================================
+
+SUNLinearSolver_Type CvodeSolverSparseLinearSolver::typeFunction(SUNLinearSolver pLinearSolver)
+{
+    Q_UNUSED(pLinearSolver)
+
+    // We are a direct linear solver
+
+    return SUNLINEARSOLVER_DIRECT;
+}
+
+//==============================================================================
+
+SUNLinearSolver_ID CvodeSolverSparseLinearSolver::idFunction(SUNLinearSolver pLinearSolver)
+{
+    Q_UNUSED(pLinearSolver)
+
+    // We are a custom linear solver
+
+    return SUNLINEARSOLVER_CUSTOM;
+}
+
+//==============================================================================
+
+int CvodeSolverSparseLinearSolver::setupFunction(SUNLinearSolver pLinearSolver,
+                                                 SUNMatrix pMatrix)
+{
+    // Factorise the given matrix
+    // Note: a failed factorisation is a recoverable failure, i.e. CVODES will
+    //       try again with a smaller step...
+
+    return static_cast<CvodeSolverSparseLinearSolver *>(pLinearSolver->content)->factorize(pMatrix)?
+               SUNLS_SUCCESS:
+               SUNLS_LUFACT_FAIL;
+}
+
+//==============================================================================
+
+int CvodeSolverSparseLinearSolver::solveFunction(SUNLinearSolver pLinearSolver,
+                                                 SUNMatrix pMatrix, N_Vector pX,
+                                                 N_Vector pB, double pTolerance)
+{
+    Q_UNUSED(pMatrix)
+    Q_UNUSED(pTolerance)
+
+    // Solve our linear system using our factorised matrix
+
+    static_cast<CvodeSolverSparseLinearSolver *>(pLinearSolver->content)->solve(N_VGetArrayPointer_Serial(pX),
+                                                                                N_VGetArrayPointer_Serial(pB));
+
+    return SUNLS_SUCCESS;
+}
+
+//==============================================================================
+
+int CvodeSolverSparseLinearSolver::freeFunction(SUNLinearSolver pLinearSolver)
+{
+    // Delete our linear solver
+
+    if (pLinearSolver != nullptr) {
+        delete static_cast<CvodeSolverSparseLinearSolver *>(pLinearSolver->content);
+
+        pLinearSolver->content = nullptr;
+
+        SUNLinSolFreeEmpty(pLinearSolver);
+    }
+
+    return SUNLS_SUCCESS;
+}
+
+//==============================================================================
+
+} // namespace CVODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
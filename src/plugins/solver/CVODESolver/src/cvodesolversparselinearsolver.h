@@ -0,0 +1,94 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver sparse linear solver
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include <QVector>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "sundials/sundials_linearsolver.h"
+    #include "sundials/sundials_matrix.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CVODESolver {
+
+//==============================================================================
+
+class CvodeSolverSparseLinearSolver
+{
+public:
+    static SUNLinearSolver create(SUNContext pContext);
+
+private:
+    int mSize = 0;
+
+    QVector<int> mPivots;
+
+    QVector<int> mLowerColumnPointers;
+    QVector<int> mLowerRowIndices;
+    QVector<double> mLowerValues;
+
+    QVector<int> mUpperColumnPointers;
+    QVector<int> mUpperRowIndices;
+    QVector<double> mUpperValues;
+
+    QVector<double> mValues;
+    QVector<int> mRows;
+    QVector<int> mStack;
+    QVector<int> mStackPositions;
+    QVector<bool> mMarked;
+
+    QVector<double> mSolution;
+
+    void resize(int pSize);
+
+    int reach(const sunindextype *pColumnPointers,
+              const sunindextype *pRowIndices, int pColumn);
+
+    bool factorize(SUNMatrix pMatrix);
+    void solve(double *pX, const double *pB);
+
+    static SUNLinearSolver_Type typeFunction(SUNLinearSolver pLinearSolver);
+    static SUNLinearSolver_ID idFunction(SUNLinearSolver pLinearSolver);
+    static int setupFunction(SUNLinearSolver pLinearSolver,
+                             SUNMatrix pMatrix);
+    static int solveFunction(SUNLinearSolver pLinearSolver, SUNMatrix pMatrix,
+                             N_Vector pX, N_Vector pB, double pTolerance);
+    static int freeFunction(SUNLinearSolver pLinearSolver);
+};
+
+//==============================================================================
+
+} // namespace CVODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
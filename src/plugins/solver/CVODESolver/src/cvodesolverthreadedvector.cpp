@@ -0,0 +1,475 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver threaded vector
+//==============================================================================
+
+#include "cvodesolverthreadedvector.h"
+
+//==============================================================================
+
+#include <QThread>
+#include <QtMath>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "nvector/nvector_serial.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CVODESolver {
+
+//==============================================================================
+
+// Minimum number of entries that each of our threads should have to deal with
+// for it to be worth sharing an operation between them
+
+static const sunindextype MinimumChunkLength = 4096;
+
+//==============================================================================
+
+// Threaded vector to be used by the calling thread
+// Note: our vector operations don't get any user data, so we rely on the
+//       calling thread (i.e. the one that runs CVODES) to tell us which
+//       threaded vector to use (see activate())...
+
+static thread_local CvodeSolverThreadedVector *currentThreadedVector = nullptr;
+
+//==============================================================================
+
+CvodeSolverThreadedVector::CvodeSolverThreadedVector(int pThreadCount) :
+    mThreadCount(qMax(pThreadCount, 1)),
+    mPartialResults(mThreadCount)
+{
+    // Create and start our worker threads
+    // Note: the calling thread is our first thread, hence we only need to
+    //       create mThreadCount-1 threads...
+
+    for (int i = 1; i < mThreadCount; ++i) {
+        QThread *thread = QThread::create([this, i]() {
+            work(i);
+        });
+
+        thread->start();
+
+        mThreads << thread;
+    }
+}
+
+//==============================================================================
+
+CvodeSolverThreadedVector::~CvodeSolverThreadedVector()
+{
+    // Ask our worker threads to stop and wait for them to have done so
+
+    mMutex.lock();
+        mStopping = true;
+
+        mStartCondition.wakeAll();
+    mMutex.unlock();
+
+    for (auto thread : qAsConst(mThreads)) {
+        thread->wait();
+
+        delete thread;
+    }
+
+    // Make sure that the calling thread doesn't use us anymore
+
+    if (currentThreadedVector == this) {
+        currentThreadedVector = nullptr;
+    }
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::install(N_Vector pVector) const
+{
+    // Replace the element-wise and reduction operations of the given (serial)
+    // vector with our threaded versions
+    // Note: CVODES creates its internal vectors by cloning the vector it is
+    //       given, and cloning a vector also clones its operations, so all of
+    //       CVODES' vectors end up using our threaded operations...
+
+    pVector->ops->nvlinearsum = linearSumFunction;
+    pVector->ops->nvconst = constFunction;
+    pVector->ops->nvprod = prodFunction;
+    pVector->ops->nvdiv = divFunction;
+    pVector->ops->nvscale = scaleFunction;
+    pVector->ops->nvabs = absFunction;
+    pVector->ops->nvinv = invFunction;
+    pVector->ops->nvaddconst = addConstFunction;
+    pVector->ops->nvdotprod = dotProdFunction;
+    pVector->ops->nvmaxnorm = maxNormFunction;
+    pVector->ops->nvwrmsnorm = wrmsNormFunction;
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::activate()
+{
+    // Let our threaded operations know that they should use us when called
+    // from the calling thread
+
+    currentThreadedVector = this;
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::work(int pThread)
+{
+    // Wait for some work to be available and carry it out, until we are asked
+    // to stop
+
+    quint64 generation = 0;
+
+    forever {
+        mMutex.lock();
+            while ((mGeneration == generation) && !mStopping) {
+                mStartCondition.wait(&mMutex);
+            }
+
+            if (mStopping) {
+                mMutex.unlock();
+
+                return;
+            }
+
+            generation = mGeneration;
+        mMutex.unlock();
+
+        runChunk(pThread);
+
+        mMutex.lock();
+            if (--mPendingThreadsCount == 0) {
+                mDoneCondition.wakeOne();
+            }
+        mMutex.unlock();
+    }
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::runChunk(int pThread) const
+{
+    // Run our current task on the chunk of entries that corresponds to the
+    // given thread
+
+    (*mTask)(pThread, mLength*pThread/mThreadCount,
+             mLength*(pThread+1)/mThreadCount);
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::run(sunindextype pLength, const Task &pTask)
+{
+    // Share the given task between our worker threads and ourselves, and wait
+    // for all of them to be done
+
+    mMutex.lock();
+        mTask = &pTask;
+        mLength = pLength;
+        mPendingThreadsCount = mThreadCount-1;
+
+        ++mGeneration;
+
+        mStartCondition.wakeAll();
+    mMutex.unlock();
+
+    runChunk(0);
+
+    mMutex.lock();
+        while (mPendingThreadsCount != 0) {
+            mDoneCondition.wait(&mMutex);
+        }
+    mMutex.unlock();
+}
+
+//==============================================================================
+
+CvodeSolverThreadedVector * CvodeSolverThreadedVector::current(sunindextype pLength)
+{
+    // Return the threaded vector to use for an operation on the given number of
+    // entries, if it is worth using one
+
+    if (   (currentThreadedVector == nullptr)
+        || (pLength < currentThreadedVector->mThreadCount*MinimumChunkLength)) {
+        return nullptr;
+    }
+
+    return currentThreadedVector;
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::forEach(sunindextype pLength,
+                                        const Task &pTask)
+{
+    // Carry out the given task on all our entries, sharing it between our
+    // threads if possible
+
+    CvodeSolverThreadedVector *threadedVector = current(pLength);
+
+    if (threadedVector == nullptr) {
+        pTask(0, 0, pLength);
+    } else {
+        threadedVector->run(pLength, pTask);
+    }
+}
+
+//==============================================================================
+
+double CvodeSolverThreadedVector::reduce(sunindextype pLength,
+                                         const Reduction &pReduction,
+                                         bool pMaximum)
+{
+    // Carry out the given reduction on all our entries, sharing it between our
+    // threads if possible, and combine their partial results
+
+    CvodeSolverThreadedVector *threadedVector = current(pLength);
+
+    if (threadedVector == nullptr) {
+        return pReduction(0, pLength);
+    }
+
+    threadedVector->run(pLength, [threadedVector, &pReduction](int pThread, sunindextype pFrom, sunindextype pTo) {
+        threadedVector->mPartialResults[pThread] = pReduction(pFrom, pTo);
+    });
+
+    double res = threadedVector->mPartialResults[0];
+
+    for (int i = 1; i < threadedVector->mThreadCount; ++i) {
+        res = pMaximum?
+                  qMax(res, threadedVector->mPartialResults[i]):
+                  res+threadedVector->mPartialResults[i];
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::linearSumFunction(double pA, N_Vector pX,
+                                                  double pB, N_Vector pY,
+                                                  N_Vector pZ)
+{
+    // Compute z = a*x+b*y
+
+    double *x = NV_DATA_S(pX);
+    double *y = NV_DATA_S(pY);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = pA*x[i]+pB*y[i];
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::constFunction(double pC, N_Vector pZ)
+{
+    // Compute z = c
+
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = pC;
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::prodFunction(N_Vector pX, N_Vector pY,
+                                             N_Vector pZ)
+{
+    // Compute z = x*y
+
+    double *x = NV_DATA_S(pX);
+    double *y = NV_DATA_S(pY);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = x[i]*y[i];
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::divFunction(N_Vector pX, N_Vector pY,
+                                            N_Vector pZ)
+{
+    // Compute z = x/y
+
+    double *x = NV_DATA_S(pX);
+    double *y = NV_DATA_S(pY);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = x[i]/y[i];
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::scaleFunction(double pC, N_Vector pX,
+                                              N_Vector pZ)
+{
+    // Compute z = c*x
+
+    double *x = NV_DATA_S(pX);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = pC*x[i];
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::absFunction(N_Vector pX, N_Vector pZ)
+{
+    // Compute z = |x|
+
+    double *x = NV_DATA_S(pX);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = qFabs(x[i]);
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::invFunction(N_Vector pX, N_Vector pZ)
+{
+    // Compute z = 1/x
+
+    double *x = NV_DATA_S(pX);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = 1.0/x[i];
+        }
+    });
+}
+
+//==============================================================================
+
+void CvodeSolverThreadedVector::addConstFunction(N_Vector pX, double pB,
+                                                 N_Vector pZ)
+{
+    // Compute z = x+b
+
+    double *x = NV_DATA_S(pX);
+    double *z = NV_DATA_S(pZ);
+
+    forEach(NV_LENGTH_S(pZ), [=](int, sunindextype pFrom, sunindextype pTo) {
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            z[i] = x[i]+pB;
+        }
+    });
+}
+
+//==============================================================================
+
+double CvodeSolverThreadedVector::dotProdFunction(N_Vector pX, N_Vector pY)
+{
+    // Compute sum(x*y)
+
+    double *x = NV_DATA_S(pX);
+    double *y = NV_DATA_S(pY);
+
+    return reduce(NV_LENGTH_S(pX), [=](sunindextype pFrom, sunindextype pTo) {
+        double res = 0.0;
+
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            res += x[i]*y[i];
+        }
+
+        return res;
+    }, false);
+}
+
+//==============================================================================
+
+double CvodeSolverThreadedVector::maxNormFunction(N_Vector pX)
+{
+    // Compute max(|x|)
+
+    double *x = NV_DATA_S(pX);
+
+    return reduce(NV_LENGTH_S(pX), [=](sunindextype pFrom, sunindextype pTo) {
+        double res = 0.0;
+
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            res = qMax(res, qFabs(x[i]));
+        }
+
+        return res;
+    }, true);
+}
+
+//==============================================================================
+
+double CvodeSolverThreadedVector::wrmsNormFunction(N_Vector pX, N_Vector pW)
+{
+    // Compute sqrt(sum((x*w)^2)/n)
+
+    double *x = NV_DATA_S(pX);
+    double *w = NV_DATA_S(pW);
+    sunindextype length = NV_LENGTH_S(pX);
+
+    return qSqrt(reduce(length, [=](sunindextype pFrom, sunindextype pTo) {
+        double res = 0.0;
+
+        for (sunindextype i = pFrom; i < pTo; ++i) {
+            double xw = x[i]*w[i];
+
+            res += xw*xw;
+        }
+
+        return res;
+    }, false)/double(length));
+}
+
+//==============================================================================
+
+} // namespace CVODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,116 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver threaded vector
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include <QList>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+
+//==============================================================================
+
+#include <functional>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "sundials/sundials_nvector.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+class QThread;
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CVODESolver {
+
+//==============================================================================
+
+class CvodeSolverThreadedVector
+{
+public:
+    explicit CvodeSolverThreadedVector(int pThreadCount);
+    ~CvodeSolverThreadedVector();
+
+    void install(N_Vector pVector) const;
+    void activate();
+
+private:
+    using Task = std::function<void(int pThread, sunindextype pFrom, sunindextype pTo)>;
+    using Reduction = std::function<double(sunindextype pFrom, sunindextype pTo)>;
+
+    int mThreadCount;
+
+    QList<QThread *> mThreads;
+
+    QMutex mMutex;
+    QWaitCondition mStartCondition;
+    QWaitCondition mDoneCondition;
+
+    quint64 mGeneration = 0;
+    int mPendingThreadsCount = 0;
+    bool mStopping = false;
+
+    const Task *mTask = nullptr;
+    sunindextype mLength = 0;
+
+    QVector<double> mPartialResults;
+
+    void work(int pThread);
+
+    void runChunk(int pThread) const;
+    void run(sunindextype pLength, const Task &pTask);
+
+    static CvodeSolverThreadedVector * current(sunindextype pLength);
+
+    static void forEach(sunindextype pLength, const Task &pTask);
+    static double reduce(sunindextype pLength, const Reduction &pReduction,
+                         bool pMaximum);
+
+    static void linearSumFunction(double pA, N_Vector pX, double pB,
+                                  N_Vector pY, N_Vector pZ);
+    static void constFunction(double pC, N_Vector pZ);
+    static void prodFunction(N_Vector pX, N_Vector pY, N_Vector pZ);
+    static void divFunction(N_Vector pX, N_Vector pY, N_Vector pZ);
+    static void scaleFunction(double pC, N_Vector pX, N_Vector pZ);
+    static void absFunction(N_Vector pX, N_Vector pZ);
+    static void invFunction(N_Vector pX, N_Vector pZ);
+    static void addConstFunction(N_Vector pX, double pB, N_Vector pZ);
+    static double dotProdFunction(N_Vector pX, N_Vector pY);
+    static double maxNormFunction(N_Vector pX);
+    static double wrmsNormFunction(N_Vector pX, N_Vector pW);
+};
+
+//==============================================================================
+
+} // namespace CVODESolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
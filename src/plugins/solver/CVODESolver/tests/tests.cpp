@@ -0,0 +1,189 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CVODE solver tests
+//==============================================================================
+
+#include "cvodesolversparselinearsolver.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "nvector/nvector_serial.h"
+    #include "sunlinsol/sunlinsol_dense.h"
+    #include "sunmatrix/sunmatrix_dense.h"
+    #include "sunmatrix/sunmatrix_sparse.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+void Tests::sparseLinearSolverTest(int pSize, const QVector<double> &pMatrix)
+{
+    // Solve A*x = b, with A the given (row-major) matrix, using both our sparse
+    // linear solver and the dense linear solver of SUNDIALS, and make sure that
+    // we get the same solution
+    // Note: the dense linear solver factorises its matrix in place, so we must
+    //       create our sparse matrix from our dense matrix beforehand...
+
+    SUNContext context;
+
+    SUNContext_Create(nullptr, &context);
+
+    SUNMatrix denseMatrix = SUNDenseMatrix(pSize, pSize, context);
+
+    for (int i = 0; i < pSize; ++i) {
+        for (int j = 0; j < pSize; ++j) {
+            SM_ELEMENT_D(denseMatrix, i, j) = pMatrix[i*pSize+j];
+        }
+    }
+
+    SUNMatrix sparseMatrix = SUNSparseFromDenseMatrix(denseMatrix, 0.0, CSC_MAT);
+
+    N_Vector b = N_VNew_Serial(pSize, context);
+    N_Vector denseX = N_VNew_Serial(pSize, context);
+    N_Vector sparseX = N_VNew_Serial(pSize, context);
+    double *bData = N_VGetArrayPointer_Serial(b);
+
+    for (int i = 0; i < pSize; ++i) {
+        bData[i] = i+1.0;
+    }
+
+    SUNLinearSolver denseLinearSolver = SUNLinSol_Dense(denseX, denseMatrix, context);
+    SUNLinearSolver sparseLinearSolver = OpenCOR::CVODESolver::CvodeSolverSparseLinearSolver::create(context);
+
+    QCOMPARE(SUNLinSolSetup(denseLinearSolver, denseMatrix), SUNLS_SUCCESS);
+    QCOMPARE(SUNLinSolSolve(denseLinearSolver, denseMatrix, denseX, b, 0.0), SUNLS_SUCCESS);
+
+    QCOMPARE(SUNLinSolSetup(sparseLinearSolver, sparseMatrix), SUNLS_SUCCESS);
+    QCOMPARE(SUNLinSolSolve(sparseLinearSolver, sparseMatrix, sparseX, b, 0.0), SUNLS_SUCCESS);
+
+    // Make sure that b hasn't been modified and that both solutions are the
+    // same
+
+    const double *denseXData = N_VGetArrayPointer_Serial(denseX);
+    const double *sparseXData = N_VGetArrayPointer_Serial(sparseX);
+
+    for (int i = 0; i < pSize; ++i) {
+        QCOMPARE(bData[i], i+1.0);
+        QVERIFY(qAbs(sparseXData[i]-denseXData[i]) <= 1.0e-12*qMax(1.0, qAbs(denseXData[i])));
+    }
+
+    // Solve A*x = b a second time, making sure that our factorisation can be
+    // reused
+
+    N_VConst(0.0, sparseX);
+
+    QCOMPARE(SUNLinSolSolve(sparseLinearSolver, sparseMatrix, sparseX, b, 0.0), SUNLS_SUCCESS);
+
+    for (int i = 0; i < pSize; ++i) {
+        QVERIFY(qAbs(sparseXData[i]-denseXData[i]) <= 1.0e-12*qMax(1.0, qAbs(denseXData[i])));
+    }
+
+    // Clean up after ourselves
+
+    SUNLinSolFree(sparseLinearSolver);
+    SUNLinSolFree(denseLinearSolver);
+
+    N_VDestroy_Serial(sparseX);
+    N_VDestroy_Serial(denseX);
+    N_VDestroy_Serial(b);
+
+    SUNMatDestroy(sparseMatrix);
+    SUNMatDestroy(denseMatrix);
+
+    SUNContext_Free(&context);
+}
+
+//==============================================================================
+
+void Tests::sparseLinearSolverTests()
+{
+    // Diagonally dominant matrix, i.e. one that doesn't need pivoting
+
+    sparseLinearSolverTest(4, { 4.0, 1.0, 0.0, 0.0,
+                                1.0, 4.0, 1.0, 0.0,
+                                0.0, 1.0, 4.0, 1.0,
+                                0.0, 0.0, 1.0, 4.0 });
+
+    // Matrix with a zero diagonal, i.e. one that needs pivoting
+
+    sparseLinearSolverTest(4, { 0.0, 2.0, 0.0, 1.0,
+                                3.0, 0.0, 1.0, 0.0,
+                                0.0, 1.0, 4.0, 0.0,
+                                1.0, 0.0, 0.0, 5.0 });
+
+    // Matrix with a diagonal entry that is too small to be used as a pivot
+
+    sparseLinearSolverTest(3, { 1.0e-6, 1.0, 0.0,
+                                1.0,    1.0, 2.0,
+                                0.0,    3.0, 1.0 });
+
+    // Matrix with some fill-in and an empty diagonal entry
+
+    sparseLinearSolverTest(5, { 2.0, 0.0, 0.0, 1.0,  0.0,
+                                0.0, 0.0, 3.0, 0.0,  1.0,
+                                1.0, 2.0, 0.0, 0.0,  0.0,
+                                0.0, 1.0, 0.0, 4.0, -1.0,
+                                5.0, 0.0, 1.0, 0.0,  2.0 });
+}
+
+//==============================================================================
+
+void Tests::singularSparseLinearSolverTests()
+{
+    // Make sure that the factorisation of a singular matrix fails in a
+    // recoverable way
+
+    SUNContext context;
+
+    SUNContext_Create(nullptr, &context);
+
+    SUNMatrix denseMatrix = SUNDenseMatrix(2, 2, context);
+
+    SM_ELEMENT_D(denseMatrix, 0, 0) = 1.0;
+    SM_ELEMENT_D(denseMatrix, 0, 1) = 2.0;
+    SM_ELEMENT_D(denseMatrix, 1, 0) = 2.0;
+    SM_ELEMENT_D(denseMatrix, 1, 1) = 4.0;
+
+    SUNMatrix sparseMatrix = SUNSparseFromDenseMatrix(denseMatrix, 0.0, CSC_MAT);
+    SUNLinearSolver sparseLinearSolver = OpenCOR::CVODESolver::CvodeSolverSparseLinearSolver::create(context);
+
+    QCOMPARE(SUNLinSolSetup(sparseLinearSolver, sparseMatrix), SUNLS_LUFACT_FAIL);
+
+    SUNLinSolFree(sparseLinearSolver);
+
+    SUNMatDestroy(sparseMatrix);
+    SUNMatDestroy(denseMatrix);
+
+    SUNContext_Free(&context);
+}
+
+//==============================================================================
+
+QTEST_GUILESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================
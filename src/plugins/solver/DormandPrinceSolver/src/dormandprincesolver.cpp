@@ -0,0 +1,463 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Dormand-Prince solver
+//==============================================================================
+
+#include "dormandprincesolver.h"
+
+//==============================================================================
+
+#include <QtMath>
+
+//==============================================================================
+
+#include <limits>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace DormandPrinceSolver {
+
+//==============================================================================
+
+// Coefficients of the Dormand-Prince 5(4) method, as well as those of its
+// error estimate and of its dense output (see E. Hairer, S.P. Nørsett and G.
+// Wanner, "Solving Ordinary Differential Equations I", 2nd edition, Springer,
+// 1993)
+
+static const double C2 = 1.0/5.0;
+static const double C3 = 3.0/10.0;
+static const double C4 = 4.0/5.0;
+static const double C5 = 8.0/9.0;
+
+static const double A21 = 1.0/5.0;
+static const double A31 = 3.0/40.0;
+static const double A32 = 9.0/40.0;
+static const double A41 = 44.0/45.0;
+static const double A42 = -56.0/15.0;
+static const double A43 = 32.0/9.0;
+static const double A51 = 19372.0/6561.0;
+static const double A52 = -25360.0/2187.0;
+static const double A53 = 64448.0/6561.0;
+static const double A54 = -212.0/729.0;
+static const double A61 = 9017.0/3168.0;
+static const double A62 = -355.0/33.0;
+static const double A63 = 46732.0/5247.0;
+static const double A64 = 49.0/176.0;
+static const double A65 = -5103.0/18656.0;
+static const double A71 = 35.0/384.0;
+static const double A73 = 500.0/1113.0;
+static const double A74 = 125.0/192.0;
+static const double A75 = -2187.0/6784.0;
+static const double A76 = 11.0/84.0;
+
+static const double E1 = 71.0/57600.0;
+static const double E3 = -71.0/16695.0;
+static const double E4 = 71.0/1920.0;
+static const double E5 = -17253.0/339200.0;
+static const double E6 = 22.0/525.0;
+static const double E7 = -1.0/40.0;
+
+static const double D1 = -12715105075.0/11282082432.0;
+static const double D3 = 87487479700.0/32700410799.0;
+static const double D4 = -10690763975.0/1880347072.0;
+static const double D5 = 701980252875.0/199316789632.0;
+static const double D6 = -1453857185.0/822651844.0;
+static const double D7 = 69997945.0/29380423.0;
+
+// Step size control parameters
+
+static const double SafetyFactor = 0.9;
+static const double MinimumStepFactor = 0.2;
+static const double MaximumStepFactor = 10.0;
+
+//==============================================================================
+
+DormandPrinceSolver::~DormandPrinceSolver()
+{
+    // Delete some internal objects
+
+    delete[] mData;
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::initialize(double pVoi, int pRatesStatesCount,
+                                     double *pConstants, double *pRates,
+                                     double *pStates, double *pAlgebraic,
+                                     ComputeRatesFunction pComputeRates)
+{
+    // Retrieve the solver's properties
+
+    if (mProperties.contains(MaximumStepId)) {
+        mMaximumStep = mProperties.value(MaximumStepId).toDouble();
+    } else {
+        emit error(tr(R"(the "Maximum step" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(MaximumNumberOfStepsId)) {
+        mMaximumNumberOfSteps = mProperties.value(MaximumNumberOfStepsId).toInt();
+    } else {
+        emit error(tr(R"(the "Maximum number of steps" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(RelativeToleranceId)) {
+        mRelativeTolerance = mProperties.value(RelativeToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Relative tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(AbsoluteToleranceId)) {
+        mAbsoluteTolerance = mProperties.value(AbsoluteToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Absolute tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(InterpolateSolutionId)) {
+        mInterpolateSolution = mProperties.value(InterpolateSolutionId).toBool();
+    } else {
+        emit error(tr(R"(the "Interpolate solution" property value could not be retrieved)"));
+
+        return;
+    }
+
+    // Initialise the ODE solver itself
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // (Re)create our various arrays
+    // Note: we allocate all of them at once, and then have each of them point
+    //       to its own part of that allocation...
+
+    delete[] mData;
+
+    mData = new double[15*pRatesStatesCount] {};
+
+    double **arrays[] = { &mY, &mYNew, &mYStage,
+                          &mK1, &mK2, &mK3, &mK4, &mK5, &mK6, &mK7,
+                          &mDense1, &mDense2, &mDense3, &mDense4, &mDense5 };
+    double *array = mData;
+
+    for (auto arrayPointer : arrays) {
+        *arrayPointer = array;
+
+        array += pRatesStatesCount;
+    }
+
+    // We need to (re)start our integration
+
+    reinitialize(pVoi);
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::reinitialize(double pVoi)
+{
+    // Our states may have been modified, so we need to restart our integration
+    // from them
+
+    mVoi = pVoi;
+    mNeedRestart = true;
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::restart(double pVoi) const
+{
+    // Start our integration from our current states, i.e. compute f(t_0, Y_0)
+    // and estimate our initial step (see Hairer et al.)
+
+    mVoi = pVoi;
+    mPreviousVoi = pVoi;
+    mPreviousStep = 0.0;
+
+    memcpy(mY, mStates, size_t(mRatesStatesCount)*Solver::SizeOfDouble);
+
+    mComputeRates(mVoi, mConstants, mK1, mY, mAlgebraic);
+
+    double statesNorm = 0.0;
+    double ratesNorm = 0.0;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        double scale = mAbsoluteTolerance+mRelativeTolerance*qFabs(mY[i]);
+
+        statesNorm += (mY[i]/scale)*(mY[i]/scale);
+        ratesNorm += (mK1[i]/scale)*(mK1[i]/scale);
+    }
+
+    double step = ((statesNorm <= 1.0e-10) || (ratesNorm <= 1.0e-10))?
+                      1.0e-6:
+                      0.01*sqrt(statesNorm/ratesNorm);
+
+    if (mMaximumStep > 0.0) {
+        step = qMin(step, mMaximumStep);
+    }
+
+    // Take an explicit Euler step and use it to estimate the second derivative
+    // of our solution
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+step*mK1[i];
+    }
+
+    mComputeRates(mVoi+step, mConstants, mK2, mYStage, mAlgebraic);
+
+    double secondDerivativeNorm = 0.0;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        double scale = mAbsoluteTolerance+mRelativeTolerance*qFabs(mY[i]);
+        double value = (mK2[i]-mK1[i])/scale;
+
+        secondDerivativeNorm += value*value;
+    }
+
+    secondDerivativeNorm = sqrt(secondDerivativeNorm/mRatesStatesCount)/step;
+
+    double derivativesNorm = qMax(secondDerivativeNorm, sqrt(ratesNorm/mRatesStatesCount));
+
+    mStep = qMin(100.0*step,
+                 (derivativesNorm <= 1.0e-15)?
+                     qMax(1.0e-6, 1.0e-3*step):
+                     pow(0.01/derivativesNorm, 0.2));
+
+    if (mMaximumStep > 0.0) {
+        mStep = qMin(mStep, mMaximumStep);
+    }
+
+    mNeedRestart = false;
+}
+
+//==============================================================================
+
+double DormandPrinceSolver::attemptStep(double pStep) const
+{
+    // Compute the six remaining stages of a Dormand-Prince step, knowing that
+    // k1 = f(t_n, Y_n) is already available (since the last stage of a step is
+    // the first stage of the next one), and return the (RMS) norm of the local
+    // error estimate relative to our tolerances
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+pStep*A21*mK1[i];
+    }
+
+    mComputeRates(mVoi+C2*pStep, mConstants, mK2, mYStage, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+pStep*(A31*mK1[i]+A32*mK2[i]);
+    }
+
+    mComputeRates(mVoi+C3*pStep, mConstants, mK3, mYStage, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+pStep*(A41*mK1[i]+A42*mK2[i]+A43*mK3[i]);
+    }
+
+    mComputeRates(mVoi+C4*pStep, mConstants, mK4, mYStage, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+pStep*(A51*mK1[i]+A52*mK2[i]+A53*mK3[i]+A54*mK4[i]);
+    }
+
+    mComputeRates(mVoi+C5*pStep, mConstants, mK5, mYStage, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYStage[i] = mY[i]+pStep*(A61*mK1[i]+A62*mK2[i]+A63*mK3[i]+A64*mK4[i]+A65*mK5[i]);
+    }
+
+    mComputeRates(mVoi+pStep, mConstants, mK6, mYStage, mAlgebraic);
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mYNew[i] = mY[i]+pStep*(A71*mK1[i]+A73*mK3[i]+A74*mK4[i]+A75*mK5[i]+A76*mK6[i]);
+    }
+
+    mComputeRates(mVoi+pStep, mConstants, mK7, mYNew, mAlgebraic);
+
+    // Estimate our local error
+
+    double res = 0.0;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        double scale = mAbsoluteTolerance+mRelativeTolerance*qMax(qFabs(mY[i]), qFabs(mYNew[i]));
+        double error = pStep*(E1*mK1[i]+E3*mK3[i]+E4*mK4[i]+E5*mK5[i]+E6*mK6[i]+E7*mK7[i])/scale;
+
+        res += error*error;
+    }
+
+    return sqrt(res/mRatesStatesCount);
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::acceptStep(double pStep) const
+{
+    // Compute the coefficients of our dense output over our step, if needed
+
+    if (mInterpolateSolution) {
+        for (int i = 0; i < mRatesStatesCount; ++i) {
+            double yDifference = mYNew[i]-mY[i];
+            double bSpline = pStep*mK1[i]-yDifference;
+
+            mDense1[i] = mY[i];
+            mDense2[i] = yDifference;
+            mDense3[i] = bSpline;
+            mDense4[i] = yDifference-pStep*mK7[i]-bSpline;
+            mDense5[i] = pStep*(D1*mK1[i]+D3*mK3[i]+D4*mK4[i]+D5*mK5[i]+D6*mK6[i]+D7*mK7[i]);
+        }
+    }
+
+    // Our new states become our current states and the last stage of our step
+    // becomes the first stage of our next step
+
+    memcpy(mY, mYNew, size_t(mRatesStatesCount)*Solver::SizeOfDouble);
+    memcpy(mK1, mK7, size_t(mRatesStatesCount)*Solver::SizeOfDouble);
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::interpolate(double pVoi) const
+{
+    // Use our dense output to compute our states at the given point, which is
+    // within our last step
+
+    double theta = (pVoi-mPreviousVoi)/mPreviousStep;
+    double oneMinusTheta = 1.0-theta;
+
+    for (int i = 0; i < mRatesStatesCount; ++i) {
+        mStates[i] = mDense1[i]+theta*(mDense2[i]+oneMinusTheta*(mDense3[i]+theta*(mDense4[i]+oneMinusTheta*mDense5[i])));
+    }
+}
+
+//==============================================================================
+
+void DormandPrinceSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // (Re)start our integration, if needed
+
+    if (mNeedRestart) {
+        restart(pVoi);
+    }
+
+    // Take as many steps as needed to reach or, if we can interpolate our
+    // solution, go past pVoiEnd
+    // Note: to emit an error requires a non-const object, hence we cast away
+    //       our constness when needed...
+
+    static const double MinimumRelativeStep = 16.0*std::numeric_limits<double>::epsilon();
+
+    int stepsCount = 0;
+    bool stepRejected = false;
+
+    while ((mVoi < pVoiEnd) && !qFuzzyCompare(mVoi, pVoiEnd)) {
+        if (stepsCount == mMaximumNumberOfSteps) {
+            const_cast<DormandPrinceSolver *>(this)->emitError(tr("the maximum number of steps was taken before reaching the next output point"));
+
+            return;
+        }
+
+        // Determine our step, making sure that we land on pVoiEnd if we cannot
+        // interpolate our solution
+
+        double step = mStep;
+        bool lastStep = false;
+
+        if ((mMaximumStep > 0.0) && (step > mMaximumStep)) {
+            step = mMaximumStep;
+        }
+
+        if (!mInterpolateSolution && (mVoi+step >= pVoiEnd)) {
+            step = pVoiEnd-mVoi;
+            lastStep = true;
+        }
+
+        if (step <= MinimumRelativeStep*qMax(qFabs(mVoi), 1.0)) {
+            const_cast<DormandPrinceSolver *>(this)->emitError(tr("the step became too small"));
+
+            return;
+        }
+
+        // Attempt our step and determine our next step based on our error
+        // estimate
+
+        double errorNorm = attemptStep(step);
+        double factor = qIsNull(errorNorm)?
+                            MaximumStepFactor:
+                            qBound(MinimumStepFactor, SafetyFactor*pow(errorNorm, -0.2), MaximumStepFactor);
+
+        ++stepsCount;
+
+        if (errorNorm <= 1.0) {
+            // Our step is accepted, but our next step must not be bigger than
+            // our current one if we have just rejected a step
+
+            if (stepRejected) {
+                factor = qMin(factor, 1.0);
+
+                stepRejected = false;
+            }
+
+            acceptStep(step);
+
+            mPreviousVoi = mVoi;
+            mPreviousStep = step;
+            mVoi = lastStep?pVoiEnd:mVoi+step;
+
+            // Our step may have been shortened to land on pVoiEnd, in which
+            // case we don't want to reduce our next step because of it
+
+            mStep = lastStep?qMax(mStep, step*factor):step*factor;
+        } else {
+            // Our step is rejected, so try again with a smaller one
+
+            stepRejected = true;
+
+            mStep = step*qMin(factor, 1.0);
+        }
+    }
+
+    // Retrieve our states at pVoiEnd
+
+    if (   !mInterpolateSolution || qFuzzyCompare(mVoi, pVoiEnd)
+        || qIsNull(mPreviousStep)) {
+        memcpy(mStates, mY, size_t(mRatesStatesCount)*Solver::SizeOfDouble);
+    } else {
+        interpolate(pVoiEnd);
+    }
+
+    pVoi = pVoiEnd;
+}
+
+//==============================================================================
+
+} // namespace DormandPrinceSolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
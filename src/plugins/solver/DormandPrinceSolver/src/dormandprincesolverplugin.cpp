@@ -0,0 +1,212 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Dormand-Prince solver plugin
+//==============================================================================
+
+#include "dormandprincesolver.h"
+#include "dormandprincesolverplugin.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace DormandPrinceSolver {
+
+//==============================================================================
+
+PLUGININFO_FUNC DormandPrinceSolverPluginInfo()
+{
+    static const Descriptions descriptions = {
+                                                 { "en", QString::fromUtf8(R"(a plugin that implements the adaptive <a href="https://en.wikipedia.org/wiki/Dormand–Prince_method">Dormand-Prince method</a> to solve <a href="https://en.wikipedia.org/wiki/Ordinary_differential_equation">ODEs</a>.)") },
+                                                 { "fr", QString::fromUtf8(R"(une extension qui implémente la <a href="https://en.wikipedia.org/wiki/Dormand–Prince_method">méthode Dormand-Prince</a> adaptative pour résoudre des <a href="https://en.wikipedia.org/wiki/Ordinary_differential_equation">EDOs</a>.)") }
+                                             };
+
+    return new PluginInfo(PluginInfo::Category::Solver, true, false,
+                          {},
+                          descriptions);
+}
+
+//==============================================================================
+// I18n interface
+//==============================================================================
+
+void DormandPrinceSolverPlugin::retranslateUi()
+{
+    // We don't handle this interface...
+    // Note: even though we don't handle this interface, we still want to
+    //       support it since some other aspects of our plugin are
+    //       multilingual...
+}
+
+//==============================================================================
+// Solver interface
+//==============================================================================
+
+Solver::Solver * DormandPrinceSolverPlugin::solverInstance() const
+{
+    // Create and return an instance of the solver
+
+    return new DormandPrinceSolver();
+}
+
+//==============================================================================
+
+QString DormandPrinceSolverPlugin::id(const QString &pKisaoId) const
+{
+    // Return the id for the given KiSAO id
+
+    static const QString Kisao0000087 = "KISAO:0000087";
+    static const QString Kisao0000467 = "KISAO:0000467";
+    static const QString Kisao0000415 = "KISAO:0000415";
+    static const QString Kisao0000209 = "KISAO:0000209";
+    static const QString Kisao0000211 = "KISAO:0000211";
+    static const QString Kisao0000481 = "KISAO:0000481";
+
+    if (pKisaoId == Kisao0000087) {
+        return solverName();
+    }
+
+    if (pKisaoId == Kisao0000467) {
+        return MaximumStepId;
+    }
+
+    if (pKisaoId == Kisao0000415) {
+        return MaximumNumberOfStepsId;
+    }
+
+    if (pKisaoId == Kisao0000209) {
+        return RelativeToleranceId;
+    }
+
+    if (pKisaoId == Kisao0000211) {
+        return AbsoluteToleranceId;
+    }
+
+    if (pKisaoId == Kisao0000481) {
+        return InterpolateSolutionId;
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+QString DormandPrinceSolverPlugin::kisaoId(const QString &pId) const
+{
+    // Return the KiSAO id for the given id
+
+    if (pId == solverName()) {
+        return "KISAO:0000087";
+    }
+
+    if (pId == MaximumStepId) {
+        return "KISAO:0000467";
+    }
+
+    if (pId == MaximumNumberOfStepsId) {
+        return "KISAO:0000415";
+    }
+
+    if (pId == RelativeToleranceId) {
+        return "KISAO:0000209";
+    }
+
+    if (pId == AbsoluteToleranceId) {
+        return "KISAO:0000211";
+    }
+
+    if (pId == InterpolateSolutionId) {
+        return "KISAO:0000481";
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+Solver::Type DormandPrinceSolverPlugin::solverType() const
+{
+    // Return the type of the solver
+
+    return Solver::Type::Ode;
+}
+
+//==============================================================================
+
+QString DormandPrinceSolverPlugin::solverName() const
+{
+    // Return the name of the solver
+
+    return "Dormand-Prince";
+}
+
+//==============================================================================
+
+Solver::Properties DormandPrinceSolverPlugin::solverProperties() const
+{
+    // Return the properties supported by the solver
+
+    static const Descriptions MaximumStepDescriptions = {
+                                                            { "en", QString::fromUtf8("Maximum step") },
+                                                            { "fr", QString::fromUtf8("Pas maximum") }
+                                                        };
+    static const Descriptions MaximumNumberOfStepsDescriptions = {
+                                                                     { "en", QString::fromUtf8("Maximum number of steps") },
+                                                                     { "fr", QString::fromUtf8("Nombre maximum de pas") }
+                                                                 };
+    static const Descriptions RelativeToleranceDescriptions = {
+                                                                  { "en", QString::fromUtf8("Relative tolerance") },
+                                                                  { "fr", QString::fromUtf8("Tolérance relative") }
+                                                              };
+    static const Descriptions AbsoluteToleranceDescriptions = {
+                                                                  { "en", QString::fromUtf8("Absolute tolerance") },
+                                                                  { "fr", QString::fromUtf8("Tolérance absolue") }
+                                                              };
+    static const Descriptions InterpolateSolutionDescriptions = {
+                                                                    { "en", QString::fromUtf8("Interpolate solution") },
+                                                                    { "fr", QString::fromUtf8("Interpoler solution") }
+                                                                };
+
+    return { Solver::Property(Solver::Property::Type::DoubleGe0, MaximumStepId, MaximumStepDescriptions, {}, MaximumStepDefaultValue, true),
+             Solver::Property(Solver::Property::Type::IntegerGt0, MaximumNumberOfStepsId, MaximumNumberOfStepsDescriptions, {}, MaximumNumberOfStepsDefaultValue, false),
+             Solver::Property(Solver::Property::Type::DoubleGe0, RelativeToleranceId, RelativeToleranceDescriptions, {}, RelativeToleranceDefaultValue, false),
+             Solver::Property(Solver::Property::Type::DoubleGe0, AbsoluteToleranceId, AbsoluteToleranceDescriptions, {}, AbsoluteToleranceDefaultValue, false),
+             Solver::Property(Solver::Property::Type::Boolean, InterpolateSolutionId, InterpolateSolutionDescriptions, {}, InterpolateSolutionDefaultValue, false) };
+}
+
+//==============================================================================
+
+QMap<QString, bool> DormandPrinceSolverPlugin::solverPropertiesVisibility(const QMap<QString, QString> &pSolverPropertiesValues) const
+{
+    Q_UNUSED(pSolverPropertiesValues)
+
+    // We don't handle this interface...
+
+    return {};
+}
+
+//==============================================================================
+
+} // namespace DormandPrinceSolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
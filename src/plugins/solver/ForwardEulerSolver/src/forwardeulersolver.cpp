@@ -30,6 +30,15 @@ namespace ForwardEulerSolver {
 
 //==============================================================================
 
+Solver::FixedStepMethod ForwardEulerSolver::fixedStepMethod() const
+{
+    // Return our fixed-step method
+
+    return Solver::FixedStepMethod::ForwardEuler;
+}
+
+//==============================================================================
+
 void ForwardEulerSolver::initialize(double pVoi, int pRatesStatesCount,
                                     double *pConstants, double *pRates,
                                     double *pStates, double *pAlgebraic,
@@ -55,6 +64,15 @@ void ForwardEulerSolver::initialize(double pVoi, int pRatesStatesCount,
 
 void ForwardEulerSolver::solve(double &pVoi, double pVoiEnd) const
 {
+    // Use our integrator, if we have one
+
+    if (mIntegrate != nullptr) {
+        mIntegrate(&pVoi, pVoiEnd, mStep, mConstants, mRates, mStates, mAlgebraic,
+                   nullptr, nullptr, nullptr);
+
+        return;
+    }
+
     // Y_n+1 = Y_n + h * f(t_n, Y_n)
 
     double voiStart = pVoi;
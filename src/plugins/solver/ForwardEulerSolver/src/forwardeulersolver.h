@@ -47,6 +47,8 @@ class ForwardEulerSolver : public OpenCOR::Solver::OdeSolver
     Q_OBJECT
 
 public:
+    Solver::FixedStepMethod fixedStepMethod() const override;
+
     void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
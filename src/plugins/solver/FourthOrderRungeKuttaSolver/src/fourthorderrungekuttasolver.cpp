@@ -41,6 +41,15 @@ FourthOrderRungeKuttaSolver::~FourthOrderRungeKuttaSolver()
 
 //==============================================================================
 
+Solver::FixedStepMethod FourthOrderRungeKuttaSolver::fixedStepMethod() const
+{
+    // Return our fixed-step method
+
+    return Solver::FixedStepMethod::FourthOrderRungeKutta;
+}
+
+//==============================================================================
+
 void FourthOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
                                              double *pConstants,
                                              double *pRates, double *pStates,
@@ -77,6 +86,15 @@ void FourthOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
 
 void FourthOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
 {
+    // Use our integrator, if we have one
+
+    if (mIntegrate != nullptr) {
+        mIntegrate(&pVoi, pVoiEnd, mStep, mConstants, mRates, mStates, mAlgebraic,
+                   mK1, mK23, mYk123);
+
+        return;
+    }
+
     // k1 = h * f(t_n, Y_n)
     // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
     // k3 = h * f(t_n + h / 2, Y_n + k2 / 2)
@@ -133,7 +151,7 @@ void FourthOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
 
         for (int i = 0; i < mRatesStatesCount; ++i) {
             mK23[i] += mRates[i];
-            mYk123[i] = mStates[i]+realStep*mK23[i];
+            mYk123[i] = mStates[i]+realStep*mRates[i];
         }
 
         // Compute f(t_n + h, Y_n + k3)
@@ -49,6 +49,8 @@ class FourthOrderRungeKuttaSolver : public OpenCOR::Solver::OdeSolver
 public:
     ~FourthOrderRungeKuttaSolver() override;
 
+    Solver::FixedStepMethod fixedStepMethod() const override;
+
     void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
                     double *pRates, double *pStates, double *pAlgebraic,
                     ComputeRatesFunction pComputeRates) override;
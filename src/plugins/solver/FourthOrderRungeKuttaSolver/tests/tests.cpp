@@ -0,0 +1,102 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Fourth-order Runge-Kutta solver tests
+//==============================================================================
+
+#include "fourthorderrungekuttasolver.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtMath>
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+static void computeRates(double pVoi, double *pConstants, double *pRates,
+                         double *pStates, double *pAlgebraic)
+{
+    Q_UNUSED(pVoi)
+    Q_UNUSED(pConstants)
+    Q_UNUSED(pAlgebraic)
+
+    // dy/dt = y
+
+    pRates[0] = pStates[0];
+}
+
+//==============================================================================
+
+static double solve(double pStep, double pVoiEnd)
+{
+    // Solve dy/dt = y, with y(0) = 1, from 0 to the given end point using the
+    // given step, and return the value of y at that end point
+    // Note: we don't give our solver an integrator, so that it uses its own
+    //       algorithm...
+
+    OpenCOR::FourthOrderRungeKuttaSolver::FourthOrderRungeKuttaSolver solver;
+    double rates[1] = { 0.0 };
+    double states[1] = { 1.0 };
+    double voi = 0.0;
+
+    solver.setProperties({ { OpenCOR::FourthOrderRungeKuttaSolver::StepId, pStep } });
+    solver.initialize(voi, 1, nullptr, rates, states, nullptr, computeRates);
+    solver.solve(voi, pVoiEnd);
+
+    return states[0];
+}
+
+//==============================================================================
+
+void Tests::stepTests()
+{
+    // Take one step, which for dy/dt = y must give us the fourth-order Taylor
+    // expansion of exp(h), i.e. 1+h+h^2/2+h^3/6+h^4/24
+    // Note: this used not to be the case since k4 was evaluated at
+    //       Y_n + h * (k2 + k3) rather than at Y_n + h * k3...
+
+    static const double Step = 0.1;
+
+    QCOMPARE(solve(Step, Step),
+             1.0+Step+Step*Step/2.0+Step*Step*Step/6.0+Step*Step*Step*Step/24.0);
+}
+
+//==============================================================================
+
+void Tests::convergenceTests()
+{
+    // Make sure that our solver is fourth-order accurate, i.e. that its global
+    // error gets divided by about 16 when its step gets halved
+
+    double error1 = qAbs(solve(0.1, 1.0)-qExp(1.0));
+    double error2 = qAbs(solve(0.05, 1.0)-qExp(1.0));
+
+    QVERIFY(error1 < 1.0e-5);
+    QVERIFY((error1/error2 > 14.0) && (error1/error2 < 18.0));
+}
+
+//==============================================================================
+
+QTEST_GUILESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================
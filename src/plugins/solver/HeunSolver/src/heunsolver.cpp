@@ -40,6 +40,15 @@ HeunSolver::~HeunSolver()
 
 //==============================================================================
 
+Solver::FixedStepMethod HeunSolver::fixedStepMethod() const
+{
+    // Return our fixed-step method
+
+    return Solver::FixedStepMethod::Heun;
+}
+
+//==============================================================================
+
 void HeunSolver::initialize(double pVoi, int pRatesStatesCount,
                             double *pConstants, double *pRates, double *pStates,
                             double *pAlgebraic,
@@ -73,6 +82,15 @@ void HeunSolver::initialize(double pVoi, int pRatesStatesCount,
 
 void HeunSolver::solve(double &pVoi, double pVoiEnd) const
 {
+    // Use our integrator, if we have one
+
+    if (mIntegrate != nullptr) {
+        mIntegrate(&pVoi, pVoiEnd, mStep, mConstants, mRates, mStates, mAlgebraic,
+                   mK, mYk, nullptr);
+
+        return;
+    }
+
     // k = h * f(t_n, Y_n)
     // Y_n+1 = Y_n + h / 2 * ( f(t_n, Y_n) + f(t_n + h, Y_n + k) )
 
@@ -0,0 +1,595 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// IDA solver
+//==============================================================================
+
+#include "idasolver.h"
+
+//==============================================================================
+
+#include <cstring>
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "idas/idas.h"
+    #include "nvector/nvector_serial.h"
+    #include "sunlinsol/sunlinsol_dense.h"
+    #include "sunmatrix/sunmatrix_dense.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace IDASolver {
+
+//==============================================================================
+
+int residualFunction(double pVoi, N_Vector pStates, N_Vector pRates,
+                     N_Vector pResiduals, void *pUserData)
+{
+    // Compute the residual function of our DAE, i.e. F(t, Y, Y') = 0 with
+    // Y = [x, z], where x are the states of our model and z the unknowns of its
+    // NLA systems:
+    //     F_x = x'-f(t, x, z)
+    //     F_z = g(t, x, z)
+    // Note #1: our NLA solver sets the unknowns of our NLA systems to z and
+    //          computes g rather than solve those systems...
+    // Note #2: we reset F_z in case our NLA solver doesn't recognise an NLA
+    //          system, in which case it will solve it and its unknowns will
+    //          therefore remain constant as far as IDAS is concerned...
+
+    auto userData = static_cast<IdaSolverUserData *>(pUserData);
+    int ratesStatesCount = userData->ratesStatesCount();
+    double *states = N_VGetArrayPointer_Serial(pStates);
+    double *rates = N_VGetArrayPointer_Serial(pRates);
+    double *residuals = N_VGetArrayPointer_Serial(pResiduals);
+    IdaSolverNlaSolver *nlaSolver = userData->nlaSolver();
+
+    if (nlaSolver != nullptr) {
+        memset(residuals+ratesStatesCount, 0,
+               size_t(nlaSolver->unknownsCount())*sizeof(double));
+
+        nlaSolver->evaluate(states+ratesStatesCount,
+                            residuals+ratesStatesCount);
+    }
+
+    userData->computeRates()(pVoi, userData->constants(), residuals, states,
+                             userData->algebraic());
+
+    if (nlaSolver != nullptr) {
+        nlaSolver->forward();
+    }
+
+    for (int i = 0; i < ratesStatesCount; ++i) {
+        residuals[i] = rates[i]-residuals[i];
+    }
+
+    return 0;
+}
+
+//==============================================================================
+
+void errorHandler(int pErrorCode, const char *pModule, const char *pFunction,
+                  char *pErrorMessage, void *pUserData)
+{
+    Q_UNUSED(pModule)
+    Q_UNUSED(pFunction)
+
+    // Forward errors to our IdaSolver object
+
+    if (pErrorCode != IDA_WARNING) {
+        static_cast<IdaSolver *>(pUserData)->emitError(pErrorMessage);
+    }
+}
+
+//==============================================================================
+
+IdaSolverNlaSolver::IdaSolverNlaSolver(Solver::NlaSolver *pNlaSolver) :
+    mNlaSolver(pNlaSolver)
+{
+}
+
+//==============================================================================
+
+void IdaSolverNlaSolver::solve(ComputeSystemFunction pComputeSystem,
+                               double *pParameters, int pSize,
+                               void *pUserData, void **pData)
+{
+    // Evaluate our NLA system using the unknowns that we were given, if we are
+    // to evaluate it and know about it
+
+    if (   (mMode == Mode::Evaluate)
+        && (mIndex < mSizes.count()) && (mSizes[mIndex] == pSize)) {
+        memcpy(pParameters, mEvaluatedUnknowns+mOffset,
+               size_t(pSize)*sizeof(double));
+
+        pComputeSystem(pParameters, mResiduals+mOffset, pUserData);
+
+        mOffset += pSize;
+
+        ++mIndex;
+
+        return;
+    }
+
+    // Solve our NLA system using our model's NLA solver and keep track of its
+    // size and solution, if needed
+
+    mNlaSolver->solve(pComputeSystem, pParameters, pSize, pUserData, pData);
+
+    if (mMode == Mode::Record) {
+        mSizes << pSize;
+
+        for (int i = 0; i < pSize; ++i) {
+            mUnknowns << pParameters[i];
+        }
+    }
+}
+
+//==============================================================================
+
+void IdaSolverNlaSolver::forward()
+{
+    // Solve our NLA systems using our model's NLA solver
+
+    mMode = Mode::Forward;
+}
+
+//==============================================================================
+
+void IdaSolverNlaSolver::record()
+{
+    // Solve our NLA systems using our model's NLA solver and keep track of
+    // their size and solution
+
+    mMode = Mode::Record;
+
+    mSizes.clear();
+    mUnknowns.clear();
+}
+
+//==============================================================================
+
+void IdaSolverNlaSolver::evaluate(const double *pUnknowns, double *pResiduals)
+{
+    // Evaluate our NLA systems using the given unknowns, keeping track of
+    // their residuals
+
+    mMode = Mode::Evaluate;
+
+    mEvaluatedUnknowns = pUnknowns;
+    mResiduals = pResiduals;
+
+    mIndex = 0;
+    mOffset = 0;
+}
+
+//==============================================================================
+
+int IdaSolverNlaSolver::unknownsCount() const
+{
+    // Return the number of unknowns of the NLA systems that we have recorded
+
+    return mUnknowns.count();
+}
+
+//==============================================================================
+
+const QVector<double> & IdaSolverNlaSolver::unknowns() const
+{
+    // Return the unknowns of the NLA systems that we have recorded
+
+    return mUnknowns;
+}
+
+//==============================================================================
+
+IdaSolverUserData::IdaSolverUserData(int pRatesStatesCount, double *pConstants,
+                                     double *pAlgebraic,
+                                     Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                                     IdaSolverNlaSolver *pNlaSolver) :
+    mRatesStatesCount(pRatesStatesCount),
+    mConstants(pConstants),
+    mAlgebraic(pAlgebraic),
+    mComputeRates(pComputeRates),
+    mNlaSolver(pNlaSolver)
+{
+}
+
+//==============================================================================
+
+int IdaSolverUserData::ratesStatesCount() const
+{
+    // Return our number of rates/states
+
+    return mRatesStatesCount;
+}
+
+//==============================================================================
+
+double * IdaSolverUserData::constants() const
+{
+    // Return our constants array
+
+    return mConstants;
+}
+
+//==============================================================================
+
+double * IdaSolverUserData::algebraic() const
+{
+    // Return our algebraic array
+
+    return mAlgebraic;
+}
+
+//==============================================================================
+
+Solver::OdeSolver::ComputeRatesFunction IdaSolverUserData::computeRates() const
+{
+    // Return our compute rates function
+
+    return mComputeRates;
+}
+
+//==============================================================================
+
+IdaSolverNlaSolver * IdaSolverUserData::nlaSolver() const
+{
+    // Return our NLA solver
+
+    return mNlaSolver;
+}
+
+//==============================================================================
+
+IdaSolver::~IdaSolver()
+{
+    // Delete our NLA solver
+
+    delete mNlaSolver;
+
+    // Make sure that the solver has been initialised
+
+    if (mSolver == nullptr) {
+        return;
+    }
+
+    // Delete some internal objects
+
+    N_VDestroy_Serial(mStatesVector);
+    N_VDestroy_Serial(mRatesVector);
+    SUNLinSolFree(mLinearSolver);
+    SUNMatDestroy(mMatrix);
+
+    IDAFree(&mSolver);
+
+    SUNContext_Free(&mContext);
+
+    delete mUserData;
+}
+
+//==============================================================================
+
+Solver::NlaSolver * IdaSolver::wrapNlaSolver(Solver::NlaSolver *pNlaSolver)
+{
+    // We integrate the NLA systems of our model along with its ODEs, so our
+    // model must use our own NLA solver, which relies on the given one to
+    // solve those NLA systems when we need consistent values
+
+    delete mNlaSolver;
+
+    mNlaSolver = new IdaSolverNlaSolver(pNlaSolver);
+
+    return mNlaSolver;
+}
+
+//==============================================================================
+
+void IdaSolver::initialize(double pVoi, int pRatesStatesCount,
+                           double *pConstants, double *pRates,
+                           double *pStates, double *pAlgebraic,
+                           ComputeRatesFunction pComputeRates)
+{
+    // Retrieve our properties
+
+    double maximumStep = MaximumStepDefaultValue;
+    int maximumNumberOfSteps = MaximumNumberOfStepsDefaultValue;
+    double relativeTolerance = RelativeToleranceDefaultValue;
+    double absoluteTolerance = AbsoluteToleranceDefaultValue;
+
+    if (mProperties.contains(MaximumStepId)) {
+        maximumStep = mProperties.value(MaximumStepId).toDouble();
+    } else {
+        emit error(tr(R"(the "Maximum step" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(MaximumNumberOfStepsId)) {
+        maximumNumberOfSteps = mProperties.value(MaximumNumberOfStepsId).toInt();
+    } else {
+        emit error(tr(R"(the "Maximum number of steps" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(RelativeToleranceId)) {
+        relativeTolerance = mProperties.value(RelativeToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Relative tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(AbsoluteToleranceId)) {
+        absoluteTolerance = mProperties.value(AbsoluteToleranceId).toDouble();
+    } else {
+        emit error(tr(R"(the "Absolute tolerance" property value could not be retrieved)"));
+
+        return;
+    }
+
+    if (mProperties.contains(InterpolateSolutionId)) {
+        mInterpolateSolution = mProperties.value(InterpolateSolutionId).toBool();
+    } else {
+        emit error(tr(R"(the "Interpolate solution" property value could not be retrieved)"));
+
+        return;
+    }
+
+    // Initialise our ODE solver
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // Compute consistent values for our rates and for the unknowns of our NLA
+    // systems, which tells us how many unknowns our DAE has
+
+    computeConsistentValues(pVoi);
+
+    int unknownsCount = (mNlaSolver != nullptr)?mNlaSolver->unknownsCount():0;
+
+    mResiduals.resize(unknownsCount);
+
+    // Create our SUNDIALS context
+
+    SUNContext_Create(nullptr, &mContext);
+
+    // Create our states and rates vectors, and initialise them
+
+    mStatesVector = N_VNew_Serial(pRatesStatesCount+unknownsCount, mContext);
+    mRatesVector = N_VNew_Serial(pRatesStatesCount+unknownsCount, mContext);
+
+    copyConsistentValues();
+
+    // Create our IDAS solver
+
+    mSolver = IDACreate(mContext);
+
+    // Use our own error handler
+
+    IDASetErrHandlerFn(mSolver, errorHandler, this);
+
+    // Initialise our IDAS solver
+
+    IDAInit(mSolver, residualFunction, pVoi, mStatesVector, mRatesVector);
+
+    // Set our user data
+
+    mUserData = new IdaSolverUserData(pRatesStatesCount, pConstants,
+                                      pAlgebraic, pComputeRates, mNlaSolver);
+
+    IDASetUserData(mSolver, mUserData);
+
+    // Set our maximum step
+
+    IDASetMaxStep(mSolver, maximumStep);
+
+    // Set our maximum number of steps
+
+    IDASetMaxNumSteps(mSolver, maximumNumberOfSteps);
+
+    // Let IDAS know which of our variables are differential and which are
+    // algebraic
+
+    N_Vector id = N_VNew_Serial(pRatesStatesCount+unknownsCount, mContext);
+    double *idData = N_VGetArrayPointer_Serial(id);
+
+    for (int i = 0; i < pRatesStatesCount; ++i) {
+        idData[i] = 1.0;
+    }
+
+    for (int i = 0; i < unknownsCount; ++i) {
+        idData[pRatesStatesCount+i] = 0.0;
+    }
+
+    IDASetId(mSolver, id);
+
+    N_VDestroy_Serial(id);
+
+    // Set our linear solver
+
+    mMatrix = SUNDenseMatrix(pRatesStatesCount+unknownsCount,
+                             pRatesStatesCount+unknownsCount, mContext);
+    mLinearSolver = SUNLinSol_Dense(mStatesVector, mMatrix, mContext);
+
+    IDASetLinearSolver(mSolver, mLinearSolver, mMatrix);
+
+    // Set our relative and absolute tolerances
+
+    IDASStolerances(mSolver, relativeTolerance, absoluteTolerance);
+}
+
+//==============================================================================
+
+void IdaSolver::reinitialize(double pVoi)
+{
+    // Reinitialise our IDAS object
+
+    restart(pVoi);
+}
+
+//==============================================================================
+
+void IdaSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // Restart our IDAS object if our states have been modified from outside,
+    // since our DAE has its own copy of them
+
+    if (memcmp(mStates, N_VGetArrayPointer_Serial(mStatesVector),
+               size_t(mRatesStatesCount)*sizeof(double)) != 0) {
+        restart(pVoi);
+    }
+
+    // Solve the model
+
+    if (!mInterpolateSolution) {
+        IDASetStopTime(mSolver, pVoiEnd);
+    }
+
+    IDASolve(mSolver, pVoiEnd, &pVoi, mStatesVector, mRatesVector, IDA_NORMAL);
+
+    // Update our states, and compute our rates and algebraic variables one
+    // more time using the unknowns of our NLA systems
+    // Note: another way of doing this would be to keep track of the rates
+    //       calculated in our residual function, but that's bound to be more
+    //       time consuming since a call to IDASolve() is likely to generate
+    //       quite a few calls to that function...
+
+    double *states = N_VGetArrayPointer_Serial(mStatesVector);
+
+    memcpy(mStates, states, size_t(mRatesStatesCount)*sizeof(double));
+
+    if (mNlaSolver != nullptr) {
+        mNlaSolver->evaluate(states+mRatesStatesCount, mResiduals.data());
+    }
+
+    mComputeRates(pVoiEnd, mConstants, mRates, mStates, mAlgebraic);
+
+    if (mNlaSolver != nullptr) {
+        mNlaSolver->forward();
+    }
+}
+
+//==============================================================================
+
+void IdaSolver::computeConsistentValues(double pVoi) const
+{
+    // Compute our rates and algebraic variables by solving our NLA systems
+    // using our model's NLA solver, keeping track of their solution, which
+    // gives us consistent values for our DAE
+
+    if (mNlaSolver != nullptr) {
+        mNlaSolver->record();
+    }
+
+    mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
+
+    if (mNlaSolver != nullptr) {
+        mNlaSolver->forward();
+    }
+}
+
+//==============================================================================
+
+void IdaSolver::copyConsistentValues() const
+{
+    // Copy our consistent values to our DAE's states and rates vectors, i.e.
+    // Y = [x, z] and Y' = [x', 0]
+
+    double *states = N_VGetArrayPointer_Serial(mStatesVector);
+    double *rates = N_VGetArrayPointer_Serial(mRatesVector);
+    int unknownsCount = mResiduals.count();
+
+    memcpy(states, mStates, size_t(mRatesStatesCount)*sizeof(double));
+    memcpy(rates, mRates, size_t(mRatesStatesCount)*sizeof(double));
+
+    if (unknownsCount != 0) {
+        memcpy(states+mRatesStatesCount, mNlaSolver->unknowns().constData(),
+               size_t(unknownsCount)*sizeof(double));
+        memset(rates+mRatesStatesCount, 0, size_t(unknownsCount)*sizeof(double));
+    }
+}
+
+//==============================================================================
+
+void IdaSolver::restart(double pVoi) const
+{
+    // Compute and copy new consistent values for our DAE, and reinitialise our
+    // IDAS object with them
+
+    computeConsistentValues(pVoi);
+    copyConsistentValues();
+
+    // Keep track of our statistics, if needed, since reinitialising our IDAS
+    // object resets its counters
+
+    if (mStatisticsEnabled) {
+        mStatistics = statistics();
+    }
+
+    IDAReInit(mSolver, pVoi, mStatesVector, mRatesVector);
+}
+
+//==============================================================================
+
+Solver::Solver::Statistics IdaSolver::statistics() const
+{
+    // Return our statistics, i.e. those that we have kept track of so far and
+    // those of our current IDAS object
+    // Note: IDAS keeps track of those counters anyway, so retrieving them comes
+    //       at no cost...
+
+    Statistics res = mStatistics;
+
+    if (mStatisticsEnabled && (mSolver != nullptr)) {
+        long int steps = 0;
+        long int residualEvaluations = 0;
+        long int jacobianEvaluations = 0;
+        long int linearSolverSetups = 0;
+        long int errorTestFailures = 0;
+
+        IDAGetNumSteps(mSolver, &steps);
+        IDAGetNumResEvals(mSolver, &residualEvaluations);
+        IDAGetNumJacEvals(mSolver, &jacobianEvaluations);
+        IDAGetNumLinSolvSetups(mSolver, &linearSolverSetups);
+        IDAGetNumErrTestFails(mSolver, &errorTestFailures);
+
+        res[OpenCOR::Solver::StepsStatistic] += quint64(steps);
+        res[OpenCOR::Solver::RhsEvaluationsStatistic] += quint64(residualEvaluations);
+        res[OpenCOR::Solver::JacobianEvaluationsStatistic] += quint64(jacobianEvaluations);
+        res[OpenCOR::Solver::LinearSolverSetupsStatistic] += quint64(linearSolverSetups);
+        res[OpenCOR::Solver::ErrorTestFailuresStatistic] += quint64(errorTestFailures);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+} // namespace IDASolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,192 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// IDA solver
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "solverinterface.h"
+
+//==============================================================================
+
+#include "sundialsbegin.h"
+    #include "sundials/sundials_linearsolver.h"
+    #include "sundials/sundials_matrix.h"
+#include "sundialsend.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace IDASolver {
+
+//==============================================================================
+
+static const auto MaximumStepId          = QStringLiteral("MaximumStep");
+static const auto MaximumNumberOfStepsId = QStringLiteral("MaximumNumberOfSteps");
+static const auto RelativeToleranceId    = QStringLiteral("RelativeTolerance");
+static const auto AbsoluteToleranceId    = QStringLiteral("AbsoluteTolerance");
+static const auto InterpolateSolutionId  = QStringLiteral("InterpolateSolution");
+
+//==============================================================================
+
+// Default IDAS parameter values
+// Note #1: a maximum step of 0 means that there is no maximum step as such and
+//          that IDAS can use whatever step it sees fit...
+// Note #2: IDAS' default maximum number of steps is 500, which ought to be big
+//          enough in most cases...
+
+static const double MaximumStepDefaultValue = 0.0;
+
+enum {
+    MaximumNumberOfStepsDefaultValue = 500
+};
+
+static const double RelativeToleranceDefaultValue = 1.0e-7;
+static const double AbsoluteToleranceDefaultValue = 1.0e-7;
+
+static const bool InterpolateSolutionDefaultValue = true;
+
+//==============================================================================
+
+class IdaSolverNlaSolver : public Solver::NlaSolver
+{
+    Q_OBJECT
+
+public:
+    explicit IdaSolverNlaSolver(Solver::NlaSolver *pNlaSolver);
+
+    void solve(ComputeSystemFunction pComputeSystem, double *pParameters,
+               int pSize, void *pUserData, void **pData) override;
+
+    void forward();
+    void record();
+    void evaluate(const double *pUnknowns, double *pResiduals);
+
+    int unknownsCount() const;
+    const QVector<double> & unknowns() const;
+
+private:
+    enum class Mode {
+        Forward,
+        Record,
+        Evaluate
+    };
+
+    Solver::NlaSolver *mNlaSolver;
+
+    Mode mMode = Mode::Forward;
+
+    QVector<int> mSizes;
+    QVector<double> mUnknowns;
+
+    const double *mEvaluatedUnknowns = nullptr;
+    double *mResiduals = nullptr;
+
+    int mIndex = 0;
+    int mOffset = 0;
+};
+
+//==============================================================================
+
+class IdaSolverUserData
+{
+public:
+    explicit IdaSolverUserData(int pRatesStatesCount, double *pConstants,
+                               double *pAlgebraic,
+                               Solver::OdeSolver::ComputeRatesFunction pComputeRates,
+                               IdaSolverNlaSolver *pNlaSolver);
+
+    int ratesStatesCount() const;
+
+    double * constants() const;
+    double * algebraic() const;
+
+    Solver::OdeSolver::ComputeRatesFunction computeRates() const;
+
+    IdaSolverNlaSolver * nlaSolver() const;
+
+private:
+    int mRatesStatesCount;
+
+    double *mConstants;
+    double *mAlgebraic;
+
+    Solver::OdeSolver::ComputeRatesFunction mComputeRates;
+
+    IdaSolverNlaSolver *mNlaSolver;
+};
+
+//==============================================================================
+
+class IdaSolver : public OpenCOR::Solver::OdeSolver
+{
+    Q_OBJECT
+
+public:
+    ~IdaSolver() override;
+
+    Solver::NlaSolver * wrapNlaSolver(Solver::NlaSolver *pNlaSolver) override;
+
+    void initialize(double pVoi, int pRatesStatesCount, double *pConstants,
+                    double *pRates, double *pStates, double *pAlgebraic,
+                    ComputeRatesFunction pComputeRates) override;
+    void reinitialize(double pVoi) override;
+
+    void solve(double &pVoi, double pVoiEnd) const override;
+
+    Statistics statistics() const override;
+
+private:
+    void *mSolver = nullptr;
+
+    SUNContext mContext = nullptr;
+
+    N_Vector mStatesVector = nullptr;
+    N_Vector mRatesVector = nullptr;
+
+    SUNMatrix mMatrix = nullptr;
+    SUNLinearSolver mLinearSolver = nullptr;
+
+    IdaSolverUserData *mUserData = nullptr;
+
+    IdaSolverNlaSolver *mNlaSolver = nullptr;
+
+    mutable QVector<double> mResiduals;
+
+    bool mInterpolateSolution = InterpolateSolutionDefaultValue;
+
+    mutable Statistics mStatistics;
+
+    void computeConsistentValues(double pVoi) const;
+    void copyConsistentValues() const;
+    void restart(double pVoi) const;
+};
+
+//==============================================================================
+
+} // namespace IDASolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
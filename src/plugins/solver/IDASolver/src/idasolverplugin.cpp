@@ -0,0 +1,215 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// IDA solver plugin
+//==============================================================================
+
+#include "idasolver.h"
+#include "idasolverplugin.h"
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace IDASolver {
+
+//==============================================================================
+
+PLUGININFO_FUNC IDASolverPluginInfo()
+{
+    static const Descriptions descriptions = {
+                                                 { "en", QString::fromUtf8(R"(a plugin that uses <a href="https://computing.llnl.gov/projects/sundials/ida">IDA</a> to solve <a href="https://en.wikipedia.org/wiki/Differential-algebraic_system_of_equations">DAEs</a>.)") },
+                                                 { "fr", QString::fromUtf8(R"(une extension qui utilise <a href="https://computing.llnl.gov/projects/sundials/ida">IDA</a> pour résoudre des <a href="https://en.wikipedia.org/wiki/Differential-algebraic_system_of_equations">EADs</a>.)") }
+                                             };
+
+    return new PluginInfo(PluginInfo::Category::Solver, true, false,
+                          { "SUNDIALS" },
+                          descriptions);
+}
+
+//==============================================================================
+// I18n interface
+//==============================================================================
+
+void IDASolverPlugin::retranslateUi()
+{
+    // We don't handle this interface...
+    // Note: even though we don't handle this interface, we still want to
+    //       support it since some other aspects of our plugin are
+    //       multilingual...
+}
+
+//==============================================================================
+// Solver interface
+//==============================================================================
+
+Solver::Solver * IDASolverPlugin::solverInstance() const
+{
+    // Create and return an instance of the solver
+
+    return new IdaSolver();
+}
+
+//==============================================================================
+
+QString IDASolverPlugin::id(const QString &pKisaoId) const
+{
+    // Return the id for the given KiSAO id
+
+    static const QString Kisao0000283 = "KISAO:0000283";
+    static const QString Kisao0000467 = "KISAO:0000467";
+    static const QString Kisao0000415 = "KISAO:0000415";
+    static const QString Kisao0000209 = "KISAO:0000209";
+    static const QString Kisao0000211 = "KISAO:0000211";
+    static const QString Kisao0000481 = "KISAO:0000481";
+
+    if (pKisaoId == Kisao0000283) {
+        return solverName();
+    }
+
+    if (pKisaoId == Kisao0000467) {
+        return MaximumStepId;
+    }
+
+    if (pKisaoId == Kisao0000415) {
+        return MaximumNumberOfStepsId;
+    }
+
+    if (pKisaoId == Kisao0000209) {
+        return RelativeToleranceId;
+    }
+
+    if (pKisaoId == Kisao0000211) {
+        return AbsoluteToleranceId;
+    }
+
+    if (pKisaoId == Kisao0000481) {
+        return InterpolateSolutionId;
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+QString IDASolverPlugin::kisaoId(const QString &pId) const
+{
+    // Return the KiSAO id for the given id
+
+    if (pId == solverName()) {
+        return "KISAO:0000283";
+    }
+
+    if (pId == MaximumStepId) {
+        return "KISAO:0000467";
+    }
+
+    if (pId == MaximumNumberOfStepsId) {
+        return "KISAO:0000415";
+    }
+
+    if (pId == RelativeToleranceId) {
+        return "KISAO:0000209";
+    }
+
+    if (pId == AbsoluteToleranceId) {
+        return "KISAO:0000211";
+    }
+
+    if (pId == InterpolateSolutionId) {
+        return "KISAO:0000481";
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+Solver::Type IDASolverPlugin::solverType() const
+{
+    // Return the type of the solver
+    // Note: IDA solves DAEs, but from our point of view it solves the ODEs of
+    //       our model, with its NLA systems integrated as algebraic
+    //       constraints...
+
+    return Solver::Type::Ode;
+}
+
+//==============================================================================
+
+QString IDASolverPlugin::solverName() const
+{
+    // Return the name of the solver
+
+    return "IDA";
+}
+
+//==============================================================================
+
+Solver::Properties IDASolverPlugin::solverProperties() const
+{
+    // Return the properties supported by the solver
+
+    static const Descriptions MaximumStepDescriptions = {
+                                                            { "en", QString::fromUtf8("Maximum step") },
+                                                            { "fr", QString::fromUtf8("Pas maximum") }
+                                                        };
+    static const Descriptions MaximumNumberOfStepsDescriptions = {
+                                                                     { "en", QString::fromUtf8("Maximum number of steps") },
+                                                                     { "fr", QString::fromUtf8("Nombre maximum de pas") }
+                                                                 };
+    static const Descriptions RelativeToleranceDescriptions = {
+                                                                  { "en", QString::fromUtf8("Relative tolerance") },
+                                                                  { "fr", QString::fromUtf8("Tolérance relative") }
+                                                              };
+    static const Descriptions AbsoluteToleranceDescriptions = {
+                                                                  { "en", QString::fromUtf8("Absolute tolerance") },
+                                                                  { "fr", QString::fromUtf8("Tolérance absolue") }
+                                                              };
+    static const Descriptions InterpolateSolutionDescriptions = {
+                                                                    { "en", QString::fromUtf8("Interpolate solution") },
+                                                                    { "fr", QString::fromUtf8("Interpoler solution") }
+                                                                };
+
+    return { Solver::Property(Solver::Property::Type::DoubleGe0, MaximumStepId, MaximumStepDescriptions, {}, MaximumStepDefaultValue, true),
+             Solver::Property(Solver::Property::Type::IntegerGt0, MaximumNumberOfStepsId, MaximumNumberOfStepsDescriptions, {}, MaximumNumberOfStepsDefaultValue, false),
+             Solver::Property(Solver::Property::Type::DoubleGe0, RelativeToleranceId, RelativeToleranceDescriptions, {}, RelativeToleranceDefaultValue, false),
+             Solver::Property(Solver::Property::Type::DoubleGe0, AbsoluteToleranceId, AbsoluteToleranceDescriptions, {}, AbsoluteToleranceDefaultValue, false),
+             Solver::Property(Solver::Property::Type::Boolean, InterpolateSolutionId, InterpolateSolutionDescriptions, {}, InterpolateSolutionDefaultValue, false) };
+}
+
+//==============================================================================
+
+QMap<QString, bool> IDASolverPlugin::solverPropertiesVisibility(const QMap<QString, QString> &pSolverPropertiesValues) const
+{
+    Q_UNUSED(pSolverPropertiesValues)
+
+    // We don't handle this interface...
+
+    return {};
+}
+
+//==============================================================================
+
+} // namespace IDASolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -109,6 +109,15 @@ void * KinsolSolverUserData::userData() const
 
 //==============================================================================
 
+void KinsolSolverUserData::setUserData(void *pUserData)
+{
+    // Set our user data
+
+    mUserData = pUserData;
+}
+
+//==============================================================================
+
 KinsolSolverData::KinsolSolverData(void *pSolver, N_Vector pParametersVector,
                                    N_Vector pOnesVector, SUNMatrix pMatrix,
                                    SUNLinearSolver pLinearSolver,
@@ -174,16 +183,6 @@ KinsolSolverUserData * KinsolSolverData::userData() const
     return mUserData;
 }
 
-//==============================================================================
-
-void KinsolSolverData::setUserData(KinsolSolverUserData *pUserData)
-{
-    // Set our user data, after having delete our 'old' ones
-
-    delete mUserData;
-
-    mUserData = pUserData;
-}
 
 //==============================================================================
 
@@ -199,11 +198,17 @@ KinsolSolver::~KinsolSolver()
 //==============================================================================
 
 void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
-                         double *pParameters, int pSize, void *pUserData)
+                         double *pParameters, int pSize, void *pUserData,
+                         void **pData)
 {
     // Check whether we need to initialise or update ourselves
+    // Note: pData is where we keep track of the data that we create for the
+    //       given system, so that we don't have to look it up whenever we are
+    //       asked to solve that system again. That data is owned by us, so
+    //       whoever gave us pData must reset it if we are to be deleted or
+    //       replaced by another NLA solver...
 
-    KinsolSolverData *data = mData.value(reinterpret_cast<void *>(pComputeSystem));
+    auto data = static_cast<KinsolSolverData *>(*pData);
 
     if (data == nullptr) {
         // Retrieve our properties
@@ -329,19 +334,52 @@ void KinsolSolver::solve(ComputeSystemFunction pComputeSystem,
         data = new KinsolSolverData(solver, parametersVector, onesVector,
                                     matrix, linearSolver, userData);
 
-        mData.insert(reinterpret_cast<void *>(pComputeSystem), data);
+        mData << data;
+
+        *pData = data;
     } else {
-        // We are already initialised, so simply update our user data
+        // We are already initialised, so simply update our parameters and user
+        // data
+        // Note: our KINSOL solver already knows about our user data object, so
+        //       we only need to update its contents, which is much cheaper than
+        //       recreating it and setting it again...
 
-        data->setUserData(new KinsolSolverUserData(pComputeSystem, pUserData));
+        N_VSetArrayPointer_Serial(pParameters, data->parametersVector());
 
-        KINSetUserData(data->solver(), data->userData());
+        data->userData()->setUserData(pUserData);
     }
 
     // Solve our linear system
 
     KINSol(data->solver(), data->parametersVector(), KIN_LINESEARCH,
            data->onesVector(), data->onesVector());
+
+    // Keep track of the number of iterations that were needed, if needed
+    // Note: KINSOL resets its counters with every call to KINSol(), hence we
+    //       need to accumulate them ourselves...
+
+    if (mStatisticsEnabled) {
+        long int nlaIterations = 0;
+
+        KINGetNumNonlinSolvIters(data->solver(), &nlaIterations);
+
+        mNlaIterations += quint64(nlaIterations);
+    }
+}
+
+//==============================================================================
+
+Solver::Solver::Statistics KinsolSolver::statistics() const
+{
+    // Return our statistics
+
+    Statistics res;
+
+    if (mStatisticsEnabled) {
+        res[OpenCOR::Solver::NlaIterationsStatistic] = mNlaIterations;
+    }
+
+    return res;
 }
 
 //==============================================================================
@@ -82,6 +82,7 @@ public:
     Solver::NlaSolver::ComputeSystemFunction computeSystem() const;
 
     void * userData() const;
+    void setUserData(void *pUserData);
 
 private:
     Solver::NlaSolver::ComputeSystemFunction mComputeSystem;
@@ -106,7 +107,6 @@ public:
     N_Vector onesVector() const;
 
     KinsolSolverUserData * userData() const;
-    void setUserData(KinsolSolverUserData *pUserData);
 
 private:
     void *mSolver;
@@ -130,10 +130,14 @@ public:
     ~KinsolSolver() override;
 
     void solve(ComputeSystemFunction pComputeSystem, double *pParameters,
-               int pSize, void *pUserData) override;
+               int pSize, void *pUserData, void **pData) override;
+
+    Statistics statistics() const override;
 
 private:
-    QHash<void *, KinsolSolverData *> mData;
+    QList<KinsolSolverData *> mData;
+
+    quint64 mNlaIterations = 0;
 };
 
 //==============================================================================
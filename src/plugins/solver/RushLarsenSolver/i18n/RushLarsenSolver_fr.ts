@@ -0,0 +1,11 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="fr_FR" sourcelanguage="en_GB">
+<context>
+    <name>OpenCOR::RushLarsenSolver::RushLarsenSolver</name>
+    <message>
+        <source>the &quot;Step&quot; property value could not be retrieved</source>
+        <translation>la valeur de la propriété &quot;Pas&quot; n&apos;a pas pu être retrouvée</translation>
+    </message>
+</context>
+</TS>
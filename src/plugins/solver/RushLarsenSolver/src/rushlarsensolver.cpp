@@ -0,0 +1,177 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Rush-Larsen solver
+//==============================================================================
+
+#include "rushlarsensolver.h"
+
+//==============================================================================
+
+#include <cmath>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace RushLarsenSolver {
+
+//==============================================================================
+
+RushLarsenSolver::~RushLarsenSolver()
+{
+    // Delete some internal objects
+
+    delete[] mCoefficients;
+}
+
+//==============================================================================
+
+bool RushLarsenSolver::needQuasiLinearCoefficients() const
+{
+    // We need the quasi-linear coefficients of our model, i.e. the coefficient
+    // b of each of its states which rate is of the form dx/dt = a+b*x
+
+    return true;
+}
+
+//==============================================================================
+
+void RushLarsenSolver::initialize(double pVoi, int pRatesStatesCount,
+                                  double *pConstants, double *pRates,
+                                  double *pStates, double *pAlgebraic,
+                                  ComputeRatesFunction pComputeRates)
+{
+    // Retrieve the solver's properties
+
+    if (mProperties.contains(StepId)) {
+        mStep = mProperties.value(StepId).toDouble();
+    } else {
+        emit error(tr(R"(the "Step" property value could not be retrieved)"));
+
+        return;
+    }
+
+    // Initialise the ODE solver itself
+
+    OdeSolver::initialize(pVoi, pRatesStatesCount, pConstants, pRates, pStates,
+                          pAlgebraic, pComputeRates);
+
+    // Keep track of the states that are not quasi-linear, i.e. those that we
+    // will integrate using the forward Euler method
+    // Note: if we couldn't get the quasi-linear coefficients of our model (e.g.
+    //       because it has some NLA systems), then we integrate all of our
+    //       states using the forward Euler method...
+
+    if (mComputeQuasiLinearCoefficients == nullptr) {
+        mQuasiLinearStates.clear();
+    }
+
+    delete[] mCoefficients;
+
+    mCoefficients = new double[mQuasiLinearStates.count()] {};
+
+    QVector<bool> quasiLinearStates(pRatesStatesCount, false);
+
+    for (auto quasiLinearState : mQuasiLinearStates) {
+        quasiLinearStates[quasiLinearState] = true;
+    }
+
+    mOtherStates.clear();
+
+    for (int i = 0; i < pRatesStatesCount; ++i) {
+        if (!quasiLinearStates[i]) {
+            mOtherStates << i;
+        }
+    }
+}
+
+//==============================================================================
+
+void RushLarsenSolver::solve(double &pVoi, double pVoiEnd) const
+{
+    // For a state which rate is of the form dx/dt = a+b*x:
+    //     x_n+1 = x_n + f(t_n, Y_n) * (exp(b * h)-1) / b
+    // and for any other state:
+    //     x_n+1 = x_n + h * f(t_n, Y_n)
+
+    double voiStart = pVoi;
+
+    int stepNumber = 0;
+    double realStep = mStep;
+    int quasiLinearStatesCount = mQuasiLinearStates.count();
+    const int *quasiLinearStates = mQuasiLinearStates.constData();
+    int otherStatesCount = mOtherStates.count();
+    const int *otherStates = mOtherStates.constData();
+
+    while (!qFuzzyCompare(pVoi, pVoiEnd)) {
+        // Check that the time step is correct
+
+        if (pVoi+realStep > pVoiEnd) {
+            realStep = pVoiEnd-pVoi;
+        }
+
+        // Compute f(t_n, Y_n) and, if possible, our quasi-linear coefficients
+
+        if (mComputeQuasiLinearCoefficients != nullptr) {
+            mComputeQuasiLinearCoefficients(pVoi, mConstants, mRates, mStates,
+                                            mAlgebraic, mCoefficients);
+        } else {
+            mComputeRates(pVoi, mConstants, mRates, mStates, mAlgebraic);
+        }
+
+        // Compute Y_n+1
+        // Note: if b is zero, then our exponential update reduces to a forward
+        //       Euler step...
+
+        for (int i = 0; i < quasiLinearStatesCount; ++i) {
+            int state = quasiLinearStates[i];
+            double coefficient = mCoefficients[i];
+
+            if (qIsNull(coefficient)) {
+                mStates[state] += realStep*mRates[state];
+            } else {
+                mStates[state] += mRates[state]*std::expm1(coefficient*realStep)/coefficient;
+            }
+        }
+
+        for (int i = 0; i < otherStatesCount; ++i) {
+            int state = otherStates[i];
+
+            mStates[state] += realStep*mRates[state];
+        }
+
+        // Advance through time
+
+        if (!qFuzzyCompare(realStep, mStep)) {
+            pVoi = pVoiEnd;
+        } else {
+            pVoi = voiStart+(++stepNumber)*mStep;
+        }
+    }
+}
+
+//==============================================================================
+
+} // namespace RushLarsenSolver
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
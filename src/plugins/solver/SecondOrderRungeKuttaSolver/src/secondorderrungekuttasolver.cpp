@@ -39,6 +39,15 @@ SecondOrderRungeKuttaSolver::~SecondOrderRungeKuttaSolver()
 
 //==============================================================================
 
+Solver::FixedStepMethod SecondOrderRungeKuttaSolver::fixedStepMethod() const
+{
+    // Return our fixed-step method
+
+    return Solver::FixedStepMethod::SecondOrderRungeKutta;
+}
+
+//==============================================================================
+
 void SecondOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
                                              double *pConstants,
                                              double *pRates, double *pStates,
@@ -71,6 +80,15 @@ void SecondOrderRungeKuttaSolver::initialize(double pVoi, int pRatesStatesCount,
 
 void SecondOrderRungeKuttaSolver::solve(double &pVoi, double pVoiEnd) const
 {
+    // Use our integrator, if we have one
+
+    if (mIntegrate != nullptr) {
+        mIntegrate(&pVoi, pVoiEnd, mStep, mConstants, mRates, mStates, mAlgebraic,
+                   mYk1, nullptr, nullptr);
+
+        return;
+    }
+
     // k1 = h * f(t_n, Y_n)
     // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
     // Y_n+1 = Y_n + k2
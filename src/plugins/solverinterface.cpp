@@ -25,18 +25,24 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
-void doNonLinearSolve(char *pRuntime,
+void doNonLinearSolve(void *pNlaSolverHandle,
                       void (*pFunction)(double *, double *, void *),
                       double *pParameters, int pSize, void *pUserData)
 {
     // Retrieve the NLA solver which we should use and solve our NLA system
-    // Note: we should always have an NLA solver, but better be safe than
-    //       sorry...
-
-    OpenCOR::Solver::NlaSolver *nlaSolver = OpenCOR::Solver::nlaSolver(pRuntime);
-
-    if (nlaSolver != nullptr) {
-        nlaSolver->solve(pFunction, pParameters, pSize, pUserData);
+    // Note #1: pNlaSolverHandle is the address of the runtime's handle for the
+    //          NLA system to solve, which was hard-coded in the runtime's code.
+    //          That handle gives us both our NLA solver and the data that our
+    //          NLA solver associated with our NLA system, if any, so no lookup
+    //          is needed...
+    // Note #2: we should always have an NLA solver, but better be safe than
+    //          sorry...
+
+    auto nlaSolverHandle = static_cast<OpenCOR::Solver::NlaSolverHandle *>(pNlaSolverHandle);
+
+    if (nlaSolverHandle->nlaSolver != nullptr) {
+        nlaSolverHandle->nlaSolver->solve(pFunction, pParameters, pSize,
+                                          pUserData, &nlaSolverHandle->data);
     } else {
         qWarning("WARNING | %s:%d: no NLA solver could be found.", __FILE__, __LINE__);
     }
@@ -52,7 +58,7 @@ extern "C" Q_DECL_EXPORT int solverInterfaceVersion()
 {
     // Version of the solver interface
 
-    return 2;
+    return 11;
 }
 
 //==============================================================================
@@ -70,6 +76,25 @@ void Solver::setProperties(const Properties &pProperties)
 
 //==============================================================================
 
+void Solver::setStatisticsEnabled(bool pStatisticsEnabled)
+{
+    // Set whether we should keep track of our statistics
+    // Note: this must be done before initialising the solver...
+
+    mStatisticsEnabled = pStatisticsEnabled;
+}
+
+//==============================================================================
+
+Solver::Statistics Solver::statistics() const
+{
+    // By default, we don't have any statistics
+
+    return {};
+}
+
+//==============================================================================
+
 void Solver::emitError(const QString &pErrorMessage)
 {
     // Let people know that an error occured, but first reformat the error a
@@ -97,72 +122,154 @@ void Solver::emitError(const QString &pErrorMessage)
 
 //==============================================================================
 
-void OdeSolver::initialize(double pVoi, int pRatesStatesCount,
-                           double *pConstants, double *pRates, double *pStates,
-                           double *pAlgebraic,
-                           ComputeRatesFunction pComputeRates)
+bool OdeSolver::needJacobian() const
 {
-    Q_UNUSED(pVoi)
+    // By default, we don't need the Jacobian of our model
 
-    // Initialise the ODE solver
+    return false;
+}
 
-    mRatesStatesCount = pRatesStatesCount;
+//==============================================================================
 
-    mConstants = pConstants;
-    mRates = pRates;
-    mStates = pStates;
-    mAlgebraic = pAlgebraic;
+void OdeSolver::setJacobian(ComputeJacobianFunction pComputeJacobian,
+                            const QVector<int> &pJacobianRows,
+                            const QVector<int> &pJacobianColumns)
+{
+    // Set the function that computes the Jacobian of our model, as well as the
+    // row and column of each of its (non-zero) entries
+    // Note: this must be done before initialising the ODE solver...
 
-    mComputeRates = pComputeRates;
+    mComputeJacobian = pComputeJacobian;
+
+    mJacobianRows = pJacobianRows;
+    mJacobianColumns = pJacobianColumns;
 }
 
 //==============================================================================
 
-void OdeSolver::reinitialize(double pVoi)
+bool OdeSolver::needQuasiLinearCoefficients() const
 {
-    Q_UNUSED(pVoi)
+    // By default, we don't need the quasi-linear coefficients of our model
 
-    // Nothing to do by default...
+    return false;
 }
 
 //==============================================================================
 
-NlaSolver::~NlaSolver() = default;
+void OdeSolver::setQuasiLinearCoefficients(ComputeJacobianFunction pComputeQuasiLinearCoefficients,
+                                           const QVector<int> &pQuasiLinearStates)
+{
+    // Set the function that computes the rates of our model as well as the
+    // coefficient b of each of its states which rate is of the form
+    // dx/dt = a+b*x, with a and b independent of x, and the state to which
+    // each of those coefficients corresponds
+    // Note: this must be done before initialising the ODE solver...
+
+    mComputeQuasiLinearCoefficients = pComputeQuasiLinearCoefficients;
+
+    mQuasiLinearStates = pQuasiLinearStates;
+}
 
 //==============================================================================
 
-QString objectAddress(QObject *pObject)
+FixedStepMethod OdeSolver::fixedStepMethod() const
 {
-    // Return the given object's address as a string
+    // By default, we are not a fixed-step ODE solver, or at least not one that
+    // can use an integrator
 
-    return QString::number(quint64(pObject));
+    return FixedStepMethod::None;
 }
 
 //==============================================================================
 
-NlaSolver * nlaSolver(const QString &pObjectAddress)
+void OdeSolver::setIntegrator(IntegrateFunction pIntegrate)
 {
-    // Return the runtime's NLA solver
+    // Set the function that integrates our model from a given point to another
+    // using our fixed-step method, i.e. a function that does what our solve()
+    // method would do, but with our model's rates inlined in it
+    // Note #1: this must be done before initialising the ODE solver...
+    // Note #2: our integrator doesn't allocate anything itself, so we must
+    //          give it the arrays that our fixed-step method needs, i.e. the
+    //          ones that we use in our solve() method, which are allocated
+    //          once when we get initialised...
+
+    mIntegrate = pIntegrate;
+}
 
-    QObject *object = reinterpret_cast<NlaSolver *>(QVariant(pObjectAddress).toULongLong());
+//==============================================================================
+
+bool OdeSolver::needRootInformation() const
+{
+    // By default, we don't need the root information of our model
 
-    return reinterpret_cast<NlaSolver *>(QVariant(object->objectName()).toULongLong());
+    return false;
 }
 
 //==============================================================================
 
-void setNlaSolver(QObject *pObject, NlaSolver *pNlaSolver)
+void OdeSolver::setRootInformation(ComputeRootInformationFunction pComputeRootInformation,
+                                   int pConditionVariablesCount)
 {
-    // Keep track of the runtime's NLA solver
-    // Note: normally, we would use QObject::setProperty(), but it doesn't play
-    //       well on Windows without a GUI (see https://bit.ly/2YCpzew). So,
-    //       instead, we use QObject::setObjectName() (!!)...
+    // Set the function that computes the condition variables of our model,
+    // i.e. the functions which roots are the points at which the piecewise
+    // definitions of our model are discontinuous, as well as the number of
+    // those condition variables
+    // Note: this must be done before initialising the ODE solver...
 
-    pObject->setObjectName(objectAddress(pNlaSolver));
+    mComputeRootInformation = pComputeRootInformation;
+
+    mConditionVariablesCount = pConditionVariablesCount;
 }
 
 //==============================================================================
 
+NlaSolver * OdeSolver::wrapNlaSolver(NlaSolver *pNlaSolver)
+{
+    // Return the NLA solver that our model should use, given the one that was
+    // selected for it
+    // Note: by default, our model uses the selected NLA solver, but an ODE
+    //       solver that integrates our NLA systems along with our ODEs (i.e. a
+    //       DAE solver) will want to intercept the calls to it...
+
+    return pNlaSolver;
+}
+
+//==============================================================================
+
+void OdeSolver::initialize(double pVoi, int pRatesStatesCount,
+                           double *pConstants, double *pRates, double *pStates,
+                           double *pAlgebraic,
+                           ComputeRatesFunction pComputeRates)
+{
+    Q_UNUSED(pVoi)
+
+    // Initialise the ODE solver
+
+    mRatesStatesCount = pRatesStatesCount;
+
+    mConstants = pConstants;
+    mRates = pRates;
+    mStates = pStates;
+    mAlgebraic = pAlgebraic;
+
+    mComputeRates = pComputeRates;
+}
+
+//==============================================================================
+
+void OdeSolver::reinitialize(double pVoi)
+{
+    Q_UNUSED(pVoi)
+
+    // Nothing to do by default...
+}
+
+//==============================================================================
+
+NlaSolver::~NlaSolver() = default;
+
+//==============================================================================
+
 Property::Property(Type pType, const QString &pId,
                    const Descriptions &pDescriptions,
                    const QStringList &pListValues,
@@ -30,10 +30,11 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include <QVariant>
+#include <QVector>
 
 //==============================================================================
 
-extern "C" void doNonLinearSolve(char *pRuntime,
+extern "C" void doNonLinearSolve(void *pNlaSolverHandle,
                                  void (*pFunction)(double *, double *, void *),
                                  double *pParameters, int pSize,
                                  void *pUserData);
@@ -51,30 +52,85 @@ enum {
 
 //==============================================================================
 
+static const auto StepsStatistic               = QStringLiteral("steps");
+static const auto RhsEvaluationsStatistic      = QStringLiteral("rhs_evaluations");
+static const auto JacobianEvaluationsStatistic = QStringLiteral("jacobian_evaluations");
+static const auto LinearSolverSetupsStatistic  = QStringLiteral("linear_solver_setups");
+static const auto ErrorTestFailuresStatistic   = QStringLiteral("error_test_failures");
+static const auto NlaIterationsStatistic       = QStringLiteral("nla_iterations");
+
+//==============================================================================
+
 class Solver : public QObject
 {
     Q_OBJECT
 
 public:
     using Properties = QMap<QString, QVariant>;
+    using Statistics = QMap<QString, quint64>;
 
     void setProperties(const Properties &pProperties);
 
+    void setStatisticsEnabled(bool pStatisticsEnabled);
+
+    virtual Statistics statistics() const;
+
     void emitError(const QString &pErrorMessage);
 
 protected:
     Properties mProperties;
 
+    bool mStatisticsEnabled = false;
+
 signals:
     void error(const QString &pErrorMessage);
 };
 
 //==============================================================================
 
+class NlaSolver;
+
+//==============================================================================
+
+enum class FixedStepMethod {
+    None,
+    ForwardEuler,
+    Heun,
+    SecondOrderRungeKutta,
+    FourthOrderRungeKutta
+};
+
+//==============================================================================
+
 class OdeSolver : public Solver
 {
 public:
     using ComputeRatesFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic);
+    using ComputeJacobianFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic, double *pJacobian);
+    using IntegrateFunction = void (*)(double *pVoi, double pVoiEnd, double pStep, double *pConstants, double *pRates, double *pStates, double *pAlgebraic, double *pWork1, double *pWork2, double *pWork3);
+    using ComputeRootInformationFunction = void (*)(double pVoi, double *pConstants, double *pRates, double *pStates, double *pAlgebraic, double *pConditionVariables);
+
+    virtual bool needJacobian() const;
+
+    void setJacobian(ComputeJacobianFunction pComputeJacobian,
+                     const QVector<int> &pJacobianRows,
+                     const QVector<int> &pJacobianColumns);
+
+    virtual bool needQuasiLinearCoefficients() const;
+
+    void setQuasiLinearCoefficients(ComputeJacobianFunction pComputeQuasiLinearCoefficients,
+                                    const QVector<int> &pQuasiLinearStates);
+
+    virtual FixedStepMethod fixedStepMethod() const;
+
+    void setIntegrator(IntegrateFunction pIntegrate);
+
+    virtual bool needRootInformation() const;
+
+    void setRootInformation(ComputeRootInformationFunction pComputeRootInformation,
+                            int pConditionVariablesCount);
+
+    virtual NlaSolver * wrapNlaSolver(NlaSolver *pNlaSolver);
 
     virtual void initialize(double pVoi, int pRatesStatesCount,
                             double *pConstants, double *pRates, double *pStates,
@@ -93,6 +149,21 @@ protected:
     double *mAlgebraic = nullptr;
 
     ComputeRatesFunction mComputeRates = nullptr;
+
+    ComputeJacobianFunction mComputeJacobian = nullptr;
+
+    QVector<int> mJacobianRows;
+    QVector<int> mJacobianColumns;
+
+    ComputeJacobianFunction mComputeQuasiLinearCoefficients = nullptr;
+
+    QVector<int> mQuasiLinearStates;
+
+    IntegrateFunction mIntegrate = nullptr;
+
+    ComputeRootInformationFunction mComputeRootInformation = nullptr;
+
+    int mConditionVariablesCount = 0;
 };
 
 //==============================================================================
@@ -105,17 +176,17 @@ public:
     using ComputeSystemFunction = void (*)(double *, double *, void *);
 
     virtual void solve(ComputeSystemFunction pComputeSystem,
-                       double *pParameters, int pSize,
-                       void *pUserData = nullptr) = 0;
+                       double *pParameters, int pSize, void *pUserData,
+                       void **pData) = 0;
 };
 
 //==============================================================================
 
-QString objectAddress(QObject *pObject);
-
-NlaSolver * nlaSolver(const QString &pObjectAddress);
-
-void setNlaSolver(QObject *pObject, NlaSolver *pNlaSolver);
+struct NlaSolverHandle
+{
+    NlaSolver *nlaSolver;
+    void *data;
+};
 
 //==============================================================================
 
@@ -29,14 +29,18 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "cellmlfile.h"
 #include "cellmlfileruntime.h"
+#include "cellmlfileruntimejacobian.h"
 #include "compilerengine.h"
+#include "compilerengineregistry.h"
 #include "corecliutils.h"
+#include "coreguiutils.h"
 #include "solverinterface.h"
 
 //==============================================================================
 
 #include <QRegularExpression>
 #include <QStringList>
+#include <QThread>
 
 //==============================================================================
 
@@ -254,7 +258,7 @@ CellmlFileRuntime::~CellmlFileRuntime()
     // Reset our properties
 
     try {
-        reset(false, true, true);
+        reset(true, true);
     } catch (...) {
     }
 }
@@ -265,7 +269,7 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
 {
     // Reset the runtime's properties
 
-    reset(true, true, pAll);
+    reset(true, pAll);
 
     // Retrieve the CellML model associated with the CellML file
 
@@ -289,7 +293,7 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
 
     if (pAll) {
         // Retrieve the number of constants, states/rates, algebraic variables
-        // in the model
+        // and condition variables in the model
         // Note: this is to avoid having to go through the code information an
         //       unnecessary number of times when we want to retrieve either of
         //       those numbers (e.g. see SimulationResults::addPoint())...
@@ -297,6 +301,7 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
         mConstantsCount = int(mCodeInformation->constantIndexCount());
         mStatesRatesCount = int(mCodeInformation->rateIndexCount());
         mAlgebraicCount = int(mCodeInformation->algebraicIndexCount());
+        mConditionVariablesCount = int(mCodeInformation->conditionVariableCount());
 
         // Go through the variables defined or referenced in our main CellML
         // file and do a mapping between the source of that variable and that
@@ -477,6 +482,12 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
     }
 
     // Generate the model code
+    // Note: the code of our model refers to the handle of each of its NLA
+    //       systems, if any, so we must know how many of them we need before
+    //       generating that code...
+
+    mNlaSolverHandles = QVector<Solver::NlaSolverHandle>(QString::fromStdWString(mCodeInformation->functionsString()).count("do_nonlinearsolve("),
+                                                        { mNlaSolver, nullptr });
 
     QString modelCode;
     QString functionsString = cleanCode(mCodeInformation->functionsString());
@@ -486,6 +497,33 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
 
         mAtLeastOneNlaSystem = true;
 
+        // Declare the handle of each of our NLA systems (see cleanCode())
+        // Note: our handles are external symbols, whose addresses we only
+        //       provide once our code has been compiled (see
+        //       retrieveFunctions()), so that our code doesn't depend on our
+        //       instance and can therefore be found in our object cache. We
+        //       refer to them through an array of pointers, so that their
+        //       addresses get relocated as 64-bit values, whatever the
+        //       code model. That array is also volatile, so that the compiler
+        //       cannot replace its elements with a direct reference to our
+        //       handles...
+
+        QString nlaSolverHandlesCode;
+
+        if (!mNlaSolverHandles.isEmpty()) {
+            QStringList nlaSolverHandles;
+
+            for (int i = 0, iMax = mNlaSolverHandles.count(); i < iMax; ++i) {
+                nlaSolverHandlesCode += QString("extern char nlaSolverHandle%1;\n").arg(i);
+
+                nlaSolverHandles << QString("&nlaSolverHandle%1").arg(i);
+            }
+
+            nlaSolverHandlesCode += "\n"
+                                    "static void * volatile nlaSolverHandles[] = { "+nlaSolverHandles.join(", ")+" };\n"
+                                    "\n";
+        }
+
         modelCode +=  "struct rootfind_info\n"
                       "{\n"
                       "    double aVOI;\n"
@@ -496,8 +534,9 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
                       "    double *aALGEBRAIC;\n"
                       "};\n"
                       "\n"
-                      "extern void doNonLinearSolve(char *, void (*)(double *, double *, void*), double *, int, void *);\n"
+                      "extern void doNonLinearSolve(void *, void (*)(double *, double *, void*), double *, int, void *);\n"
                       "\n"
+                     +nlaSolverHandlesCode
                      +functionsString
                      +"\n";
     }
@@ -526,14 +565,23 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
         }
     }
 
+    // Keep track of the body of our different compute functions, so that we
+    // can generate an ensemble version of them, if requested
+
+    mComputedConstantsCode = compCompConsts;
+    mVariablesCode = cleanCode(mCodeInformation->variablesString());
+    mRatesCode = cleanCode(mCodeInformation->ratesString());
+
     modelCode +=  methodCode("initializeConstants(double *CONSTANTS, double *RATES, double *STATES)",
                              initConsts)
                  +methodCode("computeComputedConstants(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
-                             compCompConsts)
+                             mComputedConstantsCode)
                  +methodCode("computeVariables(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *CONDVAR)",
-                             mCodeInformation->variablesString())
+                             mVariablesCode)
                  +methodCode("computeRates(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
-                             mCodeInformation->ratesString());
+                             mRatesCode)
+                 +methodCode("computeRootInformation(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *CONDVAR)",
+                             cleanCode(mCodeInformation->rootInformationString()));
 
     // Check whether the model code contains a definite integral, otherwise
     // compile it and check that everything went fine
@@ -541,39 +589,486 @@ void CellmlFileRuntime::update(CellmlFile *pCellmlFile, bool pAll)
     if (modelCode.contains("defint(func")) {
         mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
                                    tr("definite integrals are not supported"));
-    } else if (!mCompilerEngine->compileCode(modelCode)) {
-        mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
-                                   mCompilerEngine->error());
+    } else {
+        // Note #1: our compiler engine is shared with any other runtime that
+        //          uses the exact same model code, meaning that the same model
+        //          only gets compiled once. However, the code of a model that
+        //          needs an NLA solver gets linked against our NLA solver
+        //          handles (see retrieveFunctions()), so its compiler engine
+        //          cannot be shared. Its object can still be found in our
+        //          object cache though...
+        // Note #2: when running the GUI version of OpenCOR and unless our
+        //          model code has already been fully optimised (e.g. by
+        //          another runtime or in a previous session), we first
+        //          compile it using a fast optimisation level, so that we
+        //          don't block the GUI for too long, and then fully optimise
+        //          it in the background (see useOptimisedCode())...
+        // Note #3: when running the CLI version of OpenCOR or when being used
+        //          from Python outside of the GUI, we are bound to run our
+        //          model straightaway and to completion, so we might as well
+        //          fully optimise our model code straightaway...
+
+        Compiler::CompilerEngineRegistry *compilerEngineRegistry = Compiler::CompilerEngineRegistry::instance();
+        bool fullyOptimise =    (Core::mainWindow() == nullptr)
+                             || compilerEngineRegistry->hasCompiledCode(modelCode);
+
+        mCompilerEngine = compilerEngineRegistry->compilerEngine(modelCode,
+                                                                 fullyOptimise?
+                                                                     Compiler::CompilerEngine::OptimisationLevel::Full:
+                                                                     Compiler::CompilerEngine::OptimisationLevel::Fast,
+                                                                 !mAtLeastOneNlaSystem);
+
+        if (mCompilerEngine->hasError()) {
+            mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
+                                       mCompilerEngine->error());
+        } else if (!fullyOptimise) {
+            mOptimisedCompilerEngineThread = QThread::create([this, modelCode]() {
+                mOptimisedCompilerEngine = Compiler::CompilerEngineRegistry::instance()->compilerEngine(modelCode,
+                                                                                                        Compiler::CompilerEngine::OptimisationLevel::Full,
+                                                                                                        !mAtLeastOneNlaSystem);
+            });
+
+            mOptimisedCompilerEngineThread->start(QThread::LowPriority);
+        }
     }
 
     // Keep track of the ODE functions, but only if no issues were reported
 
     if (!mIssues.isEmpty()) {
-        reset(true, false, true);
-    } else {
-        // Add the symbol of any required external function, if any
+        reset(false, true);
+    } else if (!retrieveFunctions()) {
+        mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
+                                   tr("an unexpected problem occurred while trying to retrieve the model functions"));
+
+        reset(false, true);
+    }
+}
 
-        if (mAtLeastOneNlaSystem) {
-            mCompilerEngine->addFunction("doNonLinearSolve", reinterpret_cast<void *>(doNonLinearSolve));
+//==============================================================================
+
+bool CellmlFileRuntime::retrieveFunctions()
+{
+    // Add the symbol of any required external function and of our NLA solver
+    // handles, if any
+
+    if (mAtLeastOneNlaSystem) {
+        if (!mCompilerEngine->addFunction("doNonLinearSolve", reinterpret_cast<void *>(doNonLinearSolve))) {
+            return false;
         }
 
-        // Retrieve the ODE functions
+        for (int i = 0, iMax = mNlaSolverHandles.count(); i < iMax; ++i) {
+            if (!mCompilerEngine->addFunction(QString("nlaSolverHandle%1").arg(i),
+                                              mNlaSolverHandles.data()+i)) {
+                return false;
+            }
+        }
+    }
 
-        mInitializeConstants = reinterpret_cast<InitializeConstantsFunction>(mCompilerEngine->function("initializeConstants"));
-        mComputeComputedConstants = reinterpret_cast<ComputeComputedConstantsFunction>(mCompilerEngine->function("computeComputedConstants"));
-        mComputeVariables = reinterpret_cast<ComputeVariablesFunction>(mCompilerEngine->function("computeVariables"));
-        mComputeRates = reinterpret_cast<ComputeRatesFunction>(mCompilerEngine->function("computeRates"));
+    // Retrieve the ODE functions
 
-        // Make sure that we managed to retrieve all the ODE functions
+    mInitializeConstants = reinterpret_cast<InitializeConstantsFunction>(mCompilerEngine->function("initializeConstants"));
+    mComputeComputedConstants = reinterpret_cast<ComputeComputedConstantsFunction>(mCompilerEngine->function("computeComputedConstants"));
+    mComputeVariables = reinterpret_cast<ComputeVariablesFunction>(mCompilerEngine->function("computeVariables"));
+    mComputeRates = reinterpret_cast<ComputeRatesFunction>(mCompilerEngine->function("computeRates"));
+    mComputeRootInformation = reinterpret_cast<ComputeRootInformationFunction>(mCompilerEngine->function("computeRootInformation"));
 
-        if (   (mInitializeConstants == nullptr) || (mComputeComputedConstants == nullptr)
-            || (mComputeVariables == nullptr) || (mComputeRates == nullptr)) {
-            mIssues << CellmlFileIssue(CellmlFileIssue::Type::Error,
-                                       tr("an unexpected problem occurred while trying to retrieve the model functions"));
+    // Make sure that we managed to retrieve all the ODE functions
 
-            reset(true, false, true);
-        }
+    return    (mInitializeConstants != nullptr) && (mComputeComputedConstants != nullptr)
+           && (mComputeVariables != nullptr) && (mComputeRates != nullptr)
+           && (mComputeRootInformation != nullptr);
+}
+
+//==============================================================================
+
+bool CellmlFileRuntime::useOptimisedCode(bool pWait)
+{
+    // Use our fully optimised code, if it is (or, if requested, once it is)
+    // available
+    // Note: this must only be done when our functions are not in use, e.g.
+    //       between two runs (see Simulation::run())...
+
+    if (mOptimisedCompilerEngineThread == nullptr) {
+        return false;
+    }
+
+    if (pWait) {
+        mOptimisedCompilerEngineThread->wait();
+    } else if (!mOptimisedCompilerEngineThread->isFinished()) {
+        return false;
+    }
+
+    delete mOptimisedCompilerEngineThread;
+
+    mOptimisedCompilerEngineThread = nullptr;
+
+    // Swap our compiler engines and retrieve our (fully optimised) functions,
+    // unless our fully optimised code couldn't be compiled, in which case we
+    // keep using our current code
+    // Note: to keep using our current code, we restore our current functions
+    //       rather than retrieve them again since it would mean (re)adding the
+    //       symbol of our external functions and NLA solver handles, if any, to
+    //       our current compiler engine, which would fail...
+
+    Compiler::CompilerEngineRegistry *compilerEngineRegistry = Compiler::CompilerEngineRegistry::instance();
+    Compiler::CompilerEngine *compilerEngine = mCompilerEngine;
+    InitializeConstantsFunction initializeConstants = mInitializeConstants;
+    ComputeComputedConstantsFunction computeComputedConstants = mComputeComputedConstants;
+    ComputeVariablesFunction computeVariables = mComputeVariables;
+    ComputeRatesFunction computeRates = mComputeRates;
+    ComputeRootInformationFunction computeRootInformation = mComputeRootInformation;
+
+    mCompilerEngine = mOptimisedCompilerEngine;
+
+    mOptimisedCompilerEngine = nullptr;
+
+    if (mCompilerEngine->hasError() || !retrieveFunctions()) {
+        compilerEngineRegistry->release(mCompilerEngine);
+
+        mCompilerEngine = compilerEngine;
+
+        mInitializeConstants = initializeConstants;
+        mComputeComputedConstants = computeComputedConstants;
+        mComputeVariables = computeVariables;
+        mComputeRates = computeRates;
+        mComputeRootInformation = computeRootInformation;
+
+        return false;
+    }
+
+    compilerEngineRegistry->release(compilerEngine);
+
+    return true;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntime::compileEnsemble(int pSize)
+{
+    // Generate and compile an ensemble version of our compute functions, i.e.
+    // a version that computes pSize instances of our model at once
+    // Note #1: the data of our instances is expected to be stored as a
+    //          structure of arrays, i.e. the value of the ith constant of the
+    //          nth instance is to be found at CONSTANTS[i*pSize+n]. This means
+    //          that our ensemble functions have the same signature as our
+    //          'normal' ones, so they can be given as is to our fixed-step
+    //          ODE solvers (using statesCount()*pSize as the number of
+    //          states), while allowing the compiler to vectorise them. This is,
+    //          for example, what a simulation sweep does (see
+    //          SimulationSweep::run())...
+    // Note #2: we don't support models that need an NLA solver since our NLA
+    //          systems are solved for one instance at a time...
+
+    if (!isValid() || mAtLeastOneNlaSystem || (pSize <= 0)) {
+        return false;
+    }
+
+    // Nothing to do if we have already compiled an ensemble of the given size
+
+    if (pSize == mEnsembleSize) {
+        return true;
+    }
+
+    resetEnsemble();
+
+    // Generate and compile our ensemble code
+
+    QString modelCode =  methodCode("computeEnsembleComputedConstants(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
+                                    ensembleCode(mComputedConstantsCode, pSize))
+                        +methodCode("computeEnsembleVariables(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *CONDVAR)",
+                                    ensembleCode(mVariablesCode, pSize))
+                        +methodCode("computeEnsembleRates(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
+                                    ensembleCode(mRatesCode, pSize));
+
+    mEnsembleCompilerEngine = Compiler::CompilerEngineRegistry::instance()->compilerEngine(modelCode);
+
+    if (mEnsembleCompilerEngine->hasError()) {
+        resetEnsemble();
+
+        return false;
+    }
+
+    // Retrieve our ensemble functions and make sure that we managed to
+    // retrieve all of them
+
+    mComputeEnsembleComputedConstants = reinterpret_cast<ComputeComputedConstantsFunction>(mEnsembleCompilerEngine->function("computeEnsembleComputedConstants"));
+    mComputeEnsembleVariables = reinterpret_cast<ComputeVariablesFunction>(mEnsembleCompilerEngine->function("computeEnsembleVariables"));
+    mComputeEnsembleRates = reinterpret_cast<ComputeRatesFunction>(mEnsembleCompilerEngine->function("computeEnsembleRates"));
+
+    if (   (mComputeEnsembleComputedConstants == nullptr)
+        || (mComputeEnsembleVariables == nullptr)
+        || (mComputeEnsembleRates == nullptr)) {
+        resetEnsemble();
+
+        return false;
+    }
+
+    mEnsembleSize = pSize;
+
+    return true;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntime::compileJacobian()
+{
+    // Generate and compile a function that computes the Jacobian of our model
+    // (see CellmlFileRuntimeJacobian), unless we have already tried to do so
+    // Note: we don't support models that need an NLA solver since the
+    //       derivatives of the variables that are computed by our NLA solver
+    //       are not known...
+
+    if (mJacobianCompiled) {
+        return mComputeJacobian != nullptr;
     }
+
+    mJacobianCompiled = true;
+
+    if (!isValid() || mAtLeastOneNlaSystem) {
+        return false;
+    }
+
+    // Generate and compile our Jacobian code
+
+    CellmlFileRuntimeJacobian jacobian(mRatesCode, mStatesRatesCount);
+
+    if (!jacobian.isValid()) {
+        return false;
+    }
+
+    mJacobianCompilerEngine = Compiler::CompilerEngineRegistry::instance()->compilerEngine(methodCode("computeJacobian(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *JACOBIAN)",
+                                                                                                      jacobian.code()));
+
+    if (mJacobianCompilerEngine->hasError()) {
+        resetJacobian();
+
+        mJacobianCompiled = true;
+
+        return false;
+    }
+
+    // Retrieve our Jacobian function and the position of its entries
+
+    mComputeJacobian = reinterpret_cast<ComputeJacobianFunction>(mJacobianCompilerEngine->function("computeJacobian"));
+
+    if (mComputeJacobian == nullptr) {
+        resetJacobian();
+
+        mJacobianCompiled = true;
+
+        return false;
+    }
+
+    mJacobianRows = jacobian.rows();
+    mJacobianColumns = jacobian.columns();
+
+    return true;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeJacobianFunction CellmlFileRuntime::computeJacobian() const
+{
+    // Return the computeJacobian method, if any
+
+    return mComputeJacobian;
+}
+
+//==============================================================================
+
+QVector<int> CellmlFileRuntime::jacobianRows() const
+{
+    // Return the row (i.e. rate) of each entry of our Jacobian
+
+    return mJacobianRows;
+}
+
+//==============================================================================
+
+QVector<int> CellmlFileRuntime::jacobianColumns() const
+{
+    // Return the column (i.e. state) of each entry of our Jacobian
+
+    return mJacobianColumns;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntime::compileQuasiLinearCoefficients()
+{
+    // Generate and compile a function that computes our rates as well as the
+    // coefficient b of each state which rate is of the form dx/dt = a+b*x,
+    // with a and b independent of x (see CellmlFileRuntimeJacobian), unless
+    // we have already tried to do so
+    // Note: like for our Jacobian, we don't support models that need an NLA
+    //       solver...
+
+    if (mQuasiLinearCoefficientsCompiled) {
+        return mComputeQuasiLinearCoefficients != nullptr;
+    }
+
+    mQuasiLinearCoefficientsCompiled = true;
+
+    if (!isValid() || mAtLeastOneNlaSystem) {
+        return false;
+    }
+
+    // Generate and compile our quasi-linear coefficients code
+
+    CellmlFileRuntimeJacobian quasiLinearCoefficients(mRatesCode, mStatesRatesCount,
+                                                      CellmlFileRuntimeJacobian::Mode::QuasiLinear);
+
+    if (!quasiLinearCoefficients.isValid()) {
+        return false;
+    }
+
+    mQuasiLinearCoefficientsCompilerEngine = Compiler::CompilerEngineRegistry::instance()->compilerEngine(methodCode("computeQuasiLinearCoefficients(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *JACOBIAN)",
+                                                                                                                    quasiLinearCoefficients.code()));
+
+    if (mQuasiLinearCoefficientsCompilerEngine->hasError()) {
+        resetQuasiLinearCoefficients();
+
+        mQuasiLinearCoefficientsCompiled = true;
+
+        return false;
+    }
+
+    // Retrieve our quasi-linear coefficients function and the state to which
+    // each of its coefficients corresponds
+
+    mComputeQuasiLinearCoefficients = reinterpret_cast<ComputeJacobianFunction>(mQuasiLinearCoefficientsCompilerEngine->function("computeQuasiLinearCoefficients"));
+
+    if (mComputeQuasiLinearCoefficients == nullptr) {
+        resetQuasiLinearCoefficients();
+
+        mQuasiLinearCoefficientsCompiled = true;
+
+        return false;
+    }
+
+    mQuasiLinearStates = quasiLinearCoefficients.columns();
+
+    return true;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeJacobianFunction CellmlFileRuntime::computeQuasiLinearCoefficients() const
+{
+    // Return the computeQuasiLinearCoefficients method, if any
+
+    return mComputeQuasiLinearCoefficients;
+}
+
+//==============================================================================
+
+QVector<int> CellmlFileRuntime::quasiLinearStates() const
+{
+    // Return the state to which each of our quasi-linear coefficients
+    // corresponds
+
+    return mQuasiLinearStates;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntime::compileIntegrator(Solver::FixedStepMethod pMethod)
+{
+    // Generate and compile a function that integrates our model from VOI to
+    // VOIEND using the given fixed-step method and a step of STEP, unless we
+    // have already tried to do so
+    // Note #1: that function does what the solve() method of the corresponding
+    //          ODE solver does, except that our rates are computed by a static
+    //          copy of our computeRates() function, which the compiler can
+    //          therefore inline in the integration loop, alongside the update
+    //          of our states (whose number is also known at compile time)...
+    // Note #2: we don't support models that need an NLA solver since solving
+    //          their NLA systems is bound to be much more costly than calling
+    //          computeRates() through a function pointer...
+
+    if (pMethod == mIntegratorMethod) {
+        return mIntegrate != nullptr;
+    }
+
+    resetIntegrator();
+
+    mIntegratorMethod = pMethod;
+
+    if (   !isValid() || mAtLeastOneNlaSystem || (mStatesRatesCount == 0)
+        || (pMethod == Solver::FixedStepMethod::None)) {
+        return false;
+    }
+
+    // Generate and compile our integrator code
+
+    mIntegratorCompilerEngine = Compiler::CompilerEngineRegistry::instance()->compilerEngine(integratorCode(pMethod));
+
+    if (mIntegratorCompilerEngine->hasError()) {
+        resetIntegrator();
+
+        mIntegratorMethod = pMethod;
+
+        return false;
+    }
+
+    // Retrieve our integrator function
+
+    mIntegrate = reinterpret_cast<IntegrateFunction>(mIntegratorCompilerEngine->function("integrate"));
+
+    if (mIntegrate == nullptr) {
+        resetIntegrator();
+
+        mIntegratorMethod = pMethod;
+
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::IntegrateFunction CellmlFileRuntime::integrate() const
+{
+    // Return the integrate method, if any
+
+    return mIntegrate;
+}
+
+//==============================================================================
+
+int CellmlFileRuntime::ensembleSize() const
+{
+    // Return the size of our ensemble, if any
+
+    return mEnsembleSize;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeComputedConstantsFunction CellmlFileRuntime::computeEnsembleComputedConstants() const
+{
+    // Return the ensemble computeComputedConstants() function, if any
+
+    return mComputeEnsembleComputedConstants;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeVariablesFunction CellmlFileRuntime::computeEnsembleVariables() const
+{
+    // Return the ensemble computeVariables() function, if any
+
+    return mComputeEnsembleVariables;
+}
+
+//==============================================================================
+
+CellmlFileRuntime::ComputeRatesFunction CellmlFileRuntime::computeEnsembleRates() const
+{
+    // Return the ensemble computeRates() function, if any
+
+    return mComputeEnsembleRates;
 }
 
 //==============================================================================
@@ -596,6 +1091,33 @@ bool CellmlFileRuntime::needNlaSolver() const
 
 //==============================================================================
 
+Solver::NlaSolver * CellmlFileRuntime::nlaSolver() const
+{
+    // Return the NLA solver used by the model
+
+    return mNlaSolver;
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::setNlaSolver(Solver::NlaSolver *pNlaSolver)
+{
+    // Set the NLA solver to be used by the model and reset the data that our
+    // previous NLA solver, if any, associated with our NLA systems
+    // Note: our model's code is linked against the handle of each of our NLA
+    //       systems (see retrieveFunctions()), so the new NLA solver gets used
+    //       straightaway...
+
+    mNlaSolver = pNlaSolver;
+
+    for (auto &nlaSolverHandle : mNlaSolverHandles) {
+        nlaSolverHandle.nlaSolver = pNlaSolver;
+        nlaSolverHandle.data = nullptr;
+    }
+}
+
+//==============================================================================
+
 void CellmlFileRuntime::importData(const QString &pName,
                                    const QStringList &pComponentHierarchy,
                                    int pIndex, double *pData)
@@ -644,6 +1166,16 @@ int CellmlFileRuntime::algebraicCount() const
 
 //==============================================================================
 
+int CellmlFileRuntime::conditionVariablesCount() const
+{
+    // Return the number of condition variables in the model, i.e. the number
+    // of (piecewise) conditions that may introduce a discontinuity
+
+    return mConditionVariablesCount;
+}
+
+//==============================================================================
+
 CellmlFileRuntime::InitializeConstantsFunction CellmlFileRuntime::initializeConstants() const
 {
     // Return the initializeConstants function
@@ -680,6 +1212,15 @@ CellmlFileRuntime::ComputeRatesFunction CellmlFileRuntime::computeRates() const
 
 //==============================================================================
 
+CellmlFileRuntime::ComputeRootInformationFunction CellmlFileRuntime::computeRootInformation() const
+{
+    // Return the computeRootInformation function
+
+    return mComputeRootInformation;
+}
+
+//==============================================================================
+
 CellmlFileIssues CellmlFileRuntime::issues() const
 {
     // Return the issue(s)
@@ -735,12 +1276,99 @@ void CellmlFileRuntime::resetFunctions()
     mComputeComputedConstants = nullptr;
     mComputeVariables = nullptr;
     mComputeRates = nullptr;
+    mComputeRootInformation = nullptr;
 }
 
 //==============================================================================
 
-void CellmlFileRuntime::reset(bool pRecreateCompilerEngine, bool pResetIssues,
-                              bool pResetAll)
+void CellmlFileRuntime::resetOptimisedCode()
+{
+    // Reset our fully optimised code, after making sure that it is not being
+    // compiled anymore
+
+    if (mOptimisedCompilerEngineThread != nullptr) {
+        mOptimisedCompilerEngineThread->wait();
+
+        delete mOptimisedCompilerEngineThread;
+
+        mOptimisedCompilerEngineThread = nullptr;
+    }
+
+    Compiler::CompilerEngineRegistry::instance()->release(mOptimisedCompilerEngine);
+
+    mOptimisedCompilerEngine = nullptr;
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::resetEnsemble()
+{
+    // Reset our ensemble
+
+    mEnsembleSize = 0;
+
+    Compiler::CompilerEngineRegistry::instance()->release(mEnsembleCompilerEngine);
+
+    mEnsembleCompilerEngine = nullptr;
+
+    mComputeEnsembleComputedConstants = nullptr;
+    mComputeEnsembleVariables = nullptr;
+    mComputeEnsembleRates = nullptr;
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::resetJacobian()
+{
+    // Reset our Jacobian
+
+    mJacobianCompiled = false;
+
+    Compiler::CompilerEngineRegistry::instance()->release(mJacobianCompilerEngine);
+
+    mJacobianCompilerEngine = nullptr;
+
+    mComputeJacobian = nullptr;
+
+    mJacobianRows.clear();
+    mJacobianColumns.clear();
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::resetQuasiLinearCoefficients()
+{
+    // Reset our quasi-linear coefficients
+
+    mQuasiLinearCoefficientsCompiled = false;
+
+    Compiler::CompilerEngineRegistry::instance()->release(mQuasiLinearCoefficientsCompilerEngine);
+
+    mQuasiLinearCoefficientsCompilerEngine = nullptr;
+
+    mComputeQuasiLinearCoefficients = nullptr;
+
+    mQuasiLinearStates.clear();
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::resetIntegrator()
+{
+    // Reset our integrator
+
+    mIntegratorMethod = Solver::FixedStepMethod::None;
+
+    Compiler::CompilerEngineRegistry::instance()->release(mIntegratorCompilerEngine);
+
+    mIntegratorCompilerEngine = nullptr;
+
+    mIntegrate = nullptr;
+}
+
+//==============================================================================
+
+void CellmlFileRuntime::reset(bool pResetIssues, bool pResetAll)
 {
     // Reset all of the runtime's properties
 
@@ -748,15 +1376,23 @@ void CellmlFileRuntime::reset(bool pRecreateCompilerEngine, bool pResetIssues,
 
     resetCodeInformation();
 
-    delete mCompilerEngine;
+    resetOptimisedCode();
 
-    if (pRecreateCompilerEngine) {
-        mCompilerEngine = new Compiler::CompilerEngine();
-    } else {
-        mCompilerEngine = nullptr;
-    }
+    Compiler::CompilerEngineRegistry::instance()->release(mCompilerEngine);
+
+    mCompilerEngine = nullptr;
+
+    mNlaSolverHandles.clear();
 
     resetFunctions();
+    resetEnsemble();
+    resetJacobian();
+    resetQuasiLinearCoefficients();
+    resetIntegrator();
+
+    mComputedConstantsCode = QString();
+    mVariablesCode = QString();
+    mRatesCode = QString();
 
     if (pResetIssues) {
         mIssues.clear();
@@ -885,6 +1521,190 @@ QString CellmlFileRuntime::methodCode(const QString &pCodeSignature,
 
 //==============================================================================
 
+QString CellmlFileRuntime::ensembleCode(const QString &pCodeBody, int pSize)
+{
+    // Generate and return the ensemble version of the given code body, i.e.
+    // loop over our pSize instances and have each array access refer to the
+    // data of the current instance (see compileEnsemble())
+    // Note: this includes our condition variables, which means that the
+    //       CONDVAR array given to an ensemble function must also hold the
+    //       condition variables of all our instances...
+
+    if (pCodeBody.isEmpty()) {
+        return {};
+    }
+
+    static const QRegularExpression ArrayAccessRegEx = QRegularExpression(R"(\b(CONSTANTS|RATES|STATES|ALGEBRAIC|CONDVAR)\[(\d+)\])");
+
+    QString codeBody;
+    int position = 0;
+    QRegularExpressionMatchIterator arrayAccessIter = ArrayAccessRegEx.globalMatch(pCodeBody);
+
+    while (arrayAccessIter.hasNext()) {
+        QRegularExpressionMatch arrayAccess = arrayAccessIter.next();
+
+        codeBody += pCodeBody.midRef(position, arrayAccess.capturedStart()-position);
+        codeBody += QString("%1[%2+n]").arg(arrayAccess.captured(1))
+                                       .arg(arrayAccess.captured(2).toLongLong()*pSize);
+
+        position = arrayAccess.capturedEnd();
+    }
+
+    codeBody += pCodeBody.midRef(position);
+
+    return QString("for (int n = 0; n < %1; ++n) {\n").arg(pSize)
+          +codeBody
+          +QString("%1}\n").arg(codeBody.endsWith('\n')?"":"\n");
+}
+
+//==============================================================================
+
+QString CellmlFileRuntime::integratorCode(Solver::FixedStepMethod pMethod)
+{
+    // Generate and return the code for our integrator (see compileIntegrator()
+    // and the solve() method of our fixed-step ODE solvers)
+    // Note: the arrays that our fixed-step method needs are given to us (as
+    //       WORK1, WORK2 and WORK3) by the ODE solver that uses our integrator
+    //       rather than being allocated on the stack, since our model may have
+    //       too many states for the stack of the thread in which it is being
+    //       simulated. Those arrays are distinct from our other arrays, hence
+    //       they are declared as restrict...
+
+    QString arrays;
+    QString step;
+
+    switch (pMethod) {
+    case Solver::FixedStepMethod::None:
+        return {};
+    case Solver::FixedStepMethod::ForwardEuler:
+        // Y_n+1 = Y_n + h * f(t_n, Y_n)
+
+        step = "        computeRates(voi, CONSTANTS, RATES, STATES, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            STATES[i] += realStep*RATES[i];\n"
+               "        }\n";
+
+        break;
+    case Solver::FixedStepMethod::Heun:
+        // k = h * f(t_n, Y_n)
+        // Y_n+1 = Y_n + h / 2 * ( f(t_n, Y_n) + f(t_n + h, Y_n + k) )
+
+        arrays = "    double *k = WORK1;\n"
+                 "    double *yk = WORK2;\n";
+        step = "        computeRates(voi, CONSTANTS, RATES, STATES, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            k[i] = RATES[i];\n"
+               "            yk[i] = STATES[i]+realStep*RATES[i];\n"
+               "        }\n"
+               "\n"
+               "        computeRates(voi+realStep, CONSTANTS, RATES, yk, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            STATES[i] += 0.5*realStep*(k[i]+RATES[i]);\n"
+               "        }\n";
+
+        break;
+    case Solver::FixedStepMethod::SecondOrderRungeKutta:
+        // k1 = h * f(t_n, Y_n)
+        // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
+        // Y_n+1 = Y_n + k2
+
+        arrays = "    double *yk1 = WORK1;\n";
+        step = "        computeRates(voi, CONSTANTS, RATES, STATES, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            yk1[i] = STATES[i]+0.5*realStep*RATES[i];\n"
+               "        }\n"
+               "\n"
+               "        computeRates(voi+0.5*realStep, CONSTANTS, RATES, yk1, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            STATES[i] += realStep*RATES[i];\n"
+               "        }\n";
+
+        break;
+    case Solver::FixedStepMethod::FourthOrderRungeKutta:
+        // k1 = h * f(t_n, Y_n)
+        // k2 = h * f(t_n + h / 2, Y_n + k1 / 2)
+        // k3 = h * f(t_n + h / 2, Y_n + k2 / 2)
+        // k4 = h * f(t_n + h, Y_n + k3)
+        // Y_n+1 = Y_n + k1 / 6 + k2 / 3 + k3 / 3 + k4 / 6
+
+        arrays = "    double *k1 = WORK1;\n"
+                 "    double *k23 = WORK2;\n"
+                 "    double *yk123 = WORK3;\n";
+        step = "        computeRates(voi, CONSTANTS, RATES, STATES, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            k1[i] = RATES[i];\n"
+               "            yk123[i] = STATES[i]+0.5*realStep*RATES[i];\n"
+               "        }\n"
+               "\n"
+               "        computeRates(voi+0.5*realStep, CONSTANTS, RATES, yk123, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            k23[i] = RATES[i];\n"
+               "            yk123[i] = STATES[i]+0.5*realStep*RATES[i];\n"
+               "        }\n"
+               "\n"
+               "        computeRates(voi+0.5*realStep, CONSTANTS, RATES, yk123, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            k23[i] += RATES[i];\n"
+               "            yk123[i] = STATES[i]+realStep*RATES[i];\n"
+               "        }\n"
+               "\n"
+               "        computeRates(voi+realStep, CONSTANTS, RATES, yk123, ALGEBRAIC);\n"
+               "\n"
+               "        for (int i = 0; i < %1; ++i) {\n"
+               "            STATES[i] += realStep*((k1[i]+RATES[i])/6.0+k23[i]/3.0);\n"
+               "        }\n";
+
+        break;
+    }
+
+    // Generate our integrator, which steps through time like our fixed-step
+    // ODE solvers do, i.e. using the same step and checks (qFuzzyCompare()
+    // being reimplemented as fuzzyCompare())
+
+    return  "static "+methodCode("computeRates(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC)",
+                                 mRatesCode)
+           +"static int fuzzyCompare(double p1, double p2)\n"
+            "{\n"
+            "    double absP1 = fabs(p1);\n"
+            "    double absP2 = fabs(p2);\n"
+            "\n"
+            "    return fabs(p1-p2)*1000000000000.0 <= ((absP1 < absP2)?absP1:absP2);\n"
+            "}\n"
+            "\n"
+           +methodCode("integrate(double *VOI, double VOIEND, double STEP, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double * restrict WORK1, double * restrict WORK2, double * restrict WORK3)",
+                       QString("    double voi = *VOI;\n"
+                               "    double voiStart = voi;\n"
+                               "    int stepNumber = 0;\n"
+                               "    double realStep = STEP;\n"
+                              +arrays
+                              +"\n"
+                               "    while (!fuzzyCompare(voi, VOIEND)) {\n"
+                               "        if (voi+realStep > VOIEND) {\n"
+                               "            realStep = VOIEND-voi;\n"
+                               "        }\n"
+                               "\n"
+                              +step
+                              +"\n"
+                               "        if (!fuzzyCompare(realStep, STEP)) {\n"
+                               "            voi = VOIEND;\n"
+                               "        } else {\n"
+                               "            voi = voiStart+(++stepNumber)*STEP;\n"
+                               "        }\n"
+                               "    }\n"
+                               "\n"
+                               "    *VOI = voi;\n").arg(mStatesRatesCount));
+}
+
+//==============================================================================
+
 QStringList CellmlFileRuntime::componentHierarchy(iface::cellml_api::CellMLElement *pElement)
 {
     // Make sure that we have a given element
@@ -950,8 +1770,21 @@ QString CellmlFileRuntime::cleanCode(const std::wstring &pCode)
     // own non-linear solve routine defined in our Solver interface, and add a
     // new parameter to all our calls to doNonLinearSolve() so that
     // doNonLinearSolve() can retrieve the correct instance of our NLA solver
+    // Note: that parameter is the address of the handle of the corresponding
+    //       NLA system (see update()), which means that doNonLinearSolve() can
+    //       retrieve both our NLA solver and the data that it associated with
+    //       that NLA system by simply dereferencing it, i.e. without any
+    //       lookup...
 
-    res.replace("do_nonlinearsolve(", QString(R"(doNonLinearSolve("%1", )").arg(Solver::objectAddress(this)));
+    static const QString DoNonLinearSolve = "do_nonlinearsolve(";
+
+    const QStringList codeParts = res.split(DoNonLinearSolve);
+
+    res = codeParts.first();
+
+    for (int i = 1, iMax = codeParts.count(); i < iMax; ++i) {
+        res += QString("doNonLinearSolve(nlaSolverHandles[%1], ").arg(i-1)+codeParts[i];
+    }
 
     return res;
 }
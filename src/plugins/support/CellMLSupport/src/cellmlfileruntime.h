@@ -27,15 +27,16 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "cellmlfileissue.h"
 #include "cellmlsupportglobal.h"
+#include "solverinterface.h"
 
 //==============================================================================
 
 #include <QIcon>
 #include <QList>
 #include <QMap>
+#include <QVector>
 #ifdef Q_OS_WIN
     #include <QSet>
-    #include <QVector>
 #endif
 
 //==============================================================================
@@ -49,6 +50,10 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+class QThread;
+
+//==============================================================================
+
 namespace OpenCOR {
 
 //==============================================================================
@@ -134,6 +139,9 @@ public:
     using ComputeComputedConstantsFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
     using ComputeVariablesFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
     using ComputeRatesFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC);
+    using ComputeJacobianFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *JACOBIAN);
+    using ComputeRootInformationFunction = void (*)(double VOI, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *CONDVAR);
+    using IntegrateFunction = void (*)(double *VOI, double VOIEND, double STEP, double *CONSTANTS, double *RATES, double *STATES, double *ALGEBRAIC, double *WORK1, double *WORK2, double *WORK3);
 
     explicit CellmlFileRuntime(CellmlFile *pCellmlFile);
     ~CellmlFileRuntime() override;
@@ -144,6 +152,9 @@ public:
 
     bool needNlaSolver() const;
 
+    Solver::NlaSolver * nlaSolver() const;
+    void setNlaSolver(Solver::NlaSolver *pNlaSolver);
+
     void importData(const QString &pName,
                     const QStringList &pComponentHierarchy, int pIndex,
                     double *pData);
@@ -152,11 +163,40 @@ public:
     int statesCount() const;
     int ratesCount() const;
     int algebraicCount() const;
+    int conditionVariablesCount() const;
 
     InitializeConstantsFunction initializeConstants() const;
     ComputeComputedConstantsFunction computeComputedConstants() const;
     ComputeVariablesFunction computeVariables() const;
     ComputeRatesFunction computeRates() const;
+    ComputeRootInformationFunction computeRootInformation() const;
+
+    bool useOptimisedCode(bool pWait = false);
+
+    bool compileEnsemble(int pSize);
+
+    int ensembleSize() const;
+
+    ComputeComputedConstantsFunction computeEnsembleComputedConstants() const;
+    ComputeVariablesFunction computeEnsembleVariables() const;
+    ComputeRatesFunction computeEnsembleRates() const;
+
+    bool compileJacobian();
+
+    ComputeJacobianFunction computeJacobian() const;
+
+    QVector<int> jacobianRows() const;
+    QVector<int> jacobianColumns() const;
+
+    bool compileQuasiLinearCoefficients();
+
+    ComputeJacobianFunction computeQuasiLinearCoefficients() const;
+
+    QVector<int> quasiLinearStates() const;
+
+    bool compileIntegrator(Solver::FixedStepMethod pMethod);
+
+    IntegrateFunction integrate() const;
 
     CellmlFileIssues issues() const;
 
@@ -168,14 +208,21 @@ public:
 private:
     bool mAtLeastOneNlaSystem = false;
 
+    Solver::NlaSolver *mNlaSolver = nullptr;
+    QVector<Solver::NlaSolverHandle> mNlaSolverHandles;
+
     ObjRef<iface::cellml_services::CodeInformation> mCodeInformation;
 
     int mConstantsCount = 0;
     int mStatesRatesCount = 0;
     int mAlgebraicCount = 0;
+    int mConditionVariablesCount = 0;
 
     Compiler::CompilerEngine *mCompilerEngine = nullptr;
 
+    QThread *mOptimisedCompilerEngineThread = nullptr;
+    Compiler::CompilerEngine *mOptimisedCompilerEngine = nullptr;
+
     CellmlFileIssues mIssues;
 
     CellmlFileRuntimeParameter *mVoi = nullptr;
@@ -185,16 +232,59 @@ private:
     ComputeComputedConstantsFunction mComputeComputedConstants = nullptr;
     ComputeVariablesFunction mComputeVariables = nullptr;
     ComputeRatesFunction mComputeRates = nullptr;
+    ComputeRootInformationFunction mComputeRootInformation = nullptr;
+
+    QString mComputedConstantsCode;
+    QString mVariablesCode;
+    QString mRatesCode;
+
+    int mEnsembleSize = 0;
+
+    Compiler::CompilerEngine *mEnsembleCompilerEngine = nullptr;
+
+    ComputeComputedConstantsFunction mComputeEnsembleComputedConstants = nullptr;
+    ComputeVariablesFunction mComputeEnsembleVariables = nullptr;
+    ComputeRatesFunction mComputeEnsembleRates = nullptr;
+
+    bool mJacobianCompiled = false;
+
+    Compiler::CompilerEngine *mJacobianCompilerEngine = nullptr;
+
+    ComputeJacobianFunction mComputeJacobian = nullptr;
+
+    QVector<int> mJacobianRows;
+    QVector<int> mJacobianColumns;
+
+    bool mQuasiLinearCoefficientsCompiled = false;
+
+    Compiler::CompilerEngine *mQuasiLinearCoefficientsCompilerEngine = nullptr;
+
+    ComputeJacobianFunction mComputeQuasiLinearCoefficients = nullptr;
+
+    QVector<int> mQuasiLinearStates;
+
+    Solver::FixedStepMethod mIntegratorMethod = Solver::FixedStepMethod::None;
+
+    Compiler::CompilerEngine *mIntegratorCompilerEngine = nullptr;
+
+    IntegrateFunction mIntegrate = nullptr;
 
     void resetCodeInformation();
 
     void resetFunctions();
+    void resetOptimisedCode();
+    void resetEnsemble();
+    void resetJacobian();
+    void resetQuasiLinearCoefficients();
+    void resetIntegrator();
 
-    void reset(bool pRecreateCompilerEngine, bool pResetIssues, bool pResetAll);
+    void reset(bool pResetIssues, bool pResetAll);
 
     void couldNotGenerateModelCodeIssue(const QString &pExtraInfo);
     void unknownProblemDuringModelCodeGenerationIssue();
 
+    bool retrieveFunctions();
+
     void checkCodeInformation(iface::cellml_services::CodeInformation *pCodeInformation);
 
     void retrieveCodeInformation(iface::cellml_api::Model *pModel);
@@ -203,6 +293,8 @@ private:
     QString methodCode(const QString &pCodeSignature, const QString &pCodeBody);
     QString methodCode(const QString &pCodeSignature,
                        const std::wstring &pCodeBody);
+    QString ensembleCode(const QString &pCodeBody, int pSize);
+    QString integratorCode(Solver::FixedStepMethod pMethod);
 
     QStringList componentHierarchy(iface::cellml_api::CellMLElement *pElement);
 };
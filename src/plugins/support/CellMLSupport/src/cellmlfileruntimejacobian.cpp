@@ -0,0 +1,883 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CellML file runtime Jacobian
+//==============================================================================
+
+#include "cellmlfileruntimejacobian.h"
+
+//==============================================================================
+
+#include <QMap>
+#include <QRegularExpression>
+
+//==============================================================================
+
+#include <algorithm>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CellMLSupport {
+
+//==============================================================================
+
+static const auto Algebraic = QStringLiteral("ALGEBRAIC");
+static const auto Constants = QStringLiteral("CONSTANTS");
+static const auto Rates     = QStringLiteral("RATES");
+static const auto States    = QStringLiteral("STATES");
+static const auto Voi       = QStringLiteral("VOI");
+
+//==============================================================================
+
+CellmlFileRuntimeJacobian::CellmlFileRuntimeJacobian(const QString &pRatesCode,
+                                                     int pStatesCount,
+                                                     Mode pMode) :
+    mStatesCount(pStatesCount)
+{
+    // Generate the code that computes the Jacobian of our model, i.e. the
+    // partial derivative of each rate with respect to each state
+    // Note #1: the given rates code consists of statements of the form
+    //          ALGEBRAIC[i] = ...; or RATES[i] = ...;, which we differentiate
+    //          symbolically (using the chain rule for ALGEBRAIC[i] and
+    //          RATES[i] in right hand sides), keeping track of the states on
+    //          which each variable depends. This means that we only generate
+    //          code for partial derivatives that are (structurally) non-zero
+    //          and, therefore, that our Jacobian is stored as a sparse matrix
+    //          (in compressed sparse column order; see rows() and columns())...
+    // Note #2: should the given rates code contain something that we don't
+    //          know how to differentiate (e.g. a call to our NLA solver or to
+    //          multi_min()), then we give up and our Jacobian is not valid...
+    // Note #3: in quasi-linear mode, we only generate the diagonal entries of
+    //          our Jacobian for the states which rate is linear in them, i.e.
+    //          of the form dx/dt = a+b*x where a and b don't depend on x (e.g.
+    //          a Hodgkin-Huxley gate). Those entries are the b coefficients,
+    //          which we can compute symbolically since we only differentiate
+    //          (intermediate) variables that are linear in the state we are
+    //          interested in...
+
+    if (!tokenize(pRatesCode)) {
+        return;
+    }
+
+    QString derivativesCode;
+    QMap<qint64, QString> jacobian;
+
+    while (mToken < mTokens.count()) {
+        // Parse our statement
+
+        QString array = token();
+
+        if ((array != Algebraic) && (array != Rates)) {
+            return;
+        }
+
+        ++mToken;
+
+        if (!acceptToken("[")) {
+            return;
+        }
+
+        bool ok;
+        int index = token().toInt(&ok);
+
+        if (!ok || (index < 0) || ((array == Rates) && (index >= mStatesCount))) {
+            return;
+        }
+
+        ++mToken;
+
+        if (!acceptToken("]") || !acceptToken("=")) {
+            return;
+        }
+
+        int node = parseTernary();
+
+        if ((node == -1) || !acceptToken(";")) {
+            return;
+        }
+
+        // Make sure that our variable hasn't already been computed
+
+        QString variable = CellmlFileRuntimeJacobian::variable(array, index);
+
+        if (mVariablesStates.contains(variable)) {
+            return;
+        }
+
+        // Differentiate our statement with respect to the states on which it
+        // depends (and in which it is linear, if we are in quasi-linear mode)
+
+        QList<int> nodeStates = states(node).values();
+        QSet<int> variableLinearStates;
+        QSet<int> variableDerivatives;
+
+        std::sort(nodeStates.begin(), nodeStates.end());
+
+        for (auto state : nodeStates) {
+            if (pMode == Mode::QuasiLinear) {
+                if (!isLinear(node, state)) {
+                    continue;
+                }
+
+                variableLinearStates << state;
+
+                if ((array == Rates) && (state != index)) {
+                    continue;
+                }
+            }
+
+            QString nodeDerivative = derivative(node, state, ok);
+
+            if (!ok) {
+                return;
+            }
+
+            if (!nodeDerivative.isEmpty()) {
+                QString variableDerivative = derivativeVariable(variable, state);
+
+                derivativesCode += QString("const double %1 = %2;\n").arg(variableDerivative,
+                                                                          nodeDerivative);
+
+                variableDerivatives << state;
+
+                if (array == Rates) {
+                    jacobian.insert(qint64(state)*mStatesCount+index, variableDerivative);
+                }
+            }
+        }
+
+        mVariablesStates.insert(variable, states(node));
+        mVariablesLinearStates.insert(variable, variableLinearStates);
+        mVariablesDerivatives.insert(variable, variableDerivatives);
+    }
+
+    // Generate our code, which first computes our rates (and therefore the
+    // algebraic variables on which our partial derivatives depend), then our
+    // partial derivatives and, finally, our Jacobian
+
+    mCode = pRatesCode;
+
+    if (!mCode.isEmpty() && !mCode.endsWith('\n')) {
+        mCode += '\n';
+    }
+
+    mCode += derivativesCode;
+
+    int jacobianIndex = 0;
+
+    for (auto entry = jacobian.constBegin(), entryEnd = jacobian.constEnd();
+         entry != entryEnd; ++entry) {
+        mCode += QString("JACOBIAN[%1] = %2;\n").arg(jacobianIndex++)
+                                                .arg(entry.value());
+
+        mRows << int(entry.key()%mStatesCount);
+        mColumns << int(entry.key()/mStatesCount);
+    }
+
+    mValid = true;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntimeJacobian::isValid() const
+{
+    // Return whether we are valid
+
+    return mValid;
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::code() const
+{
+    // Return our code
+
+    return mCode;
+}
+
+//==============================================================================
+
+QVector<int> CellmlFileRuntimeJacobian::rows() const
+{
+    // Return the row (i.e. rate) of each of our (non-zero) entries
+
+    return mRows;
+}
+
+//==============================================================================
+
+QVector<int> CellmlFileRuntimeJacobian::columns() const
+{
+    // Return the column (i.e. state) of each of our (non-zero) entries
+
+    return mColumns;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntimeJacobian::tokenize(const QString &pCode)
+{
+    // Split the given code into tokens
+
+    static const QRegularExpression NumberRegEx = QRegularExpression(R"((\d+\.?\d*|\.\d+)([eE][+-]?\d+)?)");
+    static const QRegularExpression IdentifierRegEx = QRegularExpression(R"([A-Za-z_]\w*)");
+    static const QStringList TwoCharacterOperators = { "&&", "||", "==", "!=", "<=", ">=" };
+    static const QString OneCharacterOperators = "+-*/()[],?:<>!;=";
+
+    for (int i = 0, iMax = pCode.length(); i < iMax;) {
+        if (pCode[i].isSpace()) {
+            ++i;
+
+            continue;
+        }
+
+        QRegularExpressionMatch match = NumberRegEx.match(pCode, i, QRegularExpression::NormalMatch,
+                                                          QRegularExpression::AnchoredMatchOption);
+
+        if (!match.hasMatch()) {
+            match = IdentifierRegEx.match(pCode, i, QRegularExpression::NormalMatch,
+                                          QRegularExpression::AnchoredMatchOption);
+        }
+
+        if (match.hasMatch()) {
+            mTokens << match.captured();
+
+            i = match.capturedEnd();
+        } else if (TwoCharacterOperators.contains(pCode.mid(i, 2))) {
+            mTokens << pCode.mid(i, 2);
+
+            i += 2;
+        } else if (OneCharacterOperators.contains(pCode[i])) {
+            mTokens << pCode[i];
+
+            ++i;
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::token() const
+{
+    // Return our current token, if any
+
+    return (mToken < mTokens.count())?
+               mTokens[mToken]:
+               QString();
+}
+
+//==============================================================================
+
+bool CellmlFileRuntimeJacobian::isToken(const QString &pToken) const
+{
+    // Return whether our current token is the given one
+
+    return (mToken < mTokens.count()) && (mTokens[mToken] == pToken);
+}
+
+//==============================================================================
+
+bool CellmlFileRuntimeJacobian::acceptToken(const QString &pToken)
+{
+    // Move to our next token, if our current token is the given one
+
+    if (isToken(pToken)) {
+        ++mToken;
+
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+
+int CellmlFileRuntimeJacobian::newNode(NodeType pType, const QString &pText,
+                                       int pIndex,
+                                       const QVector<int> &pArguments)
+{
+    // Create a new node and return its index
+
+    mNodes << Node { pType, pText, pIndex, pArguments };
+
+    return mNodes.count()-1;
+}
+
+//==============================================================================
+
+int CellmlFileRuntimeJacobian::parseTernary()
+{
+    // Parse a (possibly) ternary expression
+
+    int condition = parseBinary(0);
+
+    if ((condition == -1) || !acceptToken("?")) {
+        return condition;
+    }
+
+    int trueExpression = parseTernary();
+
+    if ((trueExpression == -1) || !acceptToken(":")) {
+        return -1;
+    }
+
+    int falseExpression = parseTernary();
+
+    if (falseExpression == -1) {
+        return -1;
+    }
+
+    return newNode(NodeType::Ternary, {}, -1,
+                   { condition, trueExpression, falseExpression });
+}
+
+//==============================================================================
+
+int CellmlFileRuntimeJacobian::parseBinary(int pLevel)
+{
+    // Parse a binary expression, using C's precedence rules
+
+    static const QList<QStringList> Operators = { { "||" },
+                                                  { "&&" },
+                                                  { "==", "!=" },
+                                                  { "<", ">", "<=", ">=" },
+                                                  { "+", "-" },
+                                                  { "*", "/" } };
+
+    if (pLevel == Operators.count()) {
+        return parseUnary();
+    }
+
+    int left = parseBinary(pLevel+1);
+
+    while ((left != -1) && Operators[pLevel].contains(token())) {
+        QString op = token();
+
+        ++mToken;
+
+        int right = parseBinary(pLevel+1);
+
+        if (right == -1) {
+            return -1;
+        }
+
+        left = newNode(NodeType::Binary, op, -1, { left, right });
+    }
+
+    return left;
+}
+
+//==============================================================================
+
+int CellmlFileRuntimeJacobian::parseUnary()
+{
+    // Parse a (possibly) unary expression
+
+    if (isToken("-") || isToken("+") || isToken("!")) {
+        QString op = token();
+
+        ++mToken;
+
+        int operand = parseUnary();
+
+        if (operand == -1) {
+            return -1;
+        }
+
+        return newNode(NodeType::Unary, op, -1, { operand });
+    }
+
+    return parsePrimary();
+}
+
+//==============================================================================
+
+int CellmlFileRuntimeJacobian::parsePrimary()
+{
+    // Parse a primary expression, i.e. a parenthesised expression, a number,
+    // our VOI, an array element or a function call
+
+    if (acceptToken("(")) {
+        int expression = parseTernary();
+
+        if ((expression == -1) || !acceptToken(")")) {
+            return -1;
+        }
+
+        return expression;
+    }
+
+    QString name = token();
+
+    if (name.isEmpty()) {
+        return -1;
+    }
+
+    ++mToken;
+
+    if (name[0].isDigit() || (name[0] == '.')) {
+        return newNode(NodeType::Number, name);
+    }
+
+    if (name == Voi) {
+        return newNode(NodeType::Voi, name);
+    }
+
+    if (acceptToken("[")) {
+        // We are dealing with an array element, so make sure that it is one
+        // that we know about and, if it is an algebraic variable or a rate,
+        // that it has already been computed
+
+        bool ok;
+        int index = token().toInt(&ok);
+
+        ++mToken;
+
+        if (!ok || (index < 0) || !acceptToken("]")) {
+            return -1;
+        }
+
+        if (   ((name == States) && (index >= mStatesCount))
+            || (   ((name == Algebraic) || (name == Rates))
+                && !mVariablesStates.contains(variable(name, index)))
+            || ((name != States) && (name != Constants) && (name != Algebraic) && (name != Rates))) {
+            return -1;
+        }
+
+        return newNode(NodeType::Array, name, index);
+    }
+
+    if (acceptToken("(")) {
+        // We are dealing with a function call
+
+        QVector<int> arguments;
+
+        if (!acceptToken(")")) {
+            do {
+                int argument = parseTernary();
+
+                if (argument == -1) {
+                    return -1;
+                }
+
+                arguments << argument;
+            } while (acceptToken(","));
+
+            if (!acceptToken(")")) {
+                return -1;
+            }
+        }
+
+        return newNode(NodeType::Call, name, -1, arguments);
+    }
+
+    return -1;
+}
+
+//==============================================================================
+
+QSet<int> CellmlFileRuntimeJacobian::states(int pNode)
+{
+    // Return the states on which the given node depends
+
+    auto nodeStates = mNodesStates.constFind(pNode);
+
+    if (nodeStates != mNodesStates.constEnd()) {
+        return nodeStates.value();
+    }
+
+    QSet<int> res;
+    const Node &node = mNodes[pNode];
+
+    if (node.type == NodeType::Array) {
+        if (node.text == States) {
+            res << node.index;
+        } else if (node.text != Constants) {
+            res = mVariablesStates.value(variable(node.text, node.index));
+        }
+    } else {
+        const QVector<int> arguments = node.arguments;
+
+        for (auto argument : arguments) {
+            res += states(argument);
+        }
+    }
+
+    mNodesStates.insert(pNode, res);
+
+    return res;
+}
+
+//==============================================================================
+
+bool CellmlFileRuntimeJacobian::isLinear(int pNode, int pState)
+{
+    // Return whether the given node is linear (or, strictly speaking, affine)
+    // in the given state
+
+    if (!states(pNode).contains(pState)) {
+        return true;
+    }
+
+    const Node node = mNodes[pNode];
+
+    switch (node.type) {
+    case NodeType::Number:
+    case NodeType::Voi:
+        return true;
+    case NodeType::Array:
+        return    (node.text == States)
+               || mVariablesLinearStates.value(variable(node.text, node.index)).contains(pState);
+    case NodeType::Unary:
+        return (node.text != "!") && isLinear(node.arguments[0], pState);
+    case NodeType::Binary: {
+        int left = node.arguments[0];
+        int right = node.arguments[1];
+
+        if ((node.text == "+") || (node.text == "-")) {
+            return isLinear(left, pState) && isLinear(right, pState);
+        }
+
+        if (node.text == "*") {
+            return    (!states(left).contains(pState) && isLinear(right, pState))
+                   || (!states(right).contains(pState) && isLinear(left, pState));
+        }
+
+        if (node.text == "/") {
+            return !states(right).contains(pState) && isLinear(left, pState);
+        }
+
+        return false;
+    }
+    case NodeType::Ternary:
+        return    !states(node.arguments[0]).contains(pState)
+               && isLinear(node.arguments[1], pState)
+               && isLinear(node.arguments[2], pState);
+    case NodeType::Call:
+        return false;
+    }
+
+    return false;
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::expression(int pNode) const
+{
+    // Return the (fully parenthesised) expression for the given node
+
+    const Node &node = mNodes[pNode];
+
+    switch (node.type) {
+    case NodeType::Number:
+    case NodeType::Voi:
+        return node.text;
+    case NodeType::Array:
+        return variable(node.text, node.index);
+    case NodeType::Unary:
+        return "("+node.text+expression(node.arguments[0])+")";
+    case NodeType::Binary:
+        return "("+expression(node.arguments[0])+node.text+expression(node.arguments[1])+")";
+    case NodeType::Ternary:
+        return "("+expression(node.arguments[0])+"?"+expression(node.arguments[1])+":"+expression(node.arguments[2])+")";
+    case NodeType::Call: {
+        QStringList arguments;
+
+        for (auto argument : node.arguments) {
+            arguments << expression(argument);
+        }
+
+        return node.text+"("+arguments.join(',')+")";
+    }
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+static QString plus(const QString &pTerm1, const QString &pTerm2)
+{
+    // Return the sum of the two given terms, an empty term meaning zero
+
+    if (pTerm1.isEmpty()) {
+        return pTerm2;
+    }
+
+    if (pTerm2.isEmpty()) {
+        return pTerm1;
+    }
+
+    return "("+pTerm1+"+"+pTerm2+")";
+}
+
+//==============================================================================
+
+static QString minus(const QString &pTerm1, const QString &pTerm2)
+{
+    // Return the difference of the two given terms, an empty term meaning zero
+
+    if (pTerm2.isEmpty()) {
+        return pTerm1;
+    }
+
+    if (pTerm1.isEmpty()) {
+        return "(-"+pTerm2+")";
+    }
+
+    return "("+pTerm1+"-"+pTerm2+")";
+}
+
+//==============================================================================
+
+static QString times(const QString &pFactor1, const QString &pFactor2)
+{
+    // Return the product of the two given factors, an empty factor meaning zero
+
+    static const QString One = "1.0";
+
+    if (pFactor1.isEmpty() || pFactor2.isEmpty()) {
+        return {};
+    }
+
+    if (pFactor1 == One) {
+        return pFactor2;
+    }
+
+    if (pFactor2 == One) {
+        return pFactor1;
+    }
+
+    return "("+pFactor1+"*"+pFactor2+")";
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::derivative(int pNode, int pState, bool &pOk)
+{
+    // Return the partial derivative of the given node with respect to the given
+    // state, an empty string meaning that it is zero
+
+    pOk = true;
+
+    if (!states(pNode).contains(pState)) {
+        return {};
+    }
+
+    const Node node = mNodes[pNode];
+
+    switch (node.type) {
+    case NodeType::Number:
+    case NodeType::Voi:
+        return {};
+    case NodeType::Array:
+        if (node.text == States) {
+            return "1.0";
+        }
+
+        return mVariablesDerivatives.value(variable(node.text, node.index)).contains(pState)?
+                   derivativeVariable(variable(node.text, node.index), pState):
+                   QString();
+    case NodeType::Unary: {
+        if (node.text == "!") {
+            return {};
+        }
+
+        QString operandDerivative = derivative(node.arguments[0], pState, pOk);
+
+        return (node.text == "-")?
+                   minus({}, operandDerivative):
+                   operandDerivative;
+    }
+    case NodeType::Binary: {
+        static const QStringList DifferentiableOperators = { "+", "-", "*", "/" };
+
+        if (!DifferentiableOperators.contains(node.text)) {
+            // We are dealing with a logical or a relational operator, so the
+            // result is piecewise constant
+
+            return {};
+        }
+
+        bool leftOk;
+        bool rightOk;
+        QString left = expression(node.arguments[0]);
+        QString right = expression(node.arguments[1]);
+        QString leftDerivative = derivative(node.arguments[0], pState, leftOk);
+        QString rightDerivative = derivative(node.arguments[1], pState, rightOk);
+
+        pOk = leftOk && rightOk;
+
+        if (node.text == "+") {
+            return plus(leftDerivative, rightDerivative);
+        }
+
+        if (node.text == "-") {
+            return minus(leftDerivative, rightDerivative);
+        }
+
+        if (node.text == "*") {
+            return plus(times(leftDerivative, right), times(left, rightDerivative));
+        }
+
+        // d(u/v) = du/v-u*dv/(v*v)
+
+        return minus(leftDerivative.isEmpty()?QString():"("+leftDerivative+"/"+right+")",
+                     rightDerivative.isEmpty()?QString():"("+times(left, rightDerivative)+"/("+right+"*"+right+"))");
+    }
+    case NodeType::Ternary: {
+        bool trueOk;
+        bool falseOk;
+        QString trueDerivative = derivative(node.arguments[1], pState, trueOk);
+        QString falseDerivative = derivative(node.arguments[2], pState, falseOk);
+
+        pOk = trueOk && falseOk;
+
+        if (trueDerivative.isEmpty() && falseDerivative.isEmpty()) {
+            return {};
+        }
+
+        return "("+expression(node.arguments[0])+"?"+(trueDerivative.isEmpty()?"0.0":trueDerivative)
+                                                 +":"+(falseDerivative.isEmpty()?"0.0":falseDerivative)+")";
+    }
+    case NodeType::Call: {
+        // Functions that are piecewise constant
+
+        static const QStringList PiecewiseConstantFunctions = { "ceil", "floor", "factorial" };
+
+        if (PiecewiseConstantFunctions.contains(node.text)) {
+            return {};
+        }
+
+        // Functions of one argument, which derivative is f'(u)*du
+
+        static const QMap<QString, QString> OneArgumentFunctions = {
+            { "exp", "exp(%1)" },
+            { "log", "(1.0/%1)" },
+            { "log10", "(1.0/(%1*2.302585092994046))" },
+            { "sqrt", "(0.5/sqrt(%1))" },
+            { "fabs", "((%1<0.0)?-1.0:1.0)" },
+            { "sin", "cos(%1)" },
+            { "cos", "(-sin(%1))" },
+            { "tan", "(1.0/(cos(%1)*cos(%1)))" },
+            { "sinh", "cosh(%1)" },
+            { "cosh", "sinh(%1)" },
+            { "tanh", "(1.0-tanh(%1)*tanh(%1))" },
+            { "asin", "(1.0/sqrt(1.0-%1*%1))" },
+            { "acos", "(-1.0/sqrt(1.0-%1*%1))" },
+            { "atan", "(1.0/(1.0+%1*%1))" },
+            { "asinh", "(1.0/sqrt(%1*%1+1.0))" },
+            { "acosh", "(1.0/sqrt(%1*%1-1.0))" },
+            { "atanh", "(1.0/(1.0-%1*%1))" },
+            { "sec", "(sec(%1)*tan(%1))" },
+            { "csc", "(-csc(%1)*cot(%1))" },
+            { "cot", "(-1.0/(sin(%1)*sin(%1)))" },
+            { "sech", "(-sech(%1)*tanh(%1))" },
+            { "csch", "(-csch(%1)*coth(%1))" },
+            { "coth", "(-1.0/(sinh(%1)*sinh(%1)))" }
+        };
+
+        auto oneArgumentFunction = OneArgumentFunctions.constFind(node.text);
+
+        if (   (oneArgumentFunction != OneArgumentFunctions.constEnd())
+            && (node.arguments.count() == 1)) {
+            return times(QString(oneArgumentFunction.value()).arg(expression(node.arguments[0])),
+                         derivative(node.arguments[0], pState, pOk));
+        }
+
+        // pow() and arbitrary_log()
+
+        if (((node.text == "pow") || (node.text == "arbitrary_log")) && (node.arguments.count() == 2)) {
+            bool baseOk;
+            bool exponentOk;
+            QString base = expression(node.arguments[0]);
+            QString exponent = expression(node.arguments[1]);
+            QString baseDerivative = derivative(node.arguments[0], pState, baseOk);
+            QString exponentDerivative = derivative(node.arguments[1], pState, exponentOk);
+
+            pOk = baseOk && exponentOk;
+
+            if (node.text == "arbitrary_log") {
+                // Note: arbitrary_log(u, b) = log(u)/log(b), and we don't
+                //       expect b to depend on a state...
+
+                if (!exponentDerivative.isEmpty()) {
+                    pOk = false;
+
+                    return {};
+                }
+
+                return times("(1.0/("+base+"*log("+exponent+")))", baseDerivative);
+            }
+
+            // d(u^v) = v*u^(v-1)*du+u^v*log(u)*dv
+
+            return plus(times("("+exponent+"*pow("+base+","+exponent+"-1.0))", baseDerivative),
+                        times("(pow("+base+","+exponent+")*log("+base+"))", exponentDerivative));
+        }
+
+        // A function that we don't know how to differentiate
+
+        pOk = false;
+
+        return {};
+    }
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::variable(const QString &pArray, int pIndex)
+{
+    // Return the name of the given array element
+
+    return QString("%1[%2]").arg(pArray).arg(pIndex);
+}
+
+//==============================================================================
+
+QString CellmlFileRuntimeJacobian::derivativeVariable(const QString &pVariable,
+                                                      int pState)
+{
+    // Return the name of the partial derivative of the given variable with
+    // respect to the given state
+
+    QString res = pVariable;
+
+    res.replace('[', '_').remove(']');
+
+    return QString("d%1_%2").arg(res).arg(pState);
+}
+
+//==============================================================================
+
+} // namespace CellMLSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,132 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// CellML file runtime Jacobian
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "cellmlsupportglobal.h"
+
+//==============================================================================
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace CellMLSupport {
+
+//==============================================================================
+
+class CELLMLSUPPORT_EXPORT CellmlFileRuntimeJacobian
+{
+public:
+    enum class Mode {
+        Full,
+        QuasiLinear
+    };
+
+    explicit CellmlFileRuntimeJacobian(const QString &pRatesCode,
+                                       int pStatesCount,
+                                       Mode pMode = Mode::Full);
+
+    bool isValid() const;
+
+    QString code() const;
+
+    QVector<int> rows() const;
+    QVector<int> columns() const;
+
+private:
+    enum class NodeType {
+        Number,
+        Voi,
+        Array,
+        Unary,
+        Binary,
+        Ternary,
+        Call
+    };
+
+    struct Node
+    {
+        NodeType type;
+        QString text;
+        int index;
+        QVector<int> arguments;
+    };
+
+    bool mValid = false;
+
+    int mStatesCount;
+
+    QStringList mTokens;
+    int mToken = 0;
+
+    QVector<Node> mNodes;
+
+    QHash<int, QSet<int>> mNodesStates;
+    QHash<QString, QSet<int>> mVariablesStates;
+    QHash<QString, QSet<int>> mVariablesLinearStates;
+    QHash<QString, QSet<int>> mVariablesDerivatives;
+
+    QString mCode;
+
+    QVector<int> mRows;
+    QVector<int> mColumns;
+
+    bool tokenize(const QString &pCode);
+
+    QString token() const;
+    bool isToken(const QString &pToken) const;
+    bool acceptToken(const QString &pToken);
+
+    int newNode(NodeType pType, const QString &pText = {}, int pIndex = -1,
+                const QVector<int> &pArguments = {});
+
+    int parseTernary();
+    int parseBinary(int pLevel);
+    int parseUnary();
+    int parsePrimary();
+
+    QSet<int> states(int pNode);
+    bool isLinear(int pNode, int pState);
+
+    QString expression(int pNode) const;
+    QString derivative(int pNode, int pState, bool &pOk);
+
+    static QString variable(const QString &pArray, int pIndex);
+    static QString derivativeVariable(const QString &pVariable, int pState);
+};
+
+//==============================================================================
+
+} // namespace CellMLSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
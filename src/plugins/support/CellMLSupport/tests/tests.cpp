@@ -26,6 +26,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 //==============================================================================
 
 #include "cellmlfile.h"
+#include "cellmlfileruntime.h"
 #include "corecliutils.h"
 #include "tests.h"
 
@@ -134,6 +135,364 @@ void Tests::runtimeTests()
 
 //==============================================================================
 
+void Tests::ensembleTests()
+{
+    // Compile an ensemble version of the Noble 1962 model
+
+    static const int EnsembleSize = 5;
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(!runtime->compileEnsemble(0));
+    QVERIFY(runtime->compileEnsemble(EnsembleSize));
+    QCOMPARE(runtime->ensembleSize(), EnsembleSize);
+    QVERIFY(runtime->computeEnsembleComputedConstants());
+    QVERIFY(runtime->computeEnsembleVariables());
+    QVERIFY(runtime->computeEnsembleRates());
+
+    // Initialise a single instance of our model
+
+    int constantsCount = runtime->constantsCount();
+    int ratesCount = runtime->ratesCount();
+    int statesCount = runtime->statesCount();
+    int algebraicCount = runtime->algebraicCount();
+
+    QVector<double> constants(constantsCount);
+    QVector<double> rates(ratesCount);
+    QVector<double> states(statesCount);
+    QVector<double> algebraic(algebraicCount);
+
+    runtime->initializeConstants()(constants.data(), rates.data(), states.data());
+    runtime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Create an ensemble where the nth instance is our single instance with its
+    // states scaled by (n+1)
+
+    QVector<double> ensembleConstants(constantsCount*EnsembleSize);
+    QVector<double> ensembleRates(ratesCount*EnsembleSize);
+    QVector<double> ensembleStates(statesCount*EnsembleSize);
+    QVector<double> ensembleAlgebraic(algebraicCount*EnsembleSize);
+
+    for (int n = 0; n < EnsembleSize; ++n) {
+        for (int i = 0; i < constantsCount; ++i) {
+            ensembleConstants[i*EnsembleSize+n] = constants[i];
+        }
+
+        for (int i = 0; i < statesCount; ++i) {
+            ensembleStates[i*EnsembleSize+n] = (n+1)*states[i];
+        }
+    }
+
+    runtime->computeEnsembleComputedConstants()(0.0, ensembleConstants.data(), ensembleRates.data(), ensembleStates.data(), ensembleAlgebraic.data());
+    runtime->computeEnsembleRates()(0.0, ensembleConstants.data(), ensembleRates.data(), ensembleStates.data(), ensembleAlgebraic.data());
+
+    // Check that each instance of our ensemble gives the same rates as our
+    // single instance
+
+    for (int n = 0; n < EnsembleSize; ++n) {
+        for (int i = 0; i < statesCount; ++i) {
+            states[i] = ensembleStates[i*EnsembleSize+n];
+        }
+
+        runtime->computeRates()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+        for (int i = 0; i < ratesCount; ++i) {
+            QCOMPARE(ensembleRates[i*EnsembleSize+n], rates[i]);
+        }
+    }
+}
+
+//==============================================================================
+
+void Tests::jacobianTests()
+{
+    // Compile the Jacobian of the Noble 1962 model
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(runtime->compileJacobian());
+    QVERIFY(runtime->computeJacobian());
+    QVERIFY(!runtime->jacobianRows().isEmpty());
+    QCOMPARE(runtime->jacobianRows().count(), runtime->jacobianColumns().count());
+
+    // Initialise our model
+
+    int ratesCount = runtime->ratesCount();
+    int statesCount = runtime->statesCount();
+
+    QVector<double> constants(runtime->constantsCount());
+    QVector<double> rates(ratesCount);
+    QVector<double> states(statesCount);
+    QVector<double> algebraic(runtime->algebraicCount());
+
+    runtime->initializeConstants()(constants.data(), rates.data(), states.data());
+    runtime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Compute our Jacobian and check its entries against a finite difference
+    // approximation
+
+    QVector<int> rows = runtime->jacobianRows();
+    QVector<int> columns = runtime->jacobianColumns();
+    QVector<double> jacobian(rows.count());
+
+    runtime->computeJacobian()(0.0, constants.data(), rates.data(), states.data(), algebraic.data(), jacobian.data());
+
+    QVector<double> referenceRates(ratesCount);
+
+    runtime->computeRates()(0.0, constants.data(), referenceRates.data(), states.data(), algebraic.data());
+
+    for (int i = 0, iMax = rows.count(); i < iMax; ++i) {
+        QVERIFY((rows[i] >= 0) && (rows[i] < ratesCount));
+        QVERIFY((columns[i] >= 0) && (columns[i] < statesCount));
+
+        double state = states[columns[i]];
+        double delta = 1.0e-7*qMax(qAbs(state), 1.0);
+
+        states[columns[i]] = state+delta;
+
+        runtime->computeRates()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+        states[columns[i]] = state;
+
+        double approximation = (rates[rows[i]]-referenceRates[rows[i]])/delta;
+
+        QVERIFY(qAbs(jacobian[i]-approximation) <= 1.0e-3*qMax(qAbs(approximation), 1.0));
+    }
+}
+
+//==============================================================================
+
+void Tests::quasiLinearCoefficientsTests()
+{
+    // Compile the quasi-linear coefficients of the Noble 1962 model, i.e. the
+    // coefficient b of each of its states which rate is of the form
+    // dx/dt = a+b*x (i.e. its gating variables, but not its membrane potential)
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(runtime->compileQuasiLinearCoefficients());
+    QVERIFY(runtime->computeQuasiLinearCoefficients());
+    QCOMPARE(runtime->quasiLinearStates().count(), runtime->statesCount()-1);
+
+    // Initialise our model
+
+    int ratesCount = runtime->ratesCount();
+
+    QVector<double> constants(runtime->constantsCount());
+    QVector<double> rates(ratesCount);
+    QVector<double> states(runtime->statesCount());
+    QVector<double> algebraic(runtime->algebraicCount());
+
+    runtime->initializeConstants()(constants.data(), rates.data(), states.data());
+    runtime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Compute our quasi-linear coefficients, which also computes our rates, and
+    // check them against our rates and a finite difference approximation
+
+    QVector<int> quasiLinearStates = runtime->quasiLinearStates();
+    QVector<double> coefficients(quasiLinearStates.count());
+    QVector<double> referenceRates(ratesCount);
+
+    runtime->computeQuasiLinearCoefficients()(0.0, constants.data(), rates.data(), states.data(), algebraic.data(), coefficients.data());
+    runtime->computeRates()(0.0, constants.data(), referenceRates.data(), states.data(), algebraic.data());
+
+    for (int i = 0; i < ratesCount; ++i) {
+        QCOMPARE(rates[i], referenceRates[i]);
+    }
+
+    for (int i = 0, iMax = quasiLinearStates.count(); i < iMax; ++i) {
+        int quasiLinearState = quasiLinearStates[i];
+
+        QVERIFY((quasiLinearState >= 0) && (quasiLinearState < ratesCount));
+
+        double state = states[quasiLinearState];
+        double delta = 1.0e-7*qMax(qAbs(state), 1.0);
+
+        states[quasiLinearState] = state+delta;
+
+        runtime->computeRates()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+        states[quasiLinearState] = state;
+
+        double approximation = (rates[quasiLinearState]-referenceRates[quasiLinearState])/delta;
+
+        QVERIFY(qAbs(coefficients[i]-approximation) <= 1.0e-3*qMax(qAbs(approximation), 1.0));
+    }
+}
+
+//==============================================================================
+
+void Tests::integratorTests()
+{
+    // Compile a Forward Euler integrator for the Noble 1962 model
+
+    static const double Step = 0.01;
+    static const double VoiEnd = 1.0;
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(!runtime->compileIntegrator(OpenCOR::Solver::FixedStepMethod::None));
+    QVERIFY(!runtime->integrate());
+    QVERIFY(runtime->compileIntegrator(OpenCOR::Solver::FixedStepMethod::ForwardEuler));
+    QVERIFY(runtime->integrate());
+
+    // Initialise our model
+
+    int ratesCount = runtime->ratesCount();
+    int statesCount = runtime->statesCount();
+
+    QVector<double> constants(runtime->constantsCount());
+    QVector<double> rates(ratesCount);
+    QVector<double> states(statesCount);
+    QVector<double> algebraic(runtime->algebraicCount());
+
+    runtime->initializeConstants()(constants.data(), rates.data(), states.data());
+    runtime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Integrate our model using our integrator and using Forward Euler "by
+    // hand", and check that we get the same states
+
+    QVector<double> referenceStates = states;
+    double voi = 0.0;
+
+    runtime->integrate()(&voi, VoiEnd, Step, constants.data(), rates.data(), states.data(), algebraic.data(),
+                         nullptr, nullptr, nullptr);
+
+    QCOMPARE(voi, VoiEnd);
+
+    for (int stepNumber = 0; stepNumber < qRound(VoiEnd/Step); ++stepNumber) {
+        runtime->computeRates()(stepNumber*Step, constants.data(), rates.data(), referenceStates.data(), algebraic.data());
+
+        for (int i = 0; i < statesCount; ++i) {
+            referenceStates[i] += Step*rates[i];
+        }
+    }
+
+    for (int i = 0; i < statesCount; ++i) {
+        QVERIFY(qAbs(states[i]-referenceStates[i]) <= 1.0e-9*qMax(qAbs(referenceStates[i]), 1.0));
+    }
+
+    // Make sure that we can switch to another fixed-step method
+
+    QVERIFY(runtime->compileIntegrator(OpenCOR::Solver::FixedStepMethod::FourthOrderRungeKutta));
+    QVERIFY(runtime->integrate());
+}
+
+//==============================================================================
+
+void Tests::rootInformationTests()
+{
+    // The Noble 1962 model doesn't have any piecewise definition, so it
+    // shouldn't have any condition variable
+
+    OpenCOR::CellMLSupport::CellmlFile nobleCellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = nobleCellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QCOMPARE(runtime->conditionVariablesCount(), 0);
+
+    // The Hodgkin-Huxley model has a stimulus current, which is defined using
+    // a piecewise definition, so it should have some condition variables
+
+    OpenCOR::CellMLSupport::CellmlFile hhCellmlFile(OpenCOR::fileName("models/hodgkin_huxley_squid_axon_model_1952.cellml"));
+
+    runtime = hhCellmlFile.runtime();
+
+    QVERIFY(runtime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(runtime->conditionVariablesCount() > 0);
+    QVERIFY(runtime->computeRootInformation());
+
+    // Initialise our model
+
+    QVector<double> constants(runtime->constantsCount());
+    QVector<double> rates(runtime->ratesCount());
+    QVector<double> states(runtime->statesCount());
+    QVector<double> algebraic(runtime->algebraicCount());
+
+    runtime->initializeConstants()(constants.data(), rates.data(), states.data());
+    runtime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Compute our condition variables before and after the start of our
+    // stimulus (at 10 ms), and check that at least one of them changes sign,
+    // i.e. that our stimulus comes with a root
+
+    int conditionVariablesCount = runtime->conditionVariablesCount();
+    QVector<double> conditionVariablesBefore(conditionVariablesCount);
+    QVector<double> conditionVariablesAfter(conditionVariablesCount);
+
+    runtime->computeRootInformation()(5.0, constants.data(), rates.data(), states.data(), algebraic.data(), conditionVariablesBefore.data());
+    runtime->computeRootInformation()(15.0, constants.data(), rates.data(), states.data(), algebraic.data(), conditionVariablesAfter.data());
+
+    bool signChanged = false;
+
+    for (int i = 0; i < conditionVariablesCount; ++i) {
+        signChanged = signChanged || (conditionVariablesBefore[i]*conditionVariablesAfter[i] < 0.0);
+    }
+
+    QVERIFY(signChanged);
+}
+
+//==============================================================================
+
+void Tests::sharedRuntimeTests()
+{
+    // Create two runtimes for the same model and check that they share their
+    // compiled code
+
+    // Note: our tests don't have a GUI, so our first runtime gets fully
+    //       optimised straightaway, but we still make sure that it uses its
+    //       fully optimised code, so that our second runtime uses it
+    //       straightaway...
+
+    OpenCOR::CellMLSupport::CellmlFile cellmlFile(OpenCOR::fileName("models/noble_model_1962.cellml"));
+    OpenCOR::CellMLSupport::CellmlFileRuntime *runtime = cellmlFile.runtime();
+
+    QVERIFY(runtime);
+
+    runtime->useOptimisedCode(true);
+
+    OpenCOR::CellMLSupport::CellmlFileRuntime *otherRuntime = cellmlFile.runtime();
+
+    QVERIFY(otherRuntime);
+    QVERIFY(runtime->isValid());
+    QVERIFY(otherRuntime->isValid());
+    QCOMPARE(runtime->computeRates(), otherRuntime->computeRates());
+
+    // Delete our first runtime and make sure that we can still use the
+    // compiled code of our other runtime
+
+    delete runtime;
+
+    QVector<double> constants(otherRuntime->constantsCount());
+    QVector<double> rates(otherRuntime->ratesCount());
+    QVector<double> states(otherRuntime->statesCount());
+    QVector<double> algebraic(otherRuntime->algebraicCount());
+
+    otherRuntime->initializeConstants()(constants.data(), rates.data(), states.data());
+    otherRuntime->computeComputedConstants()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+    otherRuntime->computeRates()(0.0, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    QVERIFY(qIsFinite(rates[0]));
+
+    delete otherRuntime;
+}
+
+//==============================================================================
+
 QTEST_GUILESS_MAIN(Tests)
 
 //==============================================================================
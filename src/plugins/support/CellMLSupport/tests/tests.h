@@ -39,6 +39,12 @@ private:
 
 private slots:
     void runtimeTests();
+    void ensembleTests();
+    void jacobianTests();
+    void quasiLinearCoefficientsTests();
+    void integratorTests();
+    void rootInformationTests();
+    void sharedRuntimeTests();
 };
 
 //==============================================================================
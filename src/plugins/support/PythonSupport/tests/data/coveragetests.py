@@ -153,6 +153,20 @@ if __name__ == '__main__':
                                 data.nla_solver_property, data.set_nla_solver_property, 'MaximumNumberOfIterations',
                                 'DAE')
 
+    print('       - Statistics enabled: %s' % ("yes" if data.statistics_enabled() else "no"))
+
+    data.set_statistics_enabled(True)
+
+    print('       - Test statistics enabled properly set: %s' % ("yes" if data.statistics_enabled() else "no"))
+
+    print('       - Steady state: %s' % ("yes" if data.steady_state() else "no"))
+
+    data.set_steady_state(True)
+
+    print('       - Test steady state properly set: %s' % ("yes" if data.steady_state() else "no"))
+
+    data.set_steady_state(False)
+
     # Coverage tests for SimulationResults
 
     utils.header('SimulationResults coverage tests', False)
@@ -168,6 +182,10 @@ if __name__ == '__main__':
     test_data_store_variables(results.rates(), 'SimulationResults.rates()')
     test_data_store_variables(results.algebraic(), 'SimulationResults.algebraic()')
 
+    statistics = results.statistics()
+
+    print('    - Test SimulationResults.statistics(): %s' % ("yes" if statistics.get('steps', 0) > 0 else "no"))
+
     print('    - Test SimulationResults.data_store():')
 
     data_store = results.data_store()
@@ -176,4 +194,64 @@ if __name__ == '__main__':
     test_data_store_variables(data_store.variables(), 'DataStore.variables()', '   ')
     test_data_store_variables(data_store.voi_and_variables(), 'DataStore.voi_and_variables()', '   ')
 
+    # Coverage tests for Simulation.sweep()
+
+    utils.header('Simulation.sweep() coverage tests', False)
+
+    sweep_results = simulation.sweep([{}, {'main/y': 5.0}, {'main/y': -5.0}])
+    last_y = results.states()['main/y'].values()[-1]
+
+    print(' - Number of results: %d' % len(sweep_results))
+    print(' - No errors: %s' % ("yes" if all(result['error'] == '' for result in sweep_results) else "no"))
+    print(' - Same sizes: %s'
+          % ("yes" if all(len(result['voi']) == results.voi().values_count() for result in sweep_results) else "no"))
+    print(' - Default variant same as run: %s'
+          % ("yes" if abs(sweep_results[0]['states']['main/y'][-1] - last_y) <= 1.0e-3 * max(1.0, abs(last_y)) else "no"))
+    print(' - Other variants different from run: %s'
+          % ("yes" if all(result['states']['main/y'] != sweep_results[0]['states']['main/y'] for result in sweep_results[1:]) else "no"))
+
+    try:
+        simulation.sweep([{'unknown': 1.0}])
+    except Exception as e:
+        print(' - %s' % repr(e))
+
+    simulation.reset()
+
+    print(' - Run after sweep: %s' % ("yes" if simulation.run() else "no"))
+
+    oc.close_simulation(simulation)
+
+    # Coverage tests for Simulation.sweep() using ensembles, i.e. using a
+    # fixed-step ODE solver with a model that doesn't need an NLA solver and
+    # more variants than threads
+
+    utils.header('Simulation.sweep() (ensembles) coverage tests', False)
+
+    simulation = utils.open_simulation('tests/cellml/parabola_ode_model.cellml')
+
+    data = simulation.data()
+
+    data.set_ode_solver('Euler (forward)')
+    data.set_ode_solver_property('Step', 0.01)
+
+    simulation.run()
+
+    results = simulation.results()
+    last_y = results.states()['main/y'].values()[-1]
+
+    simulation.reset()
+
+    sweep_results = simulation.sweep([{}, {'main/offset': 5.0}, {'main/y': 7.0}], 1)
+
+    print(' - Number of results: %d' % len(sweep_results))
+    print(' - No errors: %s' % ("yes" if all(result['error'] == '' for result in sweep_results) else "no"))
+    print(' - Same sizes: %s'
+          % ("yes" if all(len(result['voi']) == results.voi().values_count() for result in sweep_results) else "no"))
+    print(' - Default variant same as run: %s'
+          % ("yes" if abs(sweep_results[0]['states']['main/y'][-1] - last_y) <= 1.0e-9 * max(1.0, abs(last_y)) else "no"))
+    print(' - Constant variant offset from run: %s'
+          % ("yes" if abs(sweep_results[1]['states']['main/y'][-1] - (last_y + 2.0)) <= 1.0e-9 * max(1.0, abs(last_y)) else "no"))
+    print(' - State variant offset from run: %s'
+          % ("yes" if abs(sweep_results[2]['states']['main/y'][-1] - (last_y + 4.0)) <= 1.0e-9 * max(1.0, abs(last_y)) else "no"))
+
     oc.close_simulation(simulation)
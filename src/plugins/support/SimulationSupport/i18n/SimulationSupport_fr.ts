@@ -34,6 +34,40 @@
         <source>The memory required for the simulation could not be allocated.</source>
         <translation>La mémoire requise pour la simulation n&apos;a pas pu être allouée.</translation>
     </message>
+    <message>
+        <source>The simulation is running and its variants cannot therefore be run.</source>
+        <translation>La simulation est en cours d&apos;exécution et ses variantes ne peuvent donc pas être exécutées.</translation>
+    </message>
+    <message>
+        <source>The variants must be a list of dictionaries.</source>
+        <translation>Les variantes doivent être une liste de dictionnaires.</translation>
+    </message>
+    <message>
+        <source>The value of &apos;%1&apos; must be a number.</source>
+        <translation>La valeur de &apos;%1&apos; doit être un nombre.</translation>
+    </message>
+    <message>
+        <source>&apos;%1&apos; is neither a constant nor a state.</source>
+        <translation>&apos;%1&apos; n&apos;est ni une constante ni un état.</translation>
+    </message>
+</context>
+<context>
+    <name>OpenCOR::SimulationSupport::SimulationSweep</name>
+    <message>
+        <source>the simulation has too many points to be swept</source>
+        <translation>la simulation a trop de points pour être balayée</translation>
+    </message>
+</context>
+<context>
+    <name>OpenCOR::SimulationSupport::SimulationWorker</name>
+    <message>
+        <source>the steady state could not be computed</source>
+        <translation>l&apos;état stationnaire n&apos;a pas pu être calculé</translation>
+    </message>
+    <message>
+        <source>no NLA solver is available to compute the steady state</source>
+        <translation>aucun solveur NLA n&apos;est disponible pour calculer l&apos;état stationnaire</translation>
+    </message>
 </context>
 <context>
     <name>QObject</name>
@@ -33,10 +33,15 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 //==============================================================================
 
+#include <QElapsedTimer>
 #include <QThread>
 
 //==============================================================================
 
+#include <algorithm>
+
+//==============================================================================
+
 #include "libsedmlbegin.h"
     #include "sedml/SedAlgorithm.h"
     #include "sedml/SedDocument.h"
@@ -282,6 +287,70 @@ void SimulationData::setDelay(quint64 pDelay)
 
 //==============================================================================
 
+int SimulationData::refreshRate() const
+{
+    // Return our refresh rate
+
+    return mRefreshRate;
+}
+
+//==============================================================================
+
+void SimulationData::setRefreshRate(int pRefreshRate)
+{
+    // Set our refresh rate, i.e. the maximum number of times per second that
+    // people get to know that new results are available while our simulation
+    // is running
+    // Note: a refresh rate of zero (or less) means that people only get to
+    //       know about new results once our simulation is paused or done...
+
+    mRefreshRate = pRefreshRate;
+}
+
+//==============================================================================
+
+bool SimulationData::statisticsEnabled() const
+{
+    // Return whether we should keep track of statistics
+
+    return mStatisticsEnabled;
+}
+
+//==============================================================================
+
+void SimulationData::setStatisticsEnabled(bool pStatisticsEnabled)
+{
+    // Set whether we should keep track of statistics, i.e. solver counters and
+    // timings, when running our simulation
+    // Note: this is disabled by default since some of those statistics come at
+    //       a (small) cost...
+
+    mStatisticsEnabled = pStatisticsEnabled;
+}
+
+//==============================================================================
+
+bool SimulationData::steadyState() const
+{
+    // Return whether we should compute a steady state
+
+    return mSteadyState;
+}
+
+//==============================================================================
+
+void SimulationData::setSteadyState(bool pSteadyState)
+{
+    // Set whether we should compute a steady state, i.e. solve rates = 0
+    // directly rather than integrate our model over time
+    // Note: the resulting states are kept in our states, so that they can be
+    //       used as the initial conditions of our next run...
+
+    mSteadyState = pSteadyState;
+}
+
+//==============================================================================
+
 double SimulationData::startingPoint() const
 {
     // Return our starting point
@@ -547,7 +616,7 @@ void SimulationData::reset(bool pInitialize, bool pAll)
 
         nlaSolver = static_cast<Solver::NlaSolver *>(nlaSolverInterface()->solverInstance());
 
-        Solver::setNlaSolver(runtime, nlaSolver);
+        runtime->setNlaSolver(nlaSolver);
 
         // Keep track of any error that might be reported by our NLA solver
 
@@ -886,6 +955,8 @@ void SimulationResults::createDataStore()
 
     mDataStore = new DataStore::DataStore(mSimulation->cellmlFile()->xmlBase());
 
+    mDataStore->setScratchDirectory(mScratchDirectory);
+
     mPointsVariable = mDataStore->voi();
 
     mConstantsVariables = mDataStore->addVariables(simulationData->constants(), runtime->constantsCount());
@@ -893,6 +964,14 @@ void SimulationResults::createDataStore()
     mStatesVariables = mDataStore->addVariables(simulationData->states(), runtime->statesCount());
     mAlgebraicVariables = mDataStore->addVariables(simulationData->algebraic(), runtime->algebraicCount());
 
+    // Our constants are, well, constant during a run (unless the user modifies
+    // them while the simulation is paused), so there is no need to store their
+    // value at each point
+
+    for (auto constantsVariable : qAsConst(mConstantsVariables)) {
+        constantsVariable->setStorageClass(DataStore::StorageClass::Constant);
+    }
+
     // Customise our VOI, as well as our constant, rate, state and algebraic
     // variables
 
@@ -950,12 +1029,10 @@ void SimulationResults::createDataStore()
 
         mData.insert(data, variables);
 
-        DataStore::DataStoreVariable *importVoi = importDataStore->voi();
-        DataStore::DataStoreVariables importVariables = importDataStore->variables();
+        quint64 position = 0;
 
-        for (int i = 0, iMax = importVariables.count(); i < iMax; ++i) {
-            data[i] = realValue(mSimulation->currentPoint(), importVoi, importVariables[i]);
-        }
+        interpolateData(mSimulation->currentPoint(), importDataStore->voi(),
+                        importDataStore->variables(), data, position);
     }
 
     // Let people know that our (imported) data, if any, has been updated
@@ -986,6 +1063,13 @@ void SimulationResults::deleteDataStore()
     mAlgebraicVariables = DataStore::DataStoreVariables();
 
     mData.clear();
+
+    mRealPointOffset = 0.0;
+
+    mImportedData.clear();
+    mImportedVois.clear();
+    mImportedVariables.clear();
+    mImportedPositions.clear();
 }
 
 //==============================================================================
@@ -1010,6 +1094,10 @@ void SimulationResults::reset()
     deleteDataStore();
     createDataStore();
 
+    // Reset our statistics
+
+    mStatistics.clear();
+
     // Let people know that we have been reset
 
     emit resultsReset();
@@ -1059,16 +1147,23 @@ void SimulationResults::importData(DataStore::DataStoreImportData *pImportData)
     if (runsCount != 0) {
         DataStore::DataStoreVariable *resultsVoi = pImportData->resultsDataStore()->voi();
 
+        quint64 position = 0;
+
         for (int i = 0; i < runsCount; ++i) {
             // Add the value of our imported data to our the corresponding run
+            // Note: the points of a run are monotonic, so we can interpolate
+            //       our imported data using a cursor rather than having to look
+            //       for the position of each point from scratch...
 
             double *voiValues = resultsVoi->values(i);
+            double realPointOffset = realPoint(0.0, i);
 
             for (quint64 j = 0, jMax = resultsVoi->size(i); j < jMax; ++j) {
-                double realPoint = SimulationResults::realPoint(voiValues[j], i);
+                interpolateData(realPointOffset+voiValues[j], importVoi,
+                                importVariables, resultsValues, position);
 
                 for (int k = 0, kMax = resultsVariables.count(); k < kMax; ++k) {
-                    resultsVariables[k]->addValue(realValue(realPoint, importVoi, importVariables[k]), i);
+                    resultsVariables[k]->addValue(resultsValues[k], i);
                 }
             }
         }
@@ -1085,10 +1180,15 @@ void SimulationResults::importData(DataStore::DataStoreImportData *pImportData)
         // There are no runs, so update our imported data array so that it
         // contains the computed values for our start point
 
-        for (int i = 0, iMax = importVariables.count(); i < iMax; ++i) {
-            resultsValues[i] = realValue(mSimulation->currentPoint(), importVoi, importVariables[i]);
-        }
+        quint64 position = 0;
+
+        interpolateData(mSimulation->currentPoint(), importVoi,
+                        importVariables, resultsValues, position);
     }
+
+    // Resolve our imported data, so that it gets updated when adding points
+
+    resolveImportedData();
 }
 
 //==============================================================================
@@ -1117,6 +1217,8 @@ bool SimulationResults::addRun()
         bool res = mDataStore->addRun(simulationSize);
 
         if (res) {
+            resolveImportedData();
+
             emit runAdded();
         }
 
@@ -1128,6 +1230,31 @@ bool SimulationResults::addRun()
 
 //==============================================================================
 
+void SimulationResults::resolveImportedData()
+{
+    // Resolve our imported data, as well as the offset to apply to a point of
+    // our current (i.e. last) run, so that we don't have to do it for every
+    // point that gets added to us
+
+    mRealPointOffset = realPoint(0.0);
+
+    mImportedData.clear();
+    mImportedVois.clear();
+    mImportedVariables.clear();
+
+    for (auto data = mDataDataStores.constBegin(),
+              dataEnd = mDataDataStores.constEnd();
+         data != dataEnd; ++data) {
+        mImportedData << data.key();
+        mImportedVois << data.value()->voi();
+        mImportedVariables << data.value()->variables();
+    }
+
+    mImportedPositions.fill(0, mImportedData.count());
+}
+
+//==============================================================================
+
 double SimulationResults::realPoint(double pPoint, int pRun) const
 {
     // Determine the real value of the given point, if we didn't have several
@@ -1148,76 +1275,96 @@ double SimulationResults::realPoint(double pPoint, int pRun) const
 
 //==============================================================================
 
-double SimulationResults::realValue(double pPoint,
-                                    DataStore::DataStoreVariable *pVoi,
-                                    DataStore::DataStoreVariable *pVariable) const
+void SimulationResults::interpolateData(double pPoint,
+                                        DataStore::DataStoreVariable *pVoi,
+                                        const DataStore::DataStoreVariables &pVariables,
+                                        double *pData, quint64 &pPosition) const
 {
-    // Return the value of the given variable at the given point, doing a linear
+    // Set the value of the given variables at the given point, doing a linear
     // interpolation, if needed
+    // Note: pPosition is a cursor, i.e. the position of the VOI value that was
+    //       the closest to (while not greater than) the previous point. Points
+    //       are normally monotonic, so we first try to move our cursor forward
+    //       (in a galloping fashion), and only search from scratch if the given
+    //       point is before our cursor...
+
+    const double *voiValues = pVoi->values();
+    quint64 size = pVoi->size();
+    int variablesCount = pVariables.count();
+
+    if (   (voiValues == nullptr) || (size == 0)
+        || (pPoint < voiValues[0]) || (pPoint > voiValues[size-1])) {
+        for (int i = 0; i < variablesCount; ++i) {
+            pData[i] = qQNaN();
+        }
 
-    quint64 first = 0;
-    quint64 last = pVoi->size()-1;
-
-    if (   (pPoint < pVoi->value(first))
-        || (pPoint > pVoi->value(last))) {
-        return qQNaN();
+        return;
     }
 
-    quint64 middle = 0;
-    double middleVoiValue = 0.0;
-
-    while (first <= last) {
-        middle = (first+last)/2;
-        middleVoiValue = pVoi->value(middle);
+    if ((pPosition >= size) || (voiValues[pPosition] > pPoint)) {
+        pPosition = quint64(std::upper_bound(voiValues, voiValues+qMin(pPosition, size),
+                                             pPoint)-voiValues)-1;
+    } else {
+        quint64 step = 1;
 
-        if (middleVoiValue < pPoint) {
-            first = middle+1;
-        } else if (middleVoiValue > pPoint) {
-            last = middle-1;
-        } else {
-            break;
+        while ((pPosition+step < size) && (voiValues[pPosition+step] <= pPoint)) {
+            step *= 2;
         }
+
+        pPosition = quint64(std::upper_bound(voiValues+pPosition+step/2,
+                                             voiValues+qMin(pPosition+step, size),
+                                             pPoint)-voiValues)-1;
     }
 
-    if (middleVoiValue < pPoint) {
-        double afterVoiValue = pVoi->value(middle+1);
-        double afterDataValue = pVariable->value(middle+1);
+    // Compute the interpolation weight once and then use it for all of our
+    // variables
 
-        return afterDataValue-(afterVoiValue-pPoint)*(afterDataValue-pVariable->value(middle))/(afterVoiValue-middleVoiValue);
-    }
+    if (pPosition == size-1) {
+        for (int i = 0; i < variablesCount; ++i) {
+            pData[i] = pVariables[i]->value(pPosition);
+        }
+    } else {
+        double weight = (pPoint-voiValues[pPosition])/(voiValues[pPosition+1]-voiValues[pPosition]);
 
-    if (middleVoiValue > pPoint) {
-        double beforeVoiValue = pVoi->value(middle-1);
-        double beforeDataValue = pVariable->value(middle-1);
+        for (int i = 0; i < variablesCount; ++i) {
+            const double *values = pVariables[i]->values();
+            double value = values[pPosition];
 
-        return beforeDataValue+(pPoint-beforeVoiValue)*(pVariable->value(middle)-beforeDataValue)/(middleVoiValue-beforeVoiValue);
+            pData[i] = value+weight*(values[pPosition+1]-value);
+        }
     }
-
-    return pVariable->value(middle);
 }
 
 //==============================================================================
 
-void SimulationResults::addPoint(double pPoint)
+void SimulationResults::addPoint(double pPoint,
+                                 quint64 *pRecomputeVariablesTime)
 {
-    // Make sure that all our variables are up to date
+    // Make sure that all our variables are up to date, keeping track of the
+    // time it takes to do so, if needed
+
+    if (pRecomputeVariablesTime != nullptr) {
+        QElapsedTimer timer;
+
+        timer.start();
 
-    mSimulation->data()->recomputeVariables(pPoint);
+        mSimulation->data()->recomputeVariables(pPoint);
+
+        *pRecomputeVariablesTime += quint64(timer.nsecsElapsed());
+    } else {
+        mSimulation->data()->recomputeVariables(pPoint);
+    }
 
     // Make sure that we have the correct imported data values for the given
     // point, keeping in mind that we may have several runs
+    // Note: our imported data, and the offset to apply to the given point, are
+    //       resolved once per run (see resolveImportedData())...
 
-    const QList<double *> dataKeys = mDataDataStores.keys();
-    double realPoint = SimulationResults::realPoint(pPoint);
+    double realPoint = mRealPointOffset+pPoint;
 
-    for (auto data : dataKeys) {
-        DataStore::DataStore *dataStore = mDataDataStores.value(data);
-        DataStore::DataStoreVariable *voi = dataStore->voi();
-        DataStore::DataStoreVariables variables = dataStore->variables();
-
-        for (int i = 0, iMax = variables.count(); i < iMax; ++i) {
-            data[i] = realValue(realPoint, voi, variables[i]);
-        }
+    for (int i = 0, iMax = mImportedData.count(); i < iMax; ++i) {
+        interpolateData(realPoint, mImportedVois[i], mImportedVariables[i],
+                        mImportedData[i], mImportedPositions[i]);
     }
 
     // Now that we are all set, we can add the data to our data store
@@ -1227,6 +1374,24 @@ void SimulationResults::addPoint(double pPoint)
 
 //==============================================================================
 
+Solver::Solver::Statistics SimulationResults::statistics(int pRun) const
+{
+    // Return our statistics for the given run
+
+    return mStatistics.value((pRun == -1)?runsCount()-1:pRun);
+}
+
+//==============================================================================
+
+void SimulationResults::setStatistics(const Solver::Solver::Statistics &pStatistics)
+{
+    // Set our statistics for our current run
+
+    mStatistics.insert(runsCount()-1, pStatistics);
+}
+
+//==============================================================================
+
 quint64 SimulationResults::size(int pRun) const
 {
     // Return the size of our data store for the given run
@@ -1247,6 +1412,32 @@ DataStore::DataStore * SimulationResults::dataStore() const
 
 //==============================================================================
 
+QString SimulationResults::scratchDirectory() const
+{
+    // Return our scratch directory
+
+    return mScratchDirectory;
+}
+
+//==============================================================================
+
+void SimulationResults::setScratchDirectory(const QString &pScratchDirectory)
+{
+    // Set our scratch directory, i.e. the directory in which our results are
+    // to be stored (in memory-mapped files) rather than in memory, and let our
+    // data store know about it
+    // Note: an empty scratch directory means that our results are to be stored
+    //       in memory...
+
+    mScratchDirectory = pScratchDirectory;
+
+    if (mDataStore != nullptr) {
+        mDataStore->setScratchDirectory(pScratchDirectory);
+    }
+}
+
+//==============================================================================
+
 double * SimulationResults::points(int pRun) const
 {
     // Return our points for the given run
@@ -1951,6 +2142,24 @@ void Simulation::setDelay(quint64 pDelay)
 
 //==============================================================================
 
+int Simulation::refreshRate() const
+{
+    // Return our refresh rate
+
+    return mData->refreshRate();
+}
+
+//==============================================================================
+
+void Simulation::setRefreshRate(int pRefreshRate)
+{
+    // Set our refresh rate
+
+    mData->setRefreshRate(pRefreshRate);
+}
+
+//==============================================================================
+
 bool Simulation::simulationSettingsOk(bool pEmitSignal)
 {
     // Check and return whether our simulation settings are sound
@@ -1990,7 +2199,7 @@ quint64 Simulation::size()
 
 //==============================================================================
 
-void Simulation::run()
+void Simulation::run(bool pSynchronous)
 {
     // Make sure that we have a runtime
 
@@ -2002,6 +2211,51 @@ void Simulation::run()
     // settings we were given are sound
 
     if ((mWorker == nullptr) && simulationSettingsOk()) {
+        // Use the fully optimised code of our model, if it is available
+        // Note #1: outside of the GUI, our model code is fully optimised
+        //          straightaway (see CellmlFileRuntime::update()), so this
+        //          only matters when running the GUI version of OpenCOR...
+        // Note #2: we wait for it if we are to run our simulation
+        //          synchronously since we are then most likely running a
+        //          batch simulation...
+
+        mRuntime->useOptimisedCode(pSynchronous);
+
+        if (pSynchronous) {
+            // We want to run our simulation synchronously, i.e. from the
+            // calling thread, so create a worker without a thread and run it
+            // straightaway
+            // Note: this is typically what we want when running a simulation
+            //       from the command line since there is no GUI to keep
+            //       responsive...
+
+            auto worker = new SimulationWorker(this, nullptr, mWorker);
+
+            mWorker = worker;
+
+            connect(worker, &SimulationWorker::running,
+                    this, &Simulation::running);
+            connect(worker, &SimulationWorker::paused,
+                    this, &Simulation::paused);
+
+            connect(worker, &SimulationWorker::done,
+                    this, &Simulation::done);
+
+            connect(worker, &SimulationWorker::error,
+                    this, &Simulation::error);
+
+            connect(worker, &SimulationWorker::resultsAvailable,
+                    this, &Simulation::resultsAvailable);
+
+            worker->run();
+
+            // Note: our worker will have reset mWorker by now...
+
+            delete worker;
+
+            return;
+        }
+
         // Create and move our worker to a thread
 
         auto thread = new QThread();
@@ -2027,6 +2281,9 @@ void Simulation::run()
         connect(mWorker, &SimulationWorker::error,
                 this, &Simulation::error);
 
+        connect(mWorker, &SimulationWorker::resultsAvailable,
+                this, &Simulation::resultsAvailable);
+
         connect(thread, &QThread::finished,
                 thread, &QThread::deleteLater);
 
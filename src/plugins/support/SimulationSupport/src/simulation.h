@@ -173,6 +173,11 @@ public:
 
 private:
     quint64 mDelay = 0;
+    int mRefreshRate = 60;
+
+    bool mStatisticsEnabled = false;
+
+    bool mSteadyState = false;
 
     double mStartingPoint = 0.0;
     double mEndingPoint = 1000.0;
@@ -226,6 +231,15 @@ public slots:
     const quint64 * delay() const;
     void setDelay(quint64 pDelay);
 
+    int refreshRate() const;
+    void setRefreshRate(int pRefreshRate);
+
+    bool statisticsEnabled() const;
+    void setStatisticsEnabled(bool pStatisticsEnabled);
+
+    bool steadyState() const;
+    void setSteadyState(bool pSteadyState);
+
     double startingPoint() const;
     double endingPoint() const;
     double pointInterval() const;
@@ -271,7 +285,10 @@ public:
 
     bool addRun();
 
-    void addPoint(double pPoint);
+    void addPoint(double pPoint, quint64 *pRecomputeVariablesTime = nullptr);
+
+    Solver::Solver::Statistics statistics(int pRun = -1) const;
+    void setStatistics(const Solver::Solver::Statistics &pStatistics);
 
     double * points(int pRun = -1) const;
 
@@ -292,6 +309,8 @@ public:
 private:
     DataStore::DataStore *mDataStore = nullptr;
 
+    QString mScratchDirectory;
+
     DataStore::DataStoreVariable *mPointsVariable = nullptr;
 
     DataStore::DataStoreVariables mConstantsVariables;
@@ -302,6 +321,15 @@ private:
     QHash<double *, DataStore::DataStoreVariables> mData;
     QHash<double *, DataStore::DataStore *> mDataDataStores;
 
+    double mRealPointOffset = 0.0;
+
+    QList<double *> mImportedData;
+    DataStore::DataStoreVariables mImportedVois;
+    QList<DataStore::DataStoreVariables> mImportedVariables;
+    QVector<quint64> mImportedPositions;
+
+    QMap<int, Solver::Solver::Statistics> mStatistics;
+
     void createDataStore();
     void deleteDataStore();
 
@@ -309,8 +337,11 @@ private:
 
     double realPoint(double pPoint, int pRun = -1) const;
 
-    double realValue(double pPoint, DataStore::DataStoreVariable *pVoi,
-                     DataStore::DataStoreVariable *pVariable) const;
+    void interpolateData(double pPoint, DataStore::DataStoreVariable *pVoi,
+                         const DataStore::DataStoreVariables &pVariables,
+                         double *pData, quint64 &pPosition) const;
+
+    void resolveImportedData();
 
 signals:
     void resultsReset();
@@ -326,6 +357,9 @@ public slots:
     quint64 size(int pRun = -1) const;
 
     OpenCOR::DataStore::DataStore * dataStore() const;
+
+    QString scratchDirectory() const;
+    void setScratchDirectory(const QString &pScratchDirectory);
 };
 
 //==============================================================================
@@ -381,7 +415,7 @@ public:
 
     bool addRun();
 
-    void run();
+    void run(bool pSynchronous = false);
     void pause();
     void resume();
     void stop();
@@ -425,6 +459,8 @@ signals:
 
     void error(const QString &pMessage);
 
+    void resultsAvailable();
+
 public slots:
     QString fileName() const;
 
@@ -448,6 +484,9 @@ public slots:
     const quint64 * delay() const;
     void setDelay(quint64 pDelay);
 
+    int refreshRate() const;
+    void setRefreshRate(int pRefreshRate);
+
     quint64 size();
 
 private slots:
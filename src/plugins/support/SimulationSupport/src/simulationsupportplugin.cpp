@@ -21,12 +21,26 @@ along with this program. If not, see <https://gnu.org/licenses>.
 // Simulation support plugin
 //==============================================================================
 
+#include "cellmlfileruntime.h"
+#include "corecliutils.h"
+#include "filemanager.h"
+#include "interfaces.h"
+#include "simulation.h"
 #include "simulationmanager.h"
 #include "simulationsupportplugin.h"
 #include "simulationsupportpythonwrapper.h"
 
 //==============================================================================
 
+#include <QFile>
+#include <QTextStream>
+
+//==============================================================================
+
+#include <iostream>
+
+//==============================================================================
+
 namespace OpenCOR {
 namespace SimulationSupport {
 
@@ -39,11 +53,47 @@ PLUGININFO_FUNC SimulationSupportPluginInfo()
                                                  { "fr", QString::fromUtf8("une extension pour supporter des simulations.") }
                                              };
 
-    return new PluginInfo(PluginInfo::Category::Support, false, false,
+    return new PluginInfo(PluginInfo::Category::Support, false, true,
                           { "COMBINESupport", "DataStore", "PythonQtSupport" },
                           descriptions);
 }
 
+//==============================================================================
+// CLI interface
+//==============================================================================
+
+bool SimulationSupportPlugin::executeCommand(const QString &pCommand,
+                                             const QStringList &pArguments,
+                                             int &pRes)
+{
+    Q_UNUSED(pRes)
+
+    // Run the given CLI command
+
+    static const QString Help = "help";
+    static const QString Run  = "run";
+
+    if (pCommand == Help) {
+        // Display the commands that we support
+
+        runHelpCommand();
+
+        return true;
+    }
+
+    if (pCommand == Run) {
+        // Run a simulation
+
+        return runRunCommand(pArguments);
+    }
+
+    // Not a CLI command that we support
+
+    runHelpCommand();
+
+    return false;
+}
+
 //==============================================================================
 // File handling interface
 //==============================================================================
@@ -162,6 +212,308 @@ void SimulationSupportPlugin::registerPythonClasses(void *pModule)
     new SimulationSupportPythonWrapper(pModule, this);
 }
 
+//==============================================================================
+// Plugin specific
+//==============================================================================
+
+void SimulationSupportPlugin::runHelpCommand()
+{
+    // Output the commands we support
+
+    std::cout << "Commands supported by the SimulationSupport plugin:" << std::endl;
+    std::cout << " * Display the commands supported by the SimulationSupport plugin:" << std::endl;
+    std::cout << "      help" << std::endl;
+    std::cout << " * Run the simulation defined in <file> and output its results, in CSV format, to <output_file> or to the console, as well as its statistics if requested:" << std::endl;
+    std::cout << "      run [-s|--statistics] <file> [<output_file>]" << std::endl;
+}
+
+//==============================================================================
+
+static QString setDefaultSolver(SimulationData *pSimulationData,
+                                Solver::Type pSolverType)
+{
+    // Determine the default solver of the given type, i.e. the first one in
+    // alphabetical order, and set it, alongside the default value of its
+    // properties, for the given simulation data
+
+    const SolverInterfaces solverInterfaces = Core::solverInterfaces();
+    SolverInterface *defaultSolverInterface = nullptr;
+
+    for (auto solverInterface : solverInterfaces) {
+        if (   (solverInterface->solverType() == pSolverType)
+            && (   (defaultSolverInterface == nullptr)
+                || (defaultSolverInterface->solverName().compare(solverInterface->solverName(), Qt::CaseInsensitive) > 0))) {
+            defaultSolverInterface = solverInterface;
+        }
+    }
+
+    if (defaultSolverInterface == nullptr) {
+        return QString("No %1 solver could be found.").arg((pSolverType == Solver::Type::Ode)?"ODE":"NLA");
+    }
+
+    const Solver::Properties solverProperties = defaultSolverInterface->solverProperties();
+
+    if (pSolverType == Solver::Type::Ode) {
+        pSimulationData->setOdeSolverName(defaultSolverInterface->solverName());
+
+        for (const auto &solverProperty : solverProperties) {
+            pSimulationData->setOdeSolverProperty(solverProperty.id(), solverProperty.defaultValue());
+        }
+    } else {
+        pSimulationData->setNlaSolverName(defaultSolverInterface->solverName());
+
+        for (const auto &solverProperty : solverProperties) {
+            pSimulationData->setNlaSolverProperty(solverProperty.id(), solverProperty.defaultValue());
+        }
+    }
+
+    return {};
+}
+
+//==============================================================================
+
+static bool writeResults(Simulation *pSimulation, QTextStream &pStream)
+{
+    // Write the results of the given simulation to the given stream, using the
+    // same CSV format as our CSV data store exporter
+
+    static const QString Header = "%1 (%2)";
+    static const QString CrLf   = "\r\n";
+
+    DataStore::DataStore *dataStore = pSimulation->results()->dataStore();
+    DataStore::DataStoreVariables variables = dataStore->variables();
+    DataStore::DataStoreVariable *voi = dataStore->voi();
+
+    variables.removeOne(voi);
+    variables.prepend(voi);
+
+    QString header;
+
+    for (auto variable : qAsConst(variables)) {
+        if (!header.isEmpty()) {
+            header += ',';
+        }
+
+        header += Header.arg(variable->uri().replace("/prime", "'").replace('/', " | "),
+                             variable->unit());
+    }
+
+    pStream << header << CrLf;
+
+    int run = dataStore->runsCount()-1;
+
+    for (quint64 i = 0, iMax = dataStore->size(run); i < iMax; ++i) {
+        QString rowData;
+
+        for (auto variable : qAsConst(variables)) {
+            if (!rowData.isEmpty()) {
+                rowData += ',';
+            }
+
+            rowData += QString::number(variable->value(i, run));
+        }
+
+        pStream << rowData << CrLf;
+    }
+
+    pStream.flush();
+
+    return pStream.status() == QTextStream::Ok;
+}
+
+//==============================================================================
+
+bool SimulationSupportPlugin::runRunCommand(const QStringList &pArguments)
+{
+    // Check whether we have been asked for statistics
+
+    static const QString ShortStatisticsOption = "-s";
+    static const QString LongStatisticsOption = "--statistics";
+
+    QStringList arguments = pArguments;
+    bool statisticsEnabled =    !arguments.isEmpty()
+                             && (   (arguments.first() == ShortStatisticsOption)
+                                 || (arguments.first() == LongStatisticsOption));
+
+    if (statisticsEnabled) {
+        arguments.removeFirst();
+    }
+
+    // Make sure that we have the correct number of arguments
+
+    if ((arguments.count() != 1) && (arguments.count() != 2)) {
+        runHelpCommand();
+
+        return false;
+    }
+
+    // Open the simulation file, be it local or remote
+
+    bool isLocalFile;
+    QString fileNameOrUrl;
+
+    Core::checkFileNameOrUrl(Core::canonicalFileName(arguments[0]),
+                             isLocalFile, fileNameOrUrl);
+
+    QString output = isLocalFile?
+                         Core::cliOpenFile(fileNameOrUrl):
+                         Core::cliOpenRemoteFile(fileNameOrUrl);
+
+    if (!output.isEmpty()) {
+        std::cout << output.toStdString() << std::endl;
+
+        return false;
+    }
+
+    QString fileName = isLocalFile?
+                           fileNameOrUrl:
+                           Core::FileManager::instance()->fileName(fileNameOrUrl);
+
+    // Ask our simulation manager to manage our file and retrieve the
+    // corresponding simulation
+
+    SimulationManager *simulationManager = SimulationManager::instance();
+
+    simulationManager->manage(fileName);
+
+    Simulation *simulation = simulationManager->simulation(fileName);
+    CellMLSupport::CellmlFileRuntime *runtime = (simulation != nullptr)?
+                                                    simulation->runtime():
+                                                    nullptr;
+
+    if (simulation == nullptr) {
+        output = "The simulation could not be created.";
+    } else if (simulation->hasBlockingIssues()) {
+        // Report the issues with the simulation
+
+        const SimulationIssues simulationIssues = simulation->issues();
+
+        for (const auto &simulationIssue : simulationIssues) {
+            output += QString("%1[%2] %3").arg(output.isEmpty()?QString():"\n",
+                                               simulationIssue.typeAsString(),
+                                               simulationIssue.message());
+        }
+    } else if ((runtime == nullptr) || !runtime->isValid()) {
+        output = "The simulation has an invalid runtime.";
+    } else {
+        // Set our default ODE and NLA, if needed, solvers and further
+        // initialise our simulation, should we be dealing with either a SED-ML
+        // file or a COMBINE archive
+        // Note: the latter will overwrite our default ODE and NLA solvers...
+
+        output = setDefaultSolver(simulation->data(), Solver::Type::Ode);
+
+        if (output.isEmpty() && runtime->needNlaSolver()) {
+            output = setDefaultSolver(simulation->data(), Solver::Type::Nla);
+        }
+
+        if (   output.isEmpty()
+            && (   (simulation->fileType() == Simulation::FileType::SedmlFile)
+                || (simulation->fileType() == Simulation::FileType::CombineArchive))) {
+            output = simulation->furtherInitialize();
+        }
+
+        if (output.isEmpty()) {
+            // Reset both the simulation's data and results (well, initialise in
+            // the case of its data), add a run to it, and run it from our
+            // thread since we are not in GUI mode
+
+            simulation->data()->reset();
+            simulation->data()->setStatisticsEnabled(statisticsEnabled);
+            simulation->results()->reset();
+
+            if (!simulation->addRun()) {
+                output = "The simulation could not be allocated the memory it requires.";
+            } else {
+                qint64 elapsedTime = -1;
+
+                connect(simulation, &Simulation::error, this, [&output](const QString &pMessage) {
+                    output = pMessage;
+                });
+                connect(simulation, &Simulation::done, this, [&elapsedTime](qint64 pElapsedTime) {
+                    elapsedTime = pElapsedTime;
+                });
+
+                simulation->run(true);
+
+                disconnect(simulation, nullptr, this, nullptr);
+
+                // Release the memory that was used by our simulation results
+                // while they were growing and shrink them to their actual size
+                // Note: nobody refers to our simulation results, so we can
+                //       compact them again straightaway should they have been
+                //       shrunk (see DataStoreVariableRun::compact())...
+
+                if (simulation->results()->dataStore()->compact()) {
+                    simulation->results()->dataStore()->compact();
+                }
+
+                if (output.isEmpty() && (elapsedTime == -1)) {
+                    output = "The simulation could not be run.";
+                }
+
+                // Output the results of our simulation, be it to the given
+                // output file or to the console
+
+                if (output.isEmpty()) {
+                    if (arguments.count() == 2) {
+                        QFile file(arguments[1]);
+
+                        if (!file.open(QIODevice::WriteOnly)) {
+                            output = "The output file could not be created.";
+                        } else {
+                            QTextStream stream(&file);
+
+                            if (!writeResults(simulation, stream)) {
+                                output = "The output file could not be written.";
+                            }
+
+                            file.close();
+                        }
+                    } else {
+                        QTextStream stream(stdout);
+
+                        writeResults(simulation, stream);
+                    }
+
+                    if (output.isEmpty()) {
+                        std::cerr << QString("The simulation was run in %1 ms.").arg(elapsedTime).toStdString() << std::endl;
+
+                        // Output the statistics of our simulation, if
+                        // requested
+
+                        if (statisticsEnabled) {
+                            const Solver::Solver::Statistics statistics = simulation->results()->statistics();
+
+                            for (auto statistic = statistics.constBegin(),
+                                      statisticEnd = statistics.constEnd();
+                                 statistic != statisticEnd; ++statistic) {
+                                std::cerr << QString(" - %1: %2").arg(statistic.key())
+                                                                 .arg(statistic.value()).toStdString() << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // We are done (whether the command was successful or not), so unmanage our
+    // simulation and file
+
+    simulationManager->unmanage(fileName);
+    Core::FileManager::instance()->unmanage(fileName);
+
+    // Let the user know about any output we got and leave with the appropriate
+    // command code
+
+    if (!output.isEmpty()) {
+        std::cout << output.toStdString() << std::endl;
+    }
+
+    return output.isEmpty();
+}
+
 //==============================================================================
 
 } // namespace SimulationSupport
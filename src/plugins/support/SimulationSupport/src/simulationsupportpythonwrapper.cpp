@@ -30,6 +30,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 #include "simulation.h"
 #include "simulationmanager.h"
 #include "simulationsupportpythonwrapper.h"
+#include "simulationsweep.h"
 
 //==============================================================================
 
@@ -42,6 +43,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include <array>
 #include <memory>
+#include <utility>
 
 //==============================================================================
 
@@ -314,6 +316,17 @@ bool SimulationSupportPythonWrapper::run(Simulation *pSimulation)
 
         mWaitLoop.exec();
 
+        // Release the memory that was used by our simulation results while
+        // they were growing and shrink them to their actual size
+        // Note: NumPy arrays hold the data store array they wrap, so they are
+        //       not affected by this, which means that we can compact our
+        //       simulation results again straightaway should they have been
+        //       shrunk (see DataStoreVariableRun::compact())...
+
+        if (pSimulation->results()->dataStore()->compact()) {
+            pSimulation->results()->dataStore()->compact();
+        }
+
         // Throw any error message that has been generated
 
         if (!mErrorMessage.isEmpty()) {
@@ -334,6 +347,176 @@ bool SimulationSupportPythonWrapper::run(Simulation *pSimulation)
 
 //==============================================================================
 
+static PyObject * sweepValuesDict(DataStore::DataStoreValues *pDataStoreValues,
+                                  const SimulationSweepResult &pResult,
+                                  const double * (SimulationSweepResult::*pValues)(quint64) const)
+{
+    // Create and return a Python dictionary with the values of the given
+    // result for the given data store values
+
+    PyObject *res = PyDict_New();
+
+    for (int i = 0, iMax = pDataStoreValues->size(); i < iMax; ++i) {
+        PyObject *values = PyList_New(Py_ssize_t(pResult.size()));
+
+        for (quint64 j = 0, jMax = pResult.size(); j < jMax; ++j) {
+            PyList_SetItem(values, Py_ssize_t(j), PyFloat_FromDouble((pResult.*pValues)(j)[i]));
+        }
+
+        PyDict_SetItemString(res, pDataStoreValues->at(i)->uri().toUtf8().constData(), values);
+
+        Py_DECREF(values);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
+PyObject * SimulationSupportPythonWrapper::sweep(Simulation *pSimulation,
+                                                 PyObject *pVariants,
+                                                 int pThreadCount)
+{
+    // Run the given variants of the given simulation, but only if it doesn't
+    // have blocking issues, if it is valid and if it is not running (or
+    // paused)
+    // Note: each variant is a dictionary that maps the URI of a constant or
+    //       state to its (initial) value...
+
+    if (pSimulation->hasBlockingIssues()) {
+        throw std::runtime_error(tr("The simulation has blocking issues and cannot therefore be run.").toStdString());
+    }
+
+    if (!doValid(pSimulation)) {
+        throw std::runtime_error(tr("The simulation has an invalid runtime and cannot therefore be run.").toStdString());
+    }
+
+    if (pSimulation->worker() != nullptr) {
+        throw std::runtime_error(tr("The simulation is running and its variants cannot therefore be run.").toStdString());
+    }
+
+    // Convert our Python variants to simulation sweep variants
+
+    SimulationData *data = pSimulation->data();
+    DataStore::DataStoreValues *constantsValues = data->constantsValues();
+    DataStore::DataStoreValues *statesValues = data->statesValues();
+    SimulationSweepVariants variants;
+    Py_ssize_t variantsCount = PyList_Size(pVariants);
+
+    if (variantsCount < 0) {
+        PyErr_Clear();
+
+        throw std::runtime_error(tr("The variants must be a list of dictionaries.").toStdString());
+    }
+
+    for (Py_ssize_t i = 0; i < variantsCount; ++i) {
+        PyObject *pythonVariant = PyList_GetItem(pVariants, i);
+
+        if (PyDict_Size(pythonVariant) < 0) {
+            PyErr_Clear();
+
+            throw std::runtime_error(tr("The variants must be a list of dictionaries.").toStdString());
+        }
+
+        SimulationSweepVariant variant;
+        PyObject *key;
+        PyObject *value;
+        Py_ssize_t position = 0;
+
+        while (PyDict_Next(pythonVariant, &position, &key, &value) != 0) {
+            const char *utf8Uri = PyUnicode_AsUTF8(key);
+
+            if (utf8Uri == nullptr) {
+                PyErr_Clear();
+
+                throw std::runtime_error(tr("The variants must be a list of dictionaries.").toStdString());
+            }
+
+            QString uri = QString::fromUtf8(utf8Uri);
+            double doubleValue = PyFloat_AsDouble(value);
+
+            if (PyErr_Occurred() != nullptr) {
+                PyErr_Clear();
+
+                throw std::runtime_error(tr("The value of '%1' must be a number.").arg(uri).toStdString());
+            }
+
+            bool found = false;
+
+            for (int j = 0, jMax = constantsValues->size(); (j < jMax) && !found; ++j) {
+                if (constantsValues->at(j)->uri() == uri) {
+                    variant.setConstant(j, doubleValue);
+
+                    found = true;
+                }
+            }
+
+            for (int j = 0, jMax = statesValues->size(); (j < jMax) && !found; ++j) {
+                if (statesValues->at(j)->uri() == uri) {
+                    variant.setState(j, doubleValue);
+
+                    found = true;
+                }
+            }
+
+            if (!found) {
+                throw std::runtime_error(tr("'%1' is neither a constant nor a state.").arg(uri).toStdString());
+            }
+        }
+
+        variants << variant;
+    }
+
+    // Run our variants
+
+    SimulationSweep simulationSweep(pSimulation);
+
+    simulationSweep.run(variants, pThreadCount);
+
+    // Return the results of our variants as a list of dictionaries
+
+    const SimulationSweepResults results = simulationSweep.results();
+    PyObject *res = PyList_New(Py_ssize_t(results.count()));
+    Py_ssize_t i = 0;
+
+    for (const auto &result : results) {
+        PyObject *pythonResult = PyDict_New();
+        PyObject *voi = PyList_New(Py_ssize_t(result.size()));
+
+        for (quint64 j = 0, jMax = result.size(); j < jMax; ++j) {
+            PyList_SetItem(voi, Py_ssize_t(j), PyFloat_FromDouble(result.voi()[j]));
+        }
+
+        PyDict_SetItemString(pythonResult, "voi", voi);
+
+        Py_DECREF(voi);
+
+        std::array<std::pair<const char *, PyObject *>, 3> values = {{
+                                                                         { "states", sweepValuesDict(statesValues, result, &SimulationSweepResult::states) },
+                                                                         { "rates", sweepValuesDict(data->ratesValues(), result, &SimulationSweepResult::rates) },
+                                                                         { "algebraic", sweepValuesDict(data->algebraicValues(), result, &SimulationSweepResult::algebraic) }
+                                                                     }};
+
+        for (const auto &value : values) {
+            PyDict_SetItemString(pythonResult, value.first, value.second);
+
+            Py_DECREF(value.second);
+        }
+
+        PyObject *error = PyUnicode_FromString(result.error().toUtf8().constData());
+
+        PyDict_SetItemString(pythonResult, "error", error);
+
+        Py_DECREF(error);
+
+        PyList_SetItem(res, i++, pythonResult);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 void SimulationSupportPythonWrapper::reset(Simulation *pSimulation, bool pAll)
 {
     // Reset the given simulation
@@ -519,6 +702,44 @@ void SimulationSupportPythonWrapper::set_nla_solver_property(SimulationData *pSi
 
 //==============================================================================
 
+bool SimulationSupportPythonWrapper::statistics_enabled(SimulationData *pSimulationData)
+{
+    // Return whether statistics are enabled for the given simulation data
+
+    return pSimulationData->statisticsEnabled();
+}
+
+//==============================================================================
+
+void SimulationSupportPythonWrapper::set_statistics_enabled(SimulationData *pSimulationData,
+                                                            bool pStatisticsEnabled)
+{
+    // Enable/disable statistics for the given simulation data
+
+    pSimulationData->setStatisticsEnabled(pStatisticsEnabled);
+}
+
+//==============================================================================
+
+bool SimulationSupportPythonWrapper::steady_state(SimulationData *pSimulationData)
+{
+    // Return whether the given simulation data computes a steady state
+
+    return pSimulationData->steadyState();
+}
+
+//==============================================================================
+
+void SimulationSupportPythonWrapper::set_steady_state(SimulationData *pSimulationData,
+                                                      bool pSteadyState)
+{
+    // Set whether the given simulation data computes a steady state
+
+    pSimulationData->setSteadyState(pSteadyState);
+}
+
+//==============================================================================
+
 PyObject * SimulationSupportPythonWrapper::constants(SimulationData *pSimulationData) const
 {
     // Return the constants values for the given simulation data
@@ -613,6 +834,31 @@ PyObject * SimulationSupportPythonWrapper::algebraic(SimulationResults *pSimulat
 
 //==============================================================================
 
+PyObject * SimulationSupportPythonWrapper::statistics(SimulationResults *pSimulationResults,
+                                                      int pRun) const
+{
+    // Return the statistics for the given run of the given simulation results
+    // as a Python dictionary
+    // Note: the dictionary is empty if statistics were not enabled when running
+    //       the simulation...
+
+    PyObject *res = PyDict_New();
+    const Solver::Solver::Statistics statistics = pSimulationResults->statistics(pRun);
+
+    for (auto statistic = statistics.constBegin(), statisticEnd = statistics.constEnd();
+         statistic != statisticEnd; ++statistic) {
+        PyObject *value = PyLong_FromUnsignedLongLong(statistic.value());
+
+        PyDict_SetItemString(res, statistic.key().toUtf8().constData(), value);
+
+        Py_DECREF(value);
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 void SimulationSupportPythonWrapper::set_value(DataStore::DataStoreValue *pDataStoreValue,
                                                double pValue)
 {
@@ -77,6 +77,8 @@ public slots:
     bool valid(OpenCOR::SimulationSupport::Simulation *pSimulation);
 
     bool run(OpenCOR::SimulationSupport::Simulation *pSimulation);
+    PyObject * sweep(OpenCOR::SimulationSupport::Simulation *pSimulation,
+                     PyObject *pVariants, int pThreadCount = 0);
 
     void reset(OpenCOR::SimulationSupport::Simulation *pSimulation,
                bool pAll = true);
@@ -114,6 +116,14 @@ public slots:
     void set_nla_solver_property(OpenCOR::SimulationSupport::SimulationData *pSimulationData,
                                  const QString &pName, const QVariant &pValue);
 
+    bool statistics_enabled(OpenCOR::SimulationSupport::SimulationData *pSimulationData);
+    void set_statistics_enabled(OpenCOR::SimulationSupport::SimulationData *pSimulationData,
+                                bool pStatisticsEnabled);
+
+    bool steady_state(OpenCOR::SimulationSupport::SimulationData *pSimulationData);
+    void set_steady_state(OpenCOR::SimulationSupport::SimulationData *pSimulationData,
+                          bool pSteadyState);
+
     PyObject * constants(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
     PyObject * rates(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
     PyObject * states(OpenCOR::SimulationSupport::SimulationData *pSimulationData) const;
@@ -128,6 +138,9 @@ public slots:
     PyObject * rates(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
     PyObject * algebraic(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults) const;
 
+    PyObject * statistics(OpenCOR::SimulationSupport::SimulationResults *pSimulationResults,
+                          int pRun = -1) const;
+
     void set_value(OpenCOR::DataStore::DataStoreValue *pDataStoreValue,
                    double pValue);
 
@@ -0,0 +1,801 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Simulation sweep
+//==============================================================================
+
+#include "cellmlfileruntime.h"
+#include "simulation.h"
+#include "simulationsweep.h"
+
+//==============================================================================
+
+#include <QElapsedTimer>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+//==============================================================================
+
+#include <algorithm>
+#include <limits>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace SimulationSupport {
+
+//==============================================================================
+
+void SimulationSweepVariant::setConstant(int pIndex, double pValue)
+{
+    // Override the value of the given constant
+
+    mConstants.insert(pIndex, pValue);
+}
+
+//==============================================================================
+
+void SimulationSweepVariant::setState(int pIndex, double pValue)
+{
+    // Override the initial value of the given state
+
+    mStates.insert(pIndex, pValue);
+}
+
+//==============================================================================
+
+QMap<int, double> SimulationSweepVariant::constants() const
+{
+    // Return our overridden constants
+
+    return mConstants;
+}
+
+//==============================================================================
+
+QMap<int, double> SimulationSweepVariant::states() const
+{
+    // Return our overridden states
+
+    return mStates;
+}
+
+//==============================================================================
+
+quint64 SimulationSweepResult::size() const
+{
+    // Return our size, i.e. our number of points
+
+    return mSize;
+}
+
+//==============================================================================
+
+const double * SimulationSweepResult::voi() const
+{
+    // Return our VOI values
+
+    return mVoi.constData();
+}
+
+//==============================================================================
+
+const double * SimulationSweepResult::rates(quint64 pPosition) const
+{
+    // Return our rates at the given position
+
+    return mRates.constData()+pPosition*quint64(mRatesCount);
+}
+
+//==============================================================================
+
+const double * SimulationSweepResult::states(quint64 pPosition) const
+{
+    // Return our states at the given position
+
+    return mStates.constData()+pPosition*quint64(mStatesCount);
+}
+
+//==============================================================================
+
+const double * SimulationSweepResult::algebraic(quint64 pPosition) const
+{
+    // Return our algebraic variables at the given position
+
+    return mAlgebraic.constData()+pPosition*quint64(mAlgebraicCount);
+}
+
+//==============================================================================
+
+QString SimulationSweepResult::error() const
+{
+    // Return our error, if any
+
+    return mError;
+}
+
+//==============================================================================
+
+class SimulationSweepTask : public QRunnable
+{
+public:
+    explicit SimulationSweepTask(Simulation *pSimulation,
+                                 const QVector<double> &pConstants,
+                                 const QVector<double> &pStates,
+                                 const SimulationSweepVariant &pVariant,
+                                 SimulationSweepResult *pResult);
+
+    void run() override;
+
+private:
+    CellMLSupport::CellmlFileRuntime *mRuntime;
+
+    double mStartingPoint;
+    double mEndingPoint;
+    double mPointInterval;
+    quint64 mSize;
+
+    SolverInterface *mOdeSolverInterface;
+    Solver::Solver::Properties mOdeSolverProperties;
+
+    SolverInterface *mNlaSolverInterface;
+    Solver::Solver::Properties mNlaSolverProperties;
+
+    const QVector<double> &mConstants;
+    const QVector<double> &mStates;
+
+    SimulationSweepVariant mVariant;
+    SimulationSweepResult *mResult;
+};
+
+//==============================================================================
+
+SimulationSweepTask::SimulationSweepTask(Simulation *pSimulation,
+                                         const QVector<double> &pConstants,
+                                         const QVector<double> &pStates,
+                                         const SimulationSweepVariant &pVariant,
+                                         SimulationSweepResult *pResult) :
+    mRuntime(pSimulation->runtime()),
+    mStartingPoint(pSimulation->data()->startingPoint()),
+    mEndingPoint(pSimulation->data()->endingPoint()),
+    mPointInterval(pSimulation->data()->pointInterval()),
+    mSize(pSimulation->size()),
+    mOdeSolverInterface(pSimulation->data()->odeSolverInterface()),
+    mOdeSolverProperties(pSimulation->data()->odeSolverProperties()),
+    mNlaSolverInterface(pSimulation->data()->nlaSolverInterface()),
+    mNlaSolverProperties(pSimulation->data()->nlaSolverProperties()),
+    mConstants(pConstants),
+    mStates(pStates),
+    mVariant(pVariant),
+    mResult(pResult)
+{
+}
+
+//==============================================================================
+
+void SimulationSweepTask::run()
+{
+    // Create our own copy of our model's data
+    // Note: our runtime is shared between all our tasks, but its functions only
+    //       work on the data that they are given, so we can safely call them
+    //       from different threads at once...
+
+    int constantsCount = mRuntime->constantsCount();
+    int ratesCount = mRuntime->ratesCount();
+    int statesCount = mRuntime->statesCount();
+    int algebraicCount = mRuntime->algebraicCount();
+
+    QVector<double> constants = mConstants;
+    QVector<double> rates(ratesCount);
+    QVector<double> states = mStates;
+    QVector<double> algebraic(algebraicCount);
+
+    // Apply our variant and (re)compute our 'computed constants' and
+    // 'variables'
+
+    const QMap<int, double> variantConstants = mVariant.constants();
+    const QMap<int, double> variantStates = mVariant.states();
+
+    for (auto constant = variantConstants.constBegin(),
+              constantEnd = variantConstants.constEnd();
+         constant != constantEnd; ++constant) {
+        if ((constant.key() >= 0) && (constant.key() < constantsCount)) {
+            constants[constant.key()] = constant.value();
+        }
+    }
+
+    // Set up our NLA solver, if needed
+    // Note: an NLA solver is associated with our runtime rather than with our
+    //       data, which is why our simulation sweep runs its tasks one at a
+    //       time should our runtime need an NLA solver...
+
+    Solver::NlaSolver *nlaSolver = nullptr;
+    QString error;
+
+    if (mRuntime->needNlaSolver()) {
+        nlaSolver = static_cast<Solver::NlaSolver *>(mNlaSolverInterface->solverInstance());
+
+        mRuntime->setNlaSolver(nlaSolver);
+
+        QObject::connect(nlaSolver, &Solver::NlaSolver::error, [&error](const QString &pMessage) {
+            error = pMessage;
+        });
+
+        nlaSolver->setProperties(mNlaSolverProperties);
+    }
+
+    mRuntime->computeComputedConstants()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    for (auto state = variantStates.constBegin(),
+              stateEnd = variantStates.constEnd();
+         state != stateEnd; ++state) {
+        if ((state.key() >= 0) && (state.key() < statesCount)) {
+            states[state.key()] = state.value();
+        }
+    }
+
+    mRuntime->computeRates()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+    mRuntime->computeVariables()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Set up our result
+    // Note: SimulationSweep::run() has already made sure that our result can
+    //       be held in QVectors...
+
+    mResult->mRatesCount = ratesCount;
+    mResult->mStatesCount = statesCount;
+    mResult->mAlgebraicCount = algebraicCount;
+
+    mResult->mVoi.resize(int(mSize));
+    mResult->mRates.resize(int(mSize*quint64(ratesCount)));
+    mResult->mStates.resize(int(mSize*quint64(statesCount)));
+    mResult->mAlgebraic.resize(int(mSize*quint64(algebraicCount)));
+
+    // Set up and initialise our ODE solver
+
+    auto odeSolver = static_cast<Solver::OdeSolver *>(mOdeSolverInterface->solverInstance());
+
+    QObject::connect(odeSolver, &Solver::OdeSolver::error, [&error](const QString &pMessage) {
+        error = pMessage;
+    });
+
+    odeSolver->setProperties(mOdeSolverProperties);
+
+    if (odeSolver->needJacobian() && (mRuntime->computeJacobian() != nullptr)) {
+        odeSolver->setJacobian(mRuntime->computeJacobian(),
+                               mRuntime->jacobianRows(),
+                               mRuntime->jacobianColumns());
+    }
+
+    if (   odeSolver->needQuasiLinearCoefficients()
+        && (mRuntime->computeQuasiLinearCoefficients() != nullptr)) {
+        odeSolver->setQuasiLinearCoefficients(mRuntime->computeQuasiLinearCoefficients(),
+                                              mRuntime->quasiLinearStates());
+    }
+
+    if (   (odeSolver->fixedStepMethod() != Solver::FixedStepMethod::None)
+        && (mRuntime->integrate() != nullptr)) {
+        odeSolver->setIntegrator(mRuntime->integrate());
+    }
+
+    if (odeSolver->needRootInformation() && (mRuntime->conditionVariablesCount() != 0)) {
+        odeSolver->setRootInformation(mRuntime->computeRootInformation(),
+                                      mRuntime->conditionVariablesCount());
+    }
+
+    // Let our ODE solver integrate our NLA systems along with our ODEs, if it
+    // can
+
+    bool reinitializeOdeSolver = false;
+
+    if (nlaSolver != nullptr) {
+        Solver::NlaSolver *modelNlaSolver = odeSolver->wrapNlaSolver(nlaSolver);
+
+        mRuntime->setNlaSolver(modelNlaSolver);
+
+        reinitializeOdeSolver = modelNlaSolver == nlaSolver;
+    }
+
+    double currentPoint = mStartingPoint;
+
+    odeSolver->initialize(currentPoint, statesCount, constants.data(),
+                          rates.data(), states.data(), algebraic.data(),
+                          mRuntime->computeRates());
+
+    // Compute our model and keep track of its results, but only if no error
+    // has occurred so far
+
+    quint64 pointCounter = 0;
+
+    while (error.isEmpty()) {
+        // Keep track of our current point
+
+        mResult->mVoi[int(pointCounter)] = currentPoint;
+
+        memcpy(mResult->mRates.data()+pointCounter*quint64(ratesCount), rates.constData(), size_t(ratesCount)*Solver::SizeOfDouble);
+        memcpy(mResult->mStates.data()+pointCounter*quint64(statesCount), states.constData(), size_t(statesCount)*Solver::SizeOfDouble);
+        memcpy(mResult->mAlgebraic.data()+pointCounter*quint64(algebraicCount), algebraic.constData(), size_t(algebraicCount)*Solver::SizeOfDouble);
+
+        mResult->mSize = ++pointCounter;
+
+        if (qFuzzyCompare(currentPoint, mEndingPoint) || (pointCounter == mSize)) {
+            break;
+        }
+
+        // Reinitialise our ODE solver, if we have an NLA solver (unless our
+        // ODE solver integrates our NLA systems itself), and compute our model
+        // up to our next point
+
+        if (reinitializeOdeSolver) {
+            odeSolver->reinitialize(currentPoint);
+        }
+
+        odeSolver->solve(currentPoint,
+                         qMin(mEndingPoint,
+                              mStartingPoint+double(pointCounter)*mPointInterval));
+
+        mRuntime->computeRates()(currentPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+        mRuntime->computeVariables()(currentPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+    }
+
+    mResult->mError = error;
+
+    // Make sure that our runtime doesn't refer to our NLA solver anymore since
+    // we are about to delete it
+
+    if (nlaSolver != nullptr) {
+        mRuntime->setNlaSolver(nullptr);
+    }
+
+    // Delete our solver(s)
+
+    delete odeSolver;
+
+    if (nlaSolver != nullptr) {
+        delete nlaSolver;
+    }
+}
+
+//==============================================================================
+
+class SimulationSweepEnsembleTask : public QRunnable
+{
+public:
+    explicit SimulationSweepEnsembleTask(Simulation *pSimulation,
+                                         const QVector<double> &pConstants,
+                                         const QVector<double> &pStates,
+                                         const SimulationSweepVariants &pVariants,
+                                         const QList<SimulationSweepResult *> &pResults);
+
+    void run() override;
+
+private:
+    CellMLSupport::CellmlFileRuntime *mRuntime;
+
+    double mStartingPoint;
+    double mEndingPoint;
+    double mPointInterval;
+    quint64 mSize;
+
+    SolverInterface *mOdeSolverInterface;
+    Solver::Solver::Properties mOdeSolverProperties;
+
+    const QVector<double> &mConstants;
+    const QVector<double> &mStates;
+
+    SimulationSweepVariants mVariants;
+    QList<SimulationSweepResult *> mResults;
+};
+
+//==============================================================================
+
+SimulationSweepEnsembleTask::SimulationSweepEnsembleTask(Simulation *pSimulation,
+                                                         const QVector<double> &pConstants,
+                                                         const QVector<double> &pStates,
+                                                         const SimulationSweepVariants &pVariants,
+                                                         const QList<SimulationSweepResult *> &pResults) :
+    mRuntime(pSimulation->runtime()),
+    mStartingPoint(pSimulation->data()->startingPoint()),
+    mEndingPoint(pSimulation->data()->endingPoint()),
+    mPointInterval(pSimulation->data()->pointInterval()),
+    mSize(pSimulation->size()),
+    mOdeSolverInterface(pSimulation->data()->odeSolverInterface()),
+    mOdeSolverProperties(pSimulation->data()->odeSolverProperties()),
+    mConstants(pConstants),
+    mStates(pStates),
+    mVariants(pVariants),
+    mResults(pResults)
+{
+}
+
+//==============================================================================
+
+void SimulationSweepEnsembleTask::run()
+{
+    // Create the data of our ensemble, i.e. the data of each of its instances
+    // stored as a structure of arrays (see
+    // CellmlFileRuntime::compileEnsemble())
+    // Note: our ensemble may have more instances than we have variants, in
+    //       which case our extra instances are computed using our model's data
+    //       as is and their results are simply discarded...
+
+    int ensembleSize = mRuntime->ensembleSize();
+    int variantsCount = mVariants.count();
+    int constantsCount = mRuntime->constantsCount();
+    int ratesCount = mRuntime->ratesCount();
+    int statesCount = mRuntime->statesCount();
+    int algebraicCount = mRuntime->algebraicCount();
+
+    QVector<double> constants(constantsCount*ensembleSize);
+    QVector<double> rates(ratesCount*ensembleSize);
+    QVector<double> states(statesCount*ensembleSize);
+    QVector<double> algebraic(algebraicCount*ensembleSize);
+
+    for (int i = 0; i < constantsCount; ++i) {
+        std::fill_n(constants.begin()+i*ensembleSize, ensembleSize, mConstants[i]);
+    }
+
+    for (int i = 0; i < statesCount; ++i) {
+        std::fill_n(states.begin()+i*ensembleSize, ensembleSize, mStates[i]);
+    }
+
+    // Apply our variants and (re)compute our 'computed constants' and
+    // 'variables'
+
+    for (int n = 0; n < variantsCount; ++n) {
+        const QMap<int, double> variantConstants = mVariants[n].constants();
+
+        for (auto constant = variantConstants.constBegin(),
+                  constantEnd = variantConstants.constEnd();
+             constant != constantEnd; ++constant) {
+            if ((constant.key() >= 0) && (constant.key() < constantsCount)) {
+                constants[constant.key()*ensembleSize+n] = constant.value();
+            }
+        }
+    }
+
+    mRuntime->computeEnsembleComputedConstants()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    for (int n = 0; n < variantsCount; ++n) {
+        const QMap<int, double> variantStates = mVariants[n].states();
+
+        for (auto state = variantStates.constBegin(),
+                  stateEnd = variantStates.constEnd();
+             state != stateEnd; ++state) {
+            if ((state.key() >= 0) && (state.key() < statesCount)) {
+                states[state.key()*ensembleSize+n] = state.value();
+            }
+        }
+    }
+
+    mRuntime->computeEnsembleRates()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+    mRuntime->computeEnsembleVariables()(mStartingPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+
+    // Set up our results
+    // Note: SimulationSweep::run() has already made sure that our results can
+    //       be held in QVectors...
+
+    for (auto result : qAsConst(mResults)) {
+        result->mRatesCount = ratesCount;
+        result->mStatesCount = statesCount;
+        result->mAlgebraicCount = algebraicCount;
+
+        result->mVoi.resize(int(mSize));
+        result->mRates.resize(int(mSize*quint64(ratesCount)));
+        result->mStates.resize(int(mSize*quint64(statesCount)));
+        result->mAlgebraic.resize(int(mSize*quint64(algebraicCount)));
+    }
+
+    // Set up and initialise our ODE solver
+    // Note: our ODE solver is a fixed-step one, which means that it doesn't
+    //       need our Jacobian, quasi-linear coefficients or root information,
+    //       and that it updates its states element-wise, so it can integrate
+    //       all the instances of our ensemble at once. It cannot, however, use
+    //       our model's integrator since it only integrates one instance of
+    //       our model...
+
+    auto odeSolver = static_cast<Solver::OdeSolver *>(mOdeSolverInterface->solverInstance());
+    QString error;
+
+    QObject::connect(odeSolver, &Solver::OdeSolver::error, [&error](const QString &pMessage) {
+        error = pMessage;
+    });
+
+    odeSolver->setProperties(mOdeSolverProperties);
+
+    double currentPoint = mStartingPoint;
+
+    odeSolver->initialize(currentPoint, statesCount*ensembleSize,
+                          constants.data(), rates.data(), states.data(),
+                          algebraic.data(), mRuntime->computeEnsembleRates());
+
+    // Compute our ensemble and keep track of the results of our variants, but
+    // only if no error has occurred so far
+
+    quint64 pointCounter = 0;
+
+    while (error.isEmpty()) {
+        // Keep track of our current point for each of our variants
+
+        for (int n = 0; n < variantsCount; ++n) {
+            SimulationSweepResult *result = mResults[n];
+            double *resultRates = result->mRates.data()+pointCounter*quint64(ratesCount);
+            double *resultStates = result->mStates.data()+pointCounter*quint64(statesCount);
+            double *resultAlgebraic = result->mAlgebraic.data()+pointCounter*quint64(algebraicCount);
+
+            result->mVoi[int(pointCounter)] = currentPoint;
+
+            for (int i = 0; i < ratesCount; ++i) {
+                resultRates[i] = rates[i*ensembleSize+n];
+            }
+
+            for (int i = 0; i < statesCount; ++i) {
+                resultStates[i] = states[i*ensembleSize+n];
+            }
+
+            for (int i = 0; i < algebraicCount; ++i) {
+                resultAlgebraic[i] = algebraic[i*ensembleSize+n];
+            }
+
+            result->mSize = pointCounter+1;
+        }
+
+        ++pointCounter;
+
+        if (qFuzzyCompare(currentPoint, mEndingPoint) || (pointCounter == mSize)) {
+            break;
+        }
+
+        // Compute our ensemble up to our next point
+
+        odeSolver->solve(currentPoint,
+                         qMin(mEndingPoint,
+                              mStartingPoint+double(pointCounter)*mPointInterval));
+
+        mRuntime->computeEnsembleRates()(currentPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+        mRuntime->computeEnsembleVariables()(currentPoint, constants.data(), rates.data(), states.data(), algebraic.data());
+    }
+
+    for (auto result : qAsConst(mResults)) {
+        result->mError = error;
+    }
+
+    // Delete our solver
+
+    delete odeSolver;
+}
+
+//==============================================================================
+
+SimulationSweep::SimulationSweep(Simulation *pSimulation) :
+    mSimulation(pSimulation)
+{
+}
+
+//==============================================================================
+
+bool SimulationSweep::run(const SimulationSweepVariants &pVariants,
+                          int pThreadCount)
+{
+    // Make sure that our simulation is not running (or paused), that we have a
+    // valid runtime and an ODE solver, and that the simulation settings we were
+    // given are sound
+    // Note: our simulation must not be running (or paused) since we are going
+    //       to modify its runtime, which its worker might be using. Indeed, we
+    //       are going to use the fully optimised code of our model (meaning
+    //       that the code that our simulation's worker uses might get
+    //       released), compile its Jacobian, quasi-linear coefficients and/or
+    //       integrator, and (re)set its NLA solver (see
+    //       SimulationSweepTask::run())...
+
+    mResults.clear();
+
+    mElapsedTime = -1;
+
+    CellMLSupport::CellmlFileRuntime *runtime = mSimulation->runtime();
+
+    if (   (mSimulation->worker() != nullptr)
+        || (runtime == nullptr) || !runtime->isValid()
+        || (mSimulation->data()->odeSolverInterface() == nullptr)
+        || (runtime->needNlaSolver() && (mSimulation->data()->nlaSolverInterface() == nullptr))
+        || (mSimulation->size() == 0)) {
+        return false;
+    }
+
+    // Create a result for each of our variants
+    // Note: we retrieve a pointer to each of our results before running any of
+    //       our tasks, so that they don't end up detaching our list...
+
+    QList<SimulationSweepResult *> results;
+
+    for (int i = 0, iMax = pVariants.count(); i < iMax; ++i) {
+        mResults << SimulationSweepResult();
+    }
+
+    for (auto &result : mResults) {
+        results << &result;
+    }
+
+    // Make sure that the results of each of our variants can be held in a
+    // QVector
+    // Note: a QVector cannot be bigger than MaximumValuesCount doubles, so
+    //       rather than overflowing its size, we report an error for each of
+    //       our variants...
+
+    static const quint64 MaximumValuesCount = (quint64(std::numeric_limits<int>::max())-sizeof(QArrayData))/Solver::SizeOfDouble;
+
+    quint64 valuesCount = quint64(qMax(1, qMax(runtime->ratesCount(),
+                                                qMax(runtime->statesCount(),
+                                                     runtime->algebraicCount()))));
+
+    if (mSimulation->size() > MaximumValuesCount/valuesCount) {
+        QString error = tr("the simulation has too many points to be swept");
+
+        for (auto result : results) {
+            result->mError = error;
+        }
+
+        return false;
+    }
+
+    // Make sure that we use the fully optimised code of our model
+    // Note: this has to be done before running any of our tasks since it
+    //       modifies our runtime, which is shared between all our tasks...
+
+    runtime->useOptimisedCode(true);
+
+    // Retrieve the current values of our constants and states, which are to be
+    // used as the basis for each of our variants
+
+    QVector<double> constants(runtime->constantsCount());
+    QVector<double> states(runtime->statesCount());
+
+    memcpy(constants.data(), mSimulation->data()->constants(), size_t(constants.count())*Solver::SizeOfDouble);
+    memcpy(states.data(), mSimulation->data()->states(), size_t(states.count())*Solver::SizeOfDouble);
+
+    // Determine how many threads we can use
+    // Note: we can only use one thread if our runtime needs an NLA solver (see
+    //       SimulationSweepTask::run())...
+
+    int variantsCount = pVariants.count();
+    int threadCount = runtime->needNlaSolver()?
+                          1:
+                          (pThreadCount > 0)?
+                              pThreadCount:
+                              QThread::idealThreadCount();
+
+    // Determine whether we can run our variants as ensembles, i.e. several
+    // variants at once using the ensemble version of our model's functions,
+    // which can be vectorised by the compiler
+    // Note #1: this requires a fixed-step ODE solver (since all the instances
+    //          of an ensemble must use the same steps) and a model that
+    //          doesn't need an NLA solver (see
+    //          CellmlFileRuntime::compileEnsemble())...
+    // Note #2: our ensembles are as big as possible, but still small enough
+    //          to keep all our threads busy, and no bigger than
+    //          MaximumEnsembleSize instances, so that their data remains small
+    //          enough to fit in the cache of a CPU core...
+
+    static const int MaximumEnsembleSize = 32;
+
+    auto odeSolver = static_cast<Solver::OdeSolver *>(mSimulation->data()->odeSolverInterface()->solverInstance());
+
+    odeSolver->setProperties(mSimulation->data()->odeSolverProperties());
+
+    int ensembleSize = 1;
+
+    if (   (odeSolver->fixedStepMethod() != Solver::FixedStepMethod::None)
+        && !runtime->needNlaSolver()) {
+        ensembleSize = qMin(MaximumEnsembleSize,
+                            (variantsCount+threadCount-1)/threadCount);
+
+        if ((ensembleSize > 1) && !runtime->compileEnsemble(ensembleSize)) {
+            ensembleSize = 1;
+        }
+    }
+
+    // Compile the Jacobian, the quasi-linear coefficients and/or an integrator
+    // for our model, if our ODE solver needs them and we are not to use
+    // ensembles
+    // Note: this has to be done before running any of our tasks since it
+    //       modifies our runtime, which is shared between all our tasks...
+
+    if (ensembleSize == 1) {
+        if (odeSolver->needJacobian()) {
+            runtime->compileJacobian();
+        }
+
+        if (odeSolver->needQuasiLinearCoefficients()) {
+            runtime->compileQuasiLinearCoefficients();
+        }
+
+        if (odeSolver->fixedStepMethod() != Solver::FixedStepMethod::None) {
+            runtime->compileIntegrator(odeSolver->fixedStepMethod());
+        }
+    }
+
+    delete odeSolver;
+
+    // Run our variants, or ensembles of them, using a thread pool
+
+    QThreadPool threadPool;
+
+    threadPool.setMaxThreadCount(threadCount);
+
+    QElapsedTimer timer;
+
+    timer.start();
+
+    if (ensembleSize > 1) {
+        for (int i = 0; i < variantsCount; i += ensembleSize) {
+            int count = qMin(ensembleSize, variantsCount-i);
+
+            threadPool.start(new SimulationSweepEnsembleTask(mSimulation, constants, states,
+                                                             pVariants.mid(i, count),
+                                                             results.mid(i, count)));
+        }
+    } else {
+        for (int i = 0; i < variantsCount; ++i) {
+            threadPool.start(new SimulationSweepTask(mSimulation, constants, states,
+                                                     pVariants[i], results[i]));
+        }
+    }
+
+    threadPool.waitForDone();
+
+    // Determine whether all our variants were run successfully
+
+    mElapsedTime = timer.elapsed();
+
+    for (const auto &result : qAsConst(mResults)) {
+        if (!result.error().isEmpty()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+SimulationSweepResults SimulationSweep::results() const
+{
+    // Return our results
+
+    return mResults;
+}
+
+//==============================================================================
+
+qint64 SimulationSweep::elapsedTime() const
+{
+    // Return the time it took to run our variants
+
+    return mElapsedTime;
+}
+
+//==============================================================================
+
+} // namespace SimulationSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -0,0 +1,133 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// Simulation sweep
+//==============================================================================
+
+#pragma once
+
+//==============================================================================
+
+#include "simulationsupportglobal.h"
+#include "solverinterface.h"
+
+//==============================================================================
+
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+//==============================================================================
+
+namespace OpenCOR {
+namespace SimulationSupport {
+
+//==============================================================================
+
+class Simulation;
+
+//==============================================================================
+
+class SIMULATIONSUPPORT_EXPORT SimulationSweepVariant
+{
+public:
+    void setConstant(int pIndex, double pValue);
+    void setState(int pIndex, double pValue);
+
+    QMap<int, double> constants() const;
+    QMap<int, double> states() const;
+
+private:
+    QMap<int, double> mConstants;
+    QMap<int, double> mStates;
+};
+
+//==============================================================================
+
+using SimulationSweepVariants = QList<SimulationSweepVariant>;
+
+//==============================================================================
+
+class SIMULATIONSUPPORT_EXPORT SimulationSweepResult
+{
+    friend class SimulationSweep;
+    friend class SimulationSweepEnsembleTask;
+    friend class SimulationSweepTask;
+
+public:
+    quint64 size() const;
+
+    const double * voi() const;
+    const double * rates(quint64 pPosition) const;
+    const double * states(quint64 pPosition) const;
+    const double * algebraic(quint64 pPosition) const;
+
+    QString error() const;
+
+private:
+    quint64 mSize = 0;
+
+    int mRatesCount = 0;
+    int mStatesCount = 0;
+    int mAlgebraicCount = 0;
+
+    QVector<double> mVoi;
+    QVector<double> mRates;
+    QVector<double> mStates;
+    QVector<double> mAlgebraic;
+
+    QString mError;
+};
+
+//==============================================================================
+
+using SimulationSweepResults = QList<SimulationSweepResult>;
+
+//==============================================================================
+
+class SIMULATIONSUPPORT_EXPORT SimulationSweep : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SimulationSweep(Simulation *pSimulation);
+
+    bool run(const SimulationSweepVariants &pVariants, int pThreadCount = 0);
+
+    SimulationSweepResults results() const;
+
+    qint64 elapsedTime() const;
+
+private:
+    Simulation *mSimulation;
+
+    SimulationSweepResults mResults;
+
+    qint64 mElapsedTime = -1;
+};
+
+//==============================================================================
+
+} // namespace SimulationSupport
+} // namespace OpenCOR
+
+//==============================================================================
+// End of file
+//==============================================================================
@@ -23,6 +23,7 @@ along with this program. If not, see <https://gnu.org/licenses>.
 
 #include "cellmlfileruntime.h"
 #include "corecliutils.h"
+#include "interfaces.h"
 #include "simulation.h"
 #include "simulationworker.h"
 
@@ -40,6 +41,83 @@ namespace SimulationSupport {
 
 //==============================================================================
 
+static const auto AddPointTimeStatistic           = QStringLiteral("add_point_time_ns");
+static const auto RecomputeVariablesTimeStatistic = QStringLiteral("recompute_variables_time_ns");
+
+//==============================================================================
+
+static const double SteadyStateTolerance = 1.0e-5;
+static const int MaximumNumberOfPseudoTimeSteps = 1000;
+static const double MaximumPseudoTimeStepGrowth = 10.0;
+
+//==============================================================================
+
+struct SteadyStateUserData
+{
+    double voi;
+    double *constants;
+    double *algebraic;
+    Solver::OdeSolver::ComputeRatesFunction computeRates;
+    int statesCount;
+    double *previousStates;
+    double pseudoTimeStep;
+};
+
+//==============================================================================
+
+static void computeSteadyStateSystem(double *pStates, double *pResiduals,
+                                     void *pUserData)
+{
+    // Compute our rates, which must all be zero at steady state
+
+    auto userData = static_cast<SteadyStateUserData *>(pUserData);
+
+    userData->computeRates(userData->voi, userData->constants, pResiduals,
+                           pStates, userData->algebraic);
+}
+
+//==============================================================================
+
+static void computePseudoTransientSystem(double *pStates, double *pResiduals,
+                                         void *pUserData)
+{
+    // Compute the residuals of an implicit Euler step of size pseudoTimeStep
+    // from our previous states, i.e. u-u_k-dt*f(u)
+
+    computeSteadyStateSystem(pStates, pResiduals, pUserData);
+
+    auto userData = static_cast<SteadyStateUserData *>(pUserData);
+
+    for (int i = 0; i < userData->statesCount; ++i) {
+        pResiduals[i] = pStates[i]-userData->previousStates[i]-userData->pseudoTimeStep*pResiduals[i];
+    }
+}
+
+//==============================================================================
+
+static double ratesNorm(SteadyStateUserData *pUserData, double *pStates,
+                        double *pRates)
+{
+    // Return the max-norm of our rates, or infinity if one of them is not
+    // finite
+
+    computeSteadyStateSystem(pStates, pRates, pUserData);
+
+    double res = 0.0;
+
+    for (int i = 0; i < pUserData->statesCount; ++i) {
+        if (!qIsFinite(pRates[i])) {
+            return qInf();
+        }
+
+        res = qMax(res, qAbs(pRates[i]));
+    }
+
+    return res;
+}
+
+//==============================================================================
+
 SimulationWorker::SimulationWorker(Simulation *pSimulation, QThread *pThread,
                                    SimulationWorker *&pSelf) :
     mSimulation(pSimulation),
@@ -51,11 +129,25 @@ SimulationWorker::SimulationWorker(Simulation *pSimulation, QThread *pThread,
 
 //==============================================================================
 
+bool SimulationWorker::isThreadRunning() const
+{
+    // Return whether our thread is running
+    // Note: we may not have a thread, i.e. we may be run directly from the
+    //       calling thread (e.g. when running a simulation from the command
+    //       line), in which case we rely on our own running state...
+
+    return (mThread != nullptr)?
+               mThread->isRunning():
+               mRunning;
+}
+
+//==============================================================================
+
 bool SimulationWorker::isRunning() const
 {
     // Return whether our thread is running
 
-    return mThread->isRunning() && !mPaused;
+    return isThreadRunning() && !mPaused;
 }
 
 //==============================================================================
@@ -64,7 +156,7 @@ bool SimulationWorker::isPaused() const
 {
     // Return whether our thread is paused
 
-    return mThread->isRunning() && mPaused;
+    return isThreadRunning() && mPaused;
 }
 
 //==============================================================================
@@ -73,7 +165,7 @@ double SimulationWorker::currentPoint() const
 {
     // Return our current point
 
-    return mThread->isRunning()?
+    return isThreadRunning()?
                mCurrentPoint:
                mSimulation->data()->startingPoint();
 }
@@ -84,6 +176,8 @@ void SimulationWorker::run()
 {
     // Let people know that we are running
 
+    mRunning = true;
+
     emit running(false);
 
     // Set up our ODE solver
@@ -91,20 +185,56 @@ void SimulationWorker::run()
     auto odeSolver = static_cast<Solver::OdeSolver *>(mSimulation->data()->odeSolverInterface()->solverInstance());
 
     // Set up our NLA solver, if needed
+    // Note: our ODE solver may integrate our NLA systems along with our ODEs,
+    //       in which case our model must use the NLA solver that it gives
+    //       us...
 
     Solver::NlaSolver *nlaSolver = nullptr;
+    bool reinitializeOdeSolver = false;
 
     if (mRuntime->needNlaSolver()) {
         nlaSolver = static_cast<Solver::NlaSolver *>(mSimulation->data()->nlaSolverInterface()->solverInstance());
 
-        Solver::setNlaSolver(mRuntime, nlaSolver);
+        Solver::NlaSolver *modelNlaSolver = odeSolver->wrapNlaSolver(nlaSolver);
+
+        mRuntime->setNlaSolver(modelNlaSolver);
+
+        reinitializeOdeSolver = modelNlaSolver == nlaSolver;
     }
 
-    // Keep track of any error that might be reported by any of our solvers
+    // Reset our stopped and error states
+    // Note: this must be done before setting up our steady-state solver since
+    //       it may report an error...
 
     mStopped = false;
     mError = false;
 
+    // Set up our steady-state solver, if needed
+    // Note: it is a separate instance from the NLA solver that our model may
+    //       use, so that they don't share any data...
+
+    Solver::NlaSolver *steadyStateSolver = mSimulation->data()->steadyState()?
+                                               createSteadyStateSolver():
+                                               nullptr;
+
+    // Let our solver(s) know whether they should keep track of statistics
+
+    bool statisticsEnabled = mSimulation->data()->statisticsEnabled();
+
+    odeSolver->setStatisticsEnabled(statisticsEnabled);
+
+    if (nlaSolver != nullptr) {
+        nlaSolver->setStatisticsEnabled(statisticsEnabled);
+    }
+
+    if (steadyStateSolver != nullptr) {
+        steadyStateSolver->setStatisticsEnabled(statisticsEnabled);
+    }
+
+    // Keep track of any error that might be reported by any of our solvers
+    // Note: errors reported by our steady-state solver are handled by
+    //       computeSteadyState() since we may be able to recover from them...
+
     connect(odeSolver, &Solver::OdeSolver::error,
             this, &SimulationWorker::emitError);
 
@@ -119,13 +249,44 @@ void SimulationWorker::run()
     double endingPoint = mSimulation->data()->endingPoint();
     double pointInterval = mSimulation->data()->pointInterval();
     quint64 pointCounter = 0;
+    int refreshRate = mSimulation->data()->refreshRate();
+    qint64 refreshInterval = (refreshRate > 0)?1000/refreshRate:-1;
 
     mCurrentPoint = startingPoint;
 
+    // Initialise our NLA solver, if any
+    // Note: this must be done before initialising our ODE solver since it may
+    //       need to solve our NLA systems...
+
+    if (nlaSolver != nullptr) {
+        nlaSolver->setProperties(mSimulation->data()->nlaSolverProperties());
+    }
+
     // Initialise our ODE solver
 
     odeSolver->setProperties(mSimulation->data()->odeSolverProperties());
 
+    if (odeSolver->needJacobian() && mRuntime->compileJacobian()) {
+        odeSolver->setJacobian(mRuntime->computeJacobian(),
+                               mRuntime->jacobianRows(),
+                               mRuntime->jacobianColumns());
+    }
+
+    if (odeSolver->needQuasiLinearCoefficients() && mRuntime->compileQuasiLinearCoefficients()) {
+        odeSolver->setQuasiLinearCoefficients(mRuntime->computeQuasiLinearCoefficients(),
+                                              mRuntime->quasiLinearStates());
+    }
+
+    if (   (odeSolver->fixedStepMethod() != Solver::FixedStepMethod::None)
+        && mRuntime->compileIntegrator(odeSolver->fixedStepMethod())) {
+        odeSolver->setIntegrator(mRuntime->integrate());
+    }
+
+    if (odeSolver->needRootInformation() && (mRuntime->conditionVariablesCount() != 0)) {
+        odeSolver->setRootInformation(mRuntime->computeRootInformation(),
+                                      mRuntime->conditionVariablesCount());
+    }
+
     odeSolver->initialize(mCurrentPoint, mRuntime->statesCount(),
                           mSimulation->data()->constants(),
                           mSimulation->data()->rates(),
@@ -133,19 +294,49 @@ void SimulationWorker::run()
                           mSimulation->data()->algebraic(),
                           mRuntime->computeRates());
 
-    // Initialise our NLA solver, if any
-
-    if (nlaSolver != nullptr) {
-        nlaSolver->setProperties(mSimulation->data()->nlaSolverProperties());
-    }
-
     // Now, we are ready to compute our model, but only if no error has occurred
     // so far
     // Note: we use -1 as a way to indicate that something went wrong...
 
     qint64 elapsedTime = 0;
+    quint64 addPointTime = 0;
+    quint64 recomputeVariablesTime = 0;
 
-    if (!mError) {
+    // Note: we keep track of the time it takes to add a point, if needed, but
+    //       we don't want to incur any cost otherwise...
+
+    QElapsedTimer addPointTimer;
+    SimulationResults *results = mSimulation->results();
+    auto addPoint = [&]() {
+        if (statisticsEnabled) {
+            addPointTimer.start();
+
+            results->addPoint(mCurrentPoint, &recomputeVariablesTime);
+
+            addPointTime += quint64(addPointTimer.nsecsElapsed());
+        } else {
+            results->addPoint(mCurrentPoint);
+        }
+    };
+
+    if (!mError && (steadyStateSolver != nullptr)) {
+        // Compute our steady state and add it as our one and only point
+        // Note: our states are updated in place, which means that our steady
+        //       state will be the initial conditions of our next run, if
+        //       any...
+
+        QElapsedTimer timer;
+
+        timer.start();
+
+        if (computeSteadyState(steadyStateSolver)) {
+            addPoint();
+
+            elapsedTime = timer.elapsed();
+        } else if (!mStopped) {
+            emitError(tr("the steady state could not be computed"));
+        }
+    } else if (!mError) {
         // Start our timer
 
         QElapsedTimer timer;
@@ -154,24 +345,31 @@ void SimulationWorker::run()
 
         // Add our first point
 
-        mSimulation->results()->addPoint(mCurrentPoint);
+        addPoint();
 
         // Our main work loop
         // Note: for performance reasons, it is essential that the following
         //       loop doesn't emit any signal, be it directly or indirectly,
-        //       unless it is to let people know that we are pausing or running.
-        //       Indeed, the signal/slot mechanism adds a certain level of
-        //       overhead and, here, we want things to be as fast as possible...
+        //       unless it is to let people know that we are pausing or running,
+        //       or that new results are available. Indeed, the signal/slot
+        //       mechanism adds a certain level of overhead and, here, we want
+        //       things to be as fast as possible. This is why we let people
+        //       know about new results at most refreshRate times per second,
+        //       rather than for every point...
 
         QMutex pausedMutex;
+        QElapsedTimer refreshTimer;
+
+        refreshTimer.start();
 
         forever {
-            // Reinitialise our solver, if we have an NLA solver or if the model
-            // got reset
+            // Reinitialise our solver, if we have an NLA solver (unless our
+            // solver integrates our NLA systems itself) or if the model got
+            // reset
             // Note: indeed, with a solver such as CVODE, we need to update our
             //       internals...
 
-            if ((nlaSolver != nullptr) || mReset) {
+            if (reinitializeOdeSolver || mReset) {
                 odeSolver->reinitialize(mCurrentPoint);
 
                 mReset = false;
@@ -189,9 +387,16 @@ void SimulationWorker::run()
                 break;
             }
 
-            // Add our new point
+            // Add our new point and let people know that new results are
+            // available, if needed
+
+            addPoint();
 
-            mSimulation->results()->addPoint(mCurrentPoint);
+            if ((refreshInterval != -1) && (refreshTimer.elapsed() >= refreshInterval)) {
+                emit resultsAvailable();
+
+                refreshTimer.restart();
+            }
 
             // Some post-processing, if needed
 
@@ -246,6 +451,37 @@ void SimulationWorker::run()
         }
     }
 
+    // Keep track of our statistics, if needed
+
+    if (statisticsEnabled) {
+        Solver::Solver::Statistics statistics = odeSolver->statistics();
+
+        if (nlaSolver != nullptr) {
+            Solver::Solver::Statistics nlaSolverStatistics = nlaSolver->statistics();
+
+            for (auto statistic = nlaSolverStatistics.constBegin(),
+                      statisticEnd = nlaSolverStatistics.constEnd();
+                 statistic != statisticEnd; ++statistic) {
+                statistics[statistic.key()] = statistic.value();
+            }
+        }
+
+        if (steadyStateSolver != nullptr) {
+            Solver::Solver::Statistics steadyStateSolverStatistics = steadyStateSolver->statistics();
+
+            for (auto statistic = steadyStateSolverStatistics.constBegin(),
+                      statisticEnd = steadyStateSolverStatistics.constEnd();
+                 statistic != statisticEnd; ++statistic) {
+                statistics[statistic.key()] += statistic.value();
+            }
+        }
+
+        statistics[AddPointTimeStatistic] = addPointTime;
+        statistics[RecomputeVariablesTimeStatistic] = recomputeVariablesTime;
+
+        mSimulation->results()->setStatistics(statistics);
+    }
+
     // Delete our solver(s)
 
     delete odeSolver;
@@ -254,6 +490,10 @@ void SimulationWorker::run()
         delete nlaSolver;
     }
 
+    if (steadyStateSolver != nullptr) {
+        delete steadyStateSolver;
+    }
+
     // Reset our simulation owner's knowledge of us
     // Note: if we were to do it the Qt way, our simulation owner would have a
     //       slot for our done() signal, but we want our simulation owner to
@@ -261,13 +501,175 @@ void SimulationWorker::run()
 
     mSelf = nullptr;
 
+    mRunning = false;
+
+    // Let people know about our last results
+    // Note: we do this now that we are not running anymore, so that people
+    //       know that there won't be any more results...
+
+    emit resultsAvailable();
+
     // Let people know that we are done and give them the elapsed time
-    // Note: we do this with a bit of a delay to give time to the GUI to update
-    //       itself. This is useful when running several simulations from a
-    //       Python script using the Python Console window...
+    // Note: if we have a thread, then we do this with a bit of a delay to give
+    //       time to the GUI to update itself. This is useful when running
+    //       several simulations from a Python script using the Python Console
+    //       window. However, if we don't have a thread, then we were run
+    //       directly from the calling thread (e.g. from the command line), so
+    //       there is no GUI to update and no event loop to rely on...
+
+    if (mThread != nullptr) {
+        QTimer::singleShot(169, this, std::bind(&SimulationWorker::emitDone,
+                                                this, mError?-1:elapsedTime));
+    } else {
+        emitDone(mError?-1:elapsedTime);
+    }
+}
+
+//==============================================================================
+
+Solver::NlaSolver * SimulationWorker::createSteadyStateSolver()
+{
+    // Create and return an NLA solver to compute our steady state
+    // Note: we use the NLA solver (and its properties) that our model uses, if
+    //       any, or the default NLA solver (i.e. the first one in alphabetical
+    //       order) with the default value of its properties otherwise...
+
+    SolverInterface *solverInterface = mSimulation->data()->nlaSolverInterface();
+    Solver::Solver::Properties solverProperties = mSimulation->data()->nlaSolverProperties();
+
+    if (solverInterface == nullptr) {
+        const SolverInterfaces solverInterfaces = Core::solverInterfaces();
+
+        for (auto nlaSolverInterface : solverInterfaces) {
+            if (   (nlaSolverInterface->solverType() == Solver::Type::Nla)
+                && (   (solverInterface == nullptr)
+                    || (solverInterface->solverName().compare(nlaSolverInterface->solverName(), Qt::CaseInsensitive) > 0))) {
+                solverInterface = nlaSolverInterface;
+            }
+        }
+
+        if (solverInterface == nullptr) {
+            emitError(tr("no NLA solver is available to compute the steady state"));
+
+            return nullptr;
+        }
+
+        const Solver::Properties defaultSolverProperties = solverInterface->solverProperties();
+
+        for (const auto &solverProperty : defaultSolverProperties) {
+            solverProperties.insert(solverProperty.id(), solverProperty.defaultValue());
+        }
+    }
+
+    auto res = static_cast<Solver::NlaSolver *>(solverInterface->solverInstance());
+
+    res->setProperties(solverProperties);
+
+    return res;
+}
+
+//==============================================================================
+
+bool SimulationWorker::computeSteadyState(Solver::NlaSolver *pNlaSolver)
+{
+    // Keep track of whether our NLA solver reports an error, but don't let
+    // people know about it since we may be able to recover from it
+
+    bool nlaSolverError = false;
+    QMetaObject::Connection connection = connect(pNlaSolver, &Solver::NlaSolver::error,
+                                                 [&nlaSolverError]() {
+        nlaSolverError = true;
+    });
+
+    // Set up the system that we want to solve, i.e. rates = 0
+
+    int statesCount = mRuntime->statesCount();
+    auto statesSize = size_t(statesCount)*Solver::SizeOfDouble;
+    double *states = mSimulation->data()->states();
+    QVector<double> initialStates(statesCount);
+    QVector<double> previousStates(statesCount);
+    QVector<double> rates(statesCount);
+    SteadyStateUserData userData = { mCurrentPoint,
+                                     mSimulation->data()->constants(),
+                                     mSimulation->data()->algebraic(),
+                                     mRuntime->computeRates(),
+                                     statesCount, previousStates.data(), 0.0 };
+
+    memcpy(initialStates.data(), states, statesSize);
+
+    // Keep track of the data that our NLA solver associates with each of our
+    // systems, so that it doesn't have to set them up every time we ask it to
+    // solve them
+
+    void *steadyStateSystemData = nullptr;
+    void *pseudoTransientSystemData = nullptr;
+
+    // First, try to solve our system directly, which is what we want for
+    // models that are already close enough to their steady state
+
+    pNlaSolver->solve(computeSteadyStateSystem, states, statesCount, &userData,
+                      &steadyStateSystemData);
+
+    bool res =    !nlaSolverError
+               && (ratesNorm(&userData, states, rates.data()) <= SteadyStateTolerance);
+
+    // Our direct solve failed (e.g. because our initial conditions are too far
+    // from our steady state), so fall back on pseudo-transient continuation,
+    // i.e. take implicit Euler steps in pseudo-time, starting with a pseudo-
+    // time step of the size of our point interval, and let it grow as our
+    // rates decrease (switched evolution relaxation), so that we eventually
+    // end up doing Newton steps on rates = 0
+    // Note: a failed pseudo-time step is retried with a smaller pseudo-time
+    //       step...
+
+    if (!res) {
+        memcpy(states, initialStates.constData(), statesSize);
+
+        double norm = ratesNorm(&userData, states, rates.data());
+        double pseudoTimeStep = mSimulation->data()->pointInterval();
+
+        for (int i = 0;
+                 qIsFinite(norm) && !mStopped
+              && (i < MaximumNumberOfPseudoTimeSteps); ++i) {
+            memcpy(previousStates.data(), states, statesSize);
+
+            nlaSolverError = false;
+            userData.pseudoTimeStep = pseudoTimeStep;
+
+            pNlaSolver->solve(computePseudoTransientSystem, states, statesCount,
+                              &userData, &pseudoTransientSystemData);
+
+            double newNorm = ratesNorm(&userData, states, rates.data());
+
+            if (nlaSolverError || !qIsFinite(newNorm)) {
+                memcpy(states, previousStates.constData(), statesSize);
+
+                pseudoTimeStep *= 0.1;
+
+                continue;
+            }
+
+            if (newNorm <= SteadyStateTolerance) {
+                res = true;
+
+                break;
+            }
+
+            pseudoTimeStep *= qMin(norm/newNorm, MaximumPseudoTimeStepGrowth);
+            norm = newNorm;
+        }
+
+        // Go back to our initial states if we couldn't compute our steady
+        // state
+
+        if (!res) {
+            memcpy(states, initialStates.constData(), statesSize);
+        }
+    }
+
+    disconnect(connection);
 
-    QTimer::singleShot(169, this, std::bind(&SimulationWorker::emitDone,
-                                            this, mError?-1:elapsedTime));
+    return res;
 }
 
 //==============================================================================
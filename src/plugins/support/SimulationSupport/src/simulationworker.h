@@ -40,6 +40,12 @@ namespace CellMLSupport {
 
 //==============================================================================
 
+namespace Solver {
+    class NlaSolver;
+} // namespace Solver
+
+//==============================================================================
+
 namespace SimulationSupport {
 
 //==============================================================================
@@ -76,6 +82,7 @@ private:
 
     double mCurrentPoint = 0.0;
 
+    bool mRunning = false;
     bool mPaused = false;
     bool mStopped = false;
 
@@ -87,6 +94,11 @@ private:
 
     SimulationWorker *&mSelf;
 
+    bool isThreadRunning() const;
+
+    Solver::NlaSolver * createSteadyStateSolver();
+    bool computeSteadyState(Solver::NlaSolver *pNlaSolver);
+
 signals:
     void running(bool pIsResuming);
     void paused();
@@ -95,6 +107,8 @@ signals:
 
     void error(const QString &pMessage);
 
+    void resultsAvailable();
+
 public slots:
     void run();
 
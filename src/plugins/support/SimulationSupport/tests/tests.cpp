@@ -0,0 +1,91 @@
+/*******************************************************************************
+
+Copyright (C) The University of Auckland
+
+OpenCOR is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+OpenCOR is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program. If not, see <https://gnu.org/licenses>.
+
+*******************************************************************************/
+
+//==============================================================================
+// SimulationSupport tests
+//==============================================================================
+
+#include "../../../../tests/src/testsutils.h"
+
+//==============================================================================
+
+#include "cellmlfilemanager.h"
+#include "cellmlfileruntime.h"
+#include "filemanager.h"
+#include "simulation.h"
+#include "tests.h"
+
+//==============================================================================
+
+#include <QtTest/QtTest>
+
+//==============================================================================
+
+void Tests::addPointBenchmark()
+{
+    // Benchmark the addition of points to the results of a simulation
+    // Note #1: our CellML file manager must exist before our file gets managed,
+    //          so that our simulation can retrieve its CellML file...
+    // Note #2: we create our simulation and its run, and get their arrays
+    //          allocated, before benchmarking, so that only the per-point cost
+    //          of SimulationResults::addPoint() gets measured. This means that
+    //          our benchmark can only be run once since our run would otherwise
+    //          be full...
+
+    QString fileName = OpenCOR::fileName("models/noble_model_1962.cellml");
+
+    OpenCOR::CellMLSupport::CellmlFileManager::instance();
+    OpenCOR::Core::FileManager::instance()->manage(fileName);
+
+    OpenCOR::SimulationSupport::Simulation simulation(fileName);
+    OpenCOR::SimulationSupport::SimulationResults *results = simulation.results();
+
+    QVERIFY(simulation.runtime() != nullptr);
+    QVERIFY(simulation.runtime()->isValid());
+
+    static const double PointInterval = 0.01;
+
+    simulation.data()->setPointInterval(PointInterval);
+    simulation.data()->reset();
+    results->reset();
+
+    QVERIFY(results->addRun());
+
+    quint64 pointsCount = simulation.size();
+
+    QVERIFY(pointsCount != 0);
+
+    QBENCHMARK_ONCE {
+        for (quint64 i = 0; i < pointsCount; ++i) {
+            results->addPoint(i*PointInterval);
+        }
+    }
+
+    QCOMPARE(results->size(), pointsCount);
+
+    OpenCOR::Core::FileManager::instance()->unmanage(fileName);
+}
+
+//==============================================================================
+
+QTEST_GUILESS_MAIN(Tests)
+
+//==============================================================================
+// End of file
+//==============================================================================